@@ -2,11 +2,13 @@
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
+#include <malloc.h>
 
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
+#include "hardware/clocks.h"
 #include "hardware/rtc.h" // Para timestamp, se desejado
 #include "pico/time.h"    // Para get_absolute_time
 #include "pico/bootrom.h" //
@@ -23,6 +25,62 @@
 #include "ssd1306.h"
 #include "font.h" // Assumindo que font.h define WIDTH e HEIGHT ou são passados
 
+#include "mem_pool.h"
+#include "sd_space.h"
+#include "log_writer.h"
+#include "imu_codec.h"
+#include "csv_format.h"
+#include "block_log.h"
+#include "column_block.h"
+#include "log_index.h"
+#include "log_preview.h"
+#include "log_meta.h"
+#include "sample_ring.h"
+#include "display_pages.h"
+#include "task_sched.h"
+#include "buzzer.h"
+#include "led_pattern.h"
+
+// Formato do log (DATALOGGER_LOG_FORMAT no CMakeLists.txt):
+// 0 = CSV texto (log_NNN.csv), 1 = delta + varint binário (log_NNN.imu)
+#ifndef DATALOGGER_LOG_DELTA
+#define DATALOGGER_LOG_DELTA 0
+#endif
+// Formato "columns": blocos colunares com mínimo/máximo por canal no
+// cabeçalho (log_NNN.lzb, lib/column_block.h); sempre em blocos
+#ifndef DATALOGGER_LOG_COLUMNS
+#define DATALOGGER_LOG_COLUMNS 0
+#endif
+// Compressão em blocos no core 1 (DATALOGGER_LOG_COMPRESS): log_NNN.lzb, que
+// descomprime para o conteúdo do .csv ou .imu. DATALOGGER_LOG_FRAMED grava os
+// mesmos blocos com CRC sem comprimir
+#ifndef DATALOGGER_LOG_BLOCKS
+#define DATALOGGER_LOG_BLOCKS 0
+#endif
+#if DATALOGGER_LOG_COLUMNS
+#if !DATALOGGER_LOG_BLOCKS || !BLOCK_LOG_COLUMNS
+#error "DATALOGGER_LOG_COLUMNS precisa de DATALOGGER_LOG_BLOCKS e BLOCK_LOG_COLUMNS"
+#endif
+#define LOG_MAX_RECORD COLUMN_BLOCK_ROW_SIZE
+#elif DATALOGGER_LOG_DELTA
+#define LOG_MAX_RECORD IMU_CODEC_MAX_RECORD
+#else
+#define LOG_MAX_RECORD CSV_FORMAT_MAX_RECORD
+#endif
+#ifndef DATALOGGER_VERSION
+#define DATALOGGER_VERSION "dev"
+#endif
+#if DATALOGGER_LOG_BLOCKS
+#define LOG_FILE_EXT "lzb"
+#define LOG_INDEX_KIND LOG_INDEX_LZB
+#elif DATALOGGER_LOG_DELTA
+#define LOG_FILE_EXT "imu"
+#define LOG_INDEX_KIND LOG_INDEX_IMU
+#else
+#define LOG_FILE_EXT "csv"
+#define LOG_INDEX_KIND LOG_INDEX_CSV
+#endif
+
 // --- Definições de Pinos ---
 
 // MPU6050 (I2C0)
@@ -31,6 +89,25 @@
 #define I2C_SCL_MPU 1
 #define MPU6050_ADDR 0x68
 
+// Fundo de escala configurado no reset e gravado no cabeçalho do log
+#ifndef MPU6050_ACCEL_FS_G
+#define MPU6050_ACCEL_FS_G 2 // 2, 4, 8 ou 16 g
+#endif
+#ifndef MPU6050_GYRO_FS_DPS
+#define MPU6050_GYRO_FS_DPS 250 // 250, 500, 1000 ou 2000 °/s
+#endif
+#define MPU6050_AFS_SEL (MPU6050_ACCEL_FS_G == 16 ? 3 : MPU6050_ACCEL_FS_G == 8 ? 2 : MPU6050_ACCEL_FS_G == 4 ? 1 : 0)
+#define MPU6050_FS_SEL (MPU6050_GYRO_FS_DPS == 2000 ? 3 : MPU6050_GYRO_FS_DPS == 1000 ? 2 : MPU6050_GYRO_FS_DPS == 500 ? 1 : 0)
+
+#define SAMPLE_PERIOD_MS 100 // Intervalo entre amostras durante a gravação
+
+// Períodos das outras tarefas do laço principal (ver main)
+#define BUTTON_PERIOD_MS 10
+#define STORAGE_PERIOD_MS 20
+#define UI_PERIOD_MS 50
+#define DISPLAY_PERIOD_MS 100
+#define CARD_PERIOD_MS 1000
+
 // Display OLED SSD1306 (I2C1)
 #define I2C_PORT_DISP i2c1
 #define I2C_SDA_DISP 14
@@ -50,34 +127,41 @@
 // Botões (assumindo pinos do PERIFERICOS.H)
 #define BOTAO_A_PIN 5 // Para controle de funções (iniciar/parar/mudar tela)
 #define BOTAO_B_PIN 6 // Para modo BOOTSEL
+#define BOTAO_JOY_PIN 22 // Botão do joystick: troca o canal do gráfico (página 2)
+
+// Gráfico rolando (página 2): colunas de CHART_DECIMATION amostras
+#ifndef CHART_DECIMATION
+#define CHART_DECIMATION 1
+#endif
 
 // --- Variáveis Globais ---
 ssd1306_t ssd; // Instância do display OLED
 FATFS fs;      // Instância do sistema de arquivos FatFs
 FIL log_file;  // Instância do arquivo de log
+log_writer_t log_writer; // Agrupa as escritas do log em blocos de setor
+log_index_t log_index;   // Índice log_NNN.idx (amostra/tempo -> offset)
+log_preview_t log_preview; // Prévia min/max/média log_NNN.pvw
+#if DATALOGGER_LOG_DELTA
+imu_encoder_t imu_encoder;
+#endif
+uint64_t encode_time_us = 0; // Tempo total gasto formatando/codificando amostras na sessão
+uint64_t display_draw_us = 0; // Tempo de desenho dos quadros do OLED na sessão
+uint64_t display_send_us = 0; // Tempo de CPU no envio dos quadros na sessão
+uint64_t display_bytes = 0;   // Bytes enviados ao OLED na sessão
+uint32_t display_frames = 0;
 bool sd_card_mounted = false;
 uint32_t sample_counter = 0;
 absolute_time_t recording_start_time;
 bool recording_active = false;
-uint8_t current_display_page = 0; // 0: Status, 1: Dados IMU
-
-// --- Enumeração de Estados do Sistema ---
-typedef enum {
-    SYS_INITIALIZING,
-    SYS_SD_NOT_DETECTED,
-    SYS_READY,
-    SYS_RECORDING,
-    SYS_DATA_SAVED,
-    SYS_ERROR
-} SystemState;
+uint8_t current_display_page = 0; // 0: Status, 1: Dados IMU, 2: Gráfico
+sample_ring_t chart_ring; // Últimas amostras da aquisição, dizimadas, para o gráfico
+uint8_t chart_channel = 0; // Canal no gráfico: 0..2 Ax..Az, 3..5 Gx..Gz
 
+// Estados do sistema: SystemState em lib/display_pages.h
 SystemState current_system_state = SYS_INITIALIZING;
 
 // --- Protótipos de Funções ---
 // Funções de Periféricos (Botoes, LEDs, Buzzer)
-void set_led_color(bool r, bool g, bool b);
-void blink_led(bool r, bool g, bool b, uint32_t delay_ms, uint32_t num_blinks); 
-void tocar_nota(int frequencia, int duracao);
 void beep_curto();
 void beep_duplo();
 void init_peripherals();
@@ -88,62 +172,46 @@ static void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp);
 
 // Funções do Cartão SD
 char* get_next_log_filename();
+bool open_log_file(const char *filename);
+bool write_log_record(uint32_t sample, const int16_t accel[3], const int16_t gyro[3]);
+bool close_log_file(const char *stop_reason);
 bool mount_sd_card();
 bool unmount_sd_card();
 
 // Funções do Display OLED
 void update_display();
 
+// Funções de diagnóstico
+void print_memory_usage(const char *when);
+
 // Funções de Controle de Botões
 bool is_button_pressed(uint gpio_pin, uint64_t *last_press_time); 
 void gpio_irq_handler_bootsel(uint gpio, uint32_t events); // Para o modo BOOTSEL
 
 // --- Funções de Periféricos (Botoes, LEDs, Buzzer) ---
 
-// Funções para LEDs
-void set_led_color(bool r, bool g, bool b) {
-    gpio_put(LED_RED_PIN, r);
-    gpio_put(LED_GREEN_PIN, g);
-    gpio_put(LED_BLUE_PIN, b);
-}
-
-void blink_led(bool r, bool g, bool b, uint32_t delay_ms, uint32_t num_blinks) { 
-    for (uint32_t i = 0; i < num_blinks; i++) { 
-        set_led_color(r, g, b);
-        sleep_ms(delay_ms);
-        set_led_color(false, false, false); // Desliga
-        sleep_ms(delay_ms);
-    }
-}
-
-// Funções para Buzzer (do PERIFERICOS.H)
-void tocar_nota(int frequencia, int duracao) {
-    if (frequencia == 0) {
-        gpio_put(BUZZER_PIN, 0);
-        return;
-    }
-    int periodo = 1000000 / frequencia; // Periodo em microssegundos
-    int metade_periodo = periodo / 2;
-    for (int i = 0; i < duracao * 1000L / periodo; i++) {
-        gpio_put(BUZZER_PIN, 1);
-        sleep_us(metade_periodo);
-        gpio_put(BUZZER_PIN, 0);
-        sleep_us(metade_periodo);
-    }
-}
-
+// Funções para LEDs: padrões tocados por timer (lib/led_pattern.c)
+static const led_pattern_t state_led[SYS_STATE_COUNT] = {
+    [SYS_INITIALIZING] = {LED_PULSE, 255, 255, 0, 1000, 0},   // Amarelo pulsando
+    [SYS_SD_NOT_DETECTED] = {LED_SOLID, 255, 0, 255, 0, 0},   // Roxo
+    [SYS_READY] = {LED_SOLID, 0, 255, 0, 0, 0},               // Verde
+    [SYS_RECORDING] = {LED_SOLID, 255, 0, 0, 0, 0},           // Vermelho (azul a cada escrita)
+    [SYS_DATA_SAVED] = {LED_SOLID, 0, 255, 0, 0, 0},          // Verde
+    [SYS_ERROR] = {LED_BLINK, 255, 0, 255, 400, 0},           // Roxo piscando sem parar
+};
+static const led_pattern_t led_sd_access = {LED_BLINK, 0, 0, 255, 200, 2}; // 2 piscadas rápidas em azul
+static const led_pattern_t led_sd_missing = {LED_BLINK, 255, 0, 255, 400, 5}; // Roxo piscando
+
+// Funções para Buzzer: tocadas por PWM e alarme (lib/buzzer.c), sem
+// bloquear a aquisição no início e no fim da gravação
 void beep_curto() {
-    tocar_nota(500, 80);
-    sleep_ms(50); // Pequena pausa para garantir o fim do beep
-    tocar_nota(0, 0); // Desliga o buzzer
+    static const buzzer_tone_t curto[] = {{500, 80}};
+    buzzer_play(curto, count_of(curto));
 }
 
 void beep_duplo() {
-    tocar_nota(500, 80);
-    sleep_ms(100);
-    tocar_nota(500, 80);
-    sleep_ms(50);
-    tocar_nota(0, 0);
+    static const buzzer_tone_t duplo[] = {{500, 80}, {0, 100}, {500, 80}};
+    buzzer_play(duplo, count_of(duplo));
 }
 
 // Inicialização de botões, LEDs e buzzer
@@ -157,19 +225,15 @@ void init_peripherals() {
     gpio_set_dir(BOTAO_B_PIN, GPIO_IN);
     gpio_pull_up(BOTAO_B_PIN);
 
-    // LEDs
-    gpio_init(LED_RED_PIN);
-    gpio_set_dir(LED_RED_PIN, GPIO_OUT);
-    gpio_init(LED_GREEN_PIN);
-    gpio_set_dir(LED_GREEN_PIN, GPIO_OUT);
-    gpio_init(LED_BLUE_PIN);
-    gpio_set_dir(LED_BLUE_PIN, GPIO_OUT);
-    set_led_color(false, false, false); // Desliga todos os LEDs
+    gpio_init(BOTAO_JOY_PIN);
+    gpio_set_dir(BOTAO_JOY_PIN, GPIO_IN);
+    gpio_pull_up(BOTAO_JOY_PIN);
+
+    // LEDs (PWM, começam apagados)
+    led_pattern_init(LED_RED_PIN, LED_GREEN_PIN, LED_BLUE_PIN);
 
-    // Buzzer
-    gpio_init(BUZZER_PIN);
-    gpio_set_dir(BUZZER_PIN, GPIO_OUT);
-    gpio_put(BUZZER_PIN, 0); // Garante que o buzzer esteja desligado
+    // Buzzer (PWM, começa em silêncio)
+    buzzer_init(BUZZER_PIN);
 }
 
 // --- Funções do MPU6050 ---
@@ -181,6 +245,12 @@ static void mpu6050_reset() {
     buf[1] = 0x00; // Sair do modo sleep
     i2c_write_blocking(I2C_PORT_MPU, MPU6050_ADDR, buf, 2, false);
     sleep_ms(10);
+
+    // Fundo de escala explícito, em vez de depender do valor pós-reset
+    uint8_t gyro_config[] = {0x1B, MPU6050_FS_SEL << 3};
+    i2c_write_blocking(I2C_PORT_MPU, MPU6050_ADDR, gyro_config, 2, false);
+    uint8_t accel_config[] = {0x1C, MPU6050_AFS_SEL << 3};
+    i2c_write_blocking(I2C_PORT_MPU, MPU6050_ADDR, accel_config, 2, false);
 }
 
 static void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp) {
@@ -209,24 +279,262 @@ static void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp) {
 
 // --- Funções do Cartão SD ---
 
-// Função auxiliar para obter a próxima numeração de arquivo de log
+// Troca a extensão de um nome de log (log_007.csv -> log_007.idx)
+static void log_sidecar_name(char *dst, size_t size, const char *filename, const char *ext) {
+    const char *dot = strrchr(filename, '.');
+    int base = dot ? (int)(dot - filename) : (int)strlen(filename);
+    snprintf(dst, size, "%.*s%s", base, filename, ext);
+}
+
+// Função auxiliar para obter a próxima numeração de arquivo de log.
+// Um índice só é livre se nem o log nem o .idx/.pvw dele existirem:
+// os arquivos laterais são abertos com FA_CREATE_ALWAYS e seriam sobrescritos.
 char* get_next_log_filename() {
     static char filename[32];
+    static const char *const sidecars[] = {".idx", ".pvw"};
+    char name[sizeof filename];
+    FILINFO info;
     uint32_t file_idx = 0;
-    FIL test_file;
-    FRESULT fr;
+    bool taken;
 
     do {
-        sprintf(filename, "log_%03lu.csv", file_idx++);
-        fr = f_open(&test_file, filename, FA_READ);
-        if (fr == FR_OK) {
-            f_close(&test_file);
+        snprintf(filename, sizeof filename, "log_%03lu." LOG_FILE_EXT, (unsigned long)file_idx++);
+        taken = f_stat(filename, &info) == FR_OK;
+        for (size_t i = 0; !taken && i < count_of(sidecars); i++) {
+            log_sidecar_name(name, sizeof name, filename, sidecars[i]);
+            taken = f_stat(name, &info) == FR_OK;
         }
-    } while (fr == FR_OK); // Continua procurando até encontrar um nome não existente
+    } while (taken); // Continua procurando até encontrar um nome não existente
 
     return filename;
 }
 
+// Milissegundos desde o início da gravação
+static uint32_t recording_ms() {
+    return (uint32_t)(absolute_time_diff_us(recording_start_time, get_absolute_time()) / 1000);
+}
+
+#if DATALOGGER_LOG_BLOCKS
+// Cada bloco comprimido ganha uma entrada no índice, com o offset dele no arquivo
+static void on_block_written(uint64_t file_offset, uint32_t first_sample, uint32_t first_ms) {
+    log_index_add(&log_index, first_sample, first_ms, file_offset);
+}
+#endif
+
+// Espaço para n bytes do log (da amostra sample): direto no buffer do writer
+// ou no bloco que vai ser comprimido pelo core 1
+static uint8_t *log_reserve(uint32_t n, uint32_t sample) {
+#if DATALOGGER_LOG_BLOCKS
+    bool new_block;
+    uint8_t *dst = block_log_reserve(n, sample, recording_ms(), &new_block);
+#if DATALOGGER_LOG_DELTA
+    if (new_block)
+        imu_encoder_force_keyframe(&imu_encoder); // Cada bloco decodifica sozinho
+#endif
+    return dst;
+#else
+    (void)sample;
+    return log_writer_reserve(&log_writer, n);
+#endif
+}
+
+static void log_commit(uint32_t n) {
+#if DATALOGGER_LOG_BLOCKS
+    block_log_commit(n);
+#else
+    log_writer_commit(&log_writer, n);
+#endif
+}
+
+// Texto de metadados da sessão (lib/log_meta.h) para o cabeçalho
+static size_t format_log_header(char *dst, const char *filename) {
+    int16_t accel[3], gyro[3], temp;
+    mpu6050_read_raw(accel, gyro, &temp);
+    const log_meta_header_t meta = {
+        .firmware = DATALOGGER_VERSION,
+        .profile = DATALOGGER_PROFILE_NAME,
+        .format = DATALOGGER_LOG_COLUMNS ? "columns" : DATALOGGER_LOG_DELTA ? "delta" : "csv",
+        .file = filename,
+        .compressed = DATALOGGER_LOG_BLOCKS && BLOCK_LOG_COMPRESS, // FRAMED e columns sem compressão: "none"
+        .period_ms = SAMPLE_PERIOD_MS,
+        .accel_fs_g = MPU6050_ACCEL_FS_G,
+        .gyro_fs_dps = MPU6050_GYRO_FS_DPS,
+        .temp_raw = temp,
+        .uptime_ms = to_ms_since_boot(recording_start_time),
+    };
+    return log_meta_format_header(dst, &meta);
+}
+
+// Abre o arquivo de log e escreve o cabeçalho do formato escolhido
+bool open_log_file(const char *filename) {
+    FRESULT fr = f_open(&log_file, filename, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK) {
+        DBG_PRINTF("Erro ao abrir arquivo de log: %s (%d)\n", FRESULT_str(fr), fr);
+        return false;
+    }
+    log_writer_init(&log_writer, &log_file);
+    log_writer.on_write = led_pattern_activity; // Azul a cada escrita no cartão
+
+    // Índice com o mesmo nome e extensão .idx; sem ele o log continua normal
+    char index_name[32];
+    log_sidecar_name(index_name, sizeof index_name, filename, ".idx");
+    fr = log_index_open(&log_index, index_name, LOG_INDEX_KIND,
+                        DATALOGGER_LOG_BLOCKS ? 0 : LOG_INDEX_INTERVAL);
+    if (fr != FR_OK) {
+        DBG_PRINTF("Erro ao abrir indice %s: %s (%d)\n", index_name, FRESULT_str(fr), fr);
+    }
+    // Prévia (.pvw) para o host desenhar a sessão inteira sem ler o log
+    log_sidecar_name(index_name, sizeof index_name, filename, ".pvw");
+    fr = log_preview_open(&log_preview, index_name);
+    if (fr != FR_OK) {
+        DBG_PRINTF("Erro ao abrir previa %s: %s (%d)\n", index_name, FRESULT_str(fr), fr);
+    }
+#if DATALOGGER_LOG_BLOCKS
+    block_log_start(&log_writer, on_block_written);
+#endif
+    encode_time_us = 0;
+    display_draw_us = display_send_us = display_bytes = 0;
+    display_frames = 0;
+    char meta[LOG_META_MAX_SIZE];
+    size_t meta_len = format_log_header(meta, filename);
+#if DATALOGGER_LOG_DELTA
+    imu_encoder_init(&imu_encoder, IMU_CODEC_KEYFRAME);
+    uint8_t *dst = log_reserve(IMU_CODEC_HEADER_SIZE + meta_len, 0);
+    if (dst)
+        log_commit(imu_codec_write_header(&imu_encoder, dst, meta, (uint16_t)meta_len));
+#elif DATALOGGER_LOG_COLUMNS
+    // Só os metadados, num bloco próprio: as colunas têm posição fixa
+    uint8_t *dst = log_reserve(meta_len, 0);
+    if (dst) {
+        memcpy(dst, meta, meta_len);
+        log_commit(meta_len);
+    }
+#else
+    // Linha de colunas e depois os metadados como comentários '#'
+    static const char header[] = "Sample,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ\n";
+    uint8_t *dst = log_reserve(sizeof(header) - 1 + meta_len, 0);
+    if (dst) {
+        memcpy(dst, header, sizeof(header) - 1);
+        memcpy(dst + sizeof(header) - 1, meta, meta_len);
+        log_commit(sizeof(header) - 1 + meta_len);
+    }
+#endif
+    return dst != NULL && log_writer.error == FR_OK;
+}
+
+// Acrescenta uma amostra ao log (vai para o cartão quando o buffer enche)
+bool write_log_record(uint32_t sample, const int16_t accel[3], const int16_t gyro[3]) {
+    const int16_t values[6] = {accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]};
+#if !DATALOGGER_LOG_BLOCKS // Com blocos, quem grava e indexa é storage_run (block_log_poll)
+    if (log_index_due(&log_index, sample)) {
+#if DATALOGGER_LOG_DELTA
+        imu_encoder_force_keyframe(&imu_encoder); // O leitor começa a decodificar aqui
+#endif
+        log_index_add(&log_index, sample, recording_ms(), log_writer.total);
+    }
+#endif
+#if DATALOGGER_LOG_COLUMNS
+    // Só a cópia da amostra: o core 1 transpõe o bloco e calcula min/max
+    uint32_t t0 = time_us_32();
+    if (block_log_add_row(sample, recording_ms(), values)) {
+        encode_time_us += time_us_32() - t0;
+        log_preview_add(&log_preview, sample,
+                        log_preview_needs_time(&log_preview) ? recording_ms() : 0, values);
+    }
+#else
+    // Registro formatado/codificado direto no buffer, sem cópia intermediária
+    uint8_t *dst = log_reserve(LOG_MAX_RECORD, sample);
+    if (dst) {
+        uint32_t t0 = time_us_32();
+#if DATALOGGER_LOG_DELTA
+        size_t n = imu_encoder_encode(&imu_encoder, sample, values, dst);
+#else
+        size_t n = csv_format_record((char *)dst, sample, values);
+#endif
+        encode_time_us += time_us_32() - t0;
+        log_commit(n);
+        log_preview_add(&log_preview, sample,
+                        log_preview_needs_time(&log_preview) ? recording_ms() : 0, values);
+    }
+#endif
+    if (log_writer.error != FR_OK) {
+        DBG_PRINTF("Erro ao escrever no SD: %s (%d)\n", FRESULT_str(log_writer.error), log_writer.error);
+        return false;
+    }
+    return true;
+}
+
+// Acrescenta o trailer com o resumo da sessão (lib/log_meta.h) no fim do log
+static void write_log_trailer(const char *stop_reason) {
+    int16_t accel[3], gyro[3], temp;
+    mpu6050_read_raw(accel, gyro, &temp);
+    const log_meta_trailer_t meta = {
+        .samples = sample_counter,
+        .duration_ms = recording_ms(),
+        .temp_raw = temp,
+        .encode_ns_per_sample = sample_counter ? (uint32_t)(encode_time_us * 1000 / sample_counter) : 0,
+        .stop = stop_reason,
+    };
+    char text[LOG_META_MAX_SIZE];
+    size_t len = log_meta_format_trailer(text, &meta);
+#if DATALOGGER_LOG_DELTA
+    uint8_t *dst = log_reserve(IMU_CODEC_TRAILER_SIZE + len, sample_counter);
+    if (dst)
+        log_commit(imu_codec_write_trailer(dst, text, (uint16_t)len));
+#else
+    uint8_t *dst = log_reserve(len, sample_counter);
+    if (dst) {
+        memcpy(dst, text, len);
+        log_commit(len);
+    }
+#endif
+}
+
+// Grava o trailer, descarrega o buffer, fecha o arquivo e imprime o resumo da
+// sessão. stop_reason vai para o trailer ("botao", "cartao_cheio")
+bool close_log_file(const char *stop_reason) {
+    write_log_trailer(stop_reason);
+#if DATALOGGER_LOG_BLOCKS
+    FRESULT fr = block_log_finish();
+    if (fr == FR_OK)
+        fr = log_writer_flush(&log_writer);
+#else
+    FRESULT fr = log_writer_flush(&log_writer);
+#endif
+    FRESULT fr_close = f_close(&log_file);
+    if (fr == FR_OK)
+        fr = fr_close;
+    log_index_close(&log_index);
+    log_preview_close(&log_preview);
+    if (fr != FR_OK) {
+        DBG_PRINTF("Erro ao fechar arquivo de log: %s (%d)\n", FRESULT_str(fr), fr);
+    }
+    if (sample_counter > 0) {
+        // Referência: 16 B/amostra em binário bruto (uint32 + 6 x int16)
+        uint32_t milli_bytes = (uint32_t)(log_writer.total * 1000 / sample_counter);
+        printf("[log] %lu amostras, %llu B, %lu.%03lu B/amostra (bruto: 16 B)\n",
+               sample_counter, log_writer.total, milli_bytes / 1000, milli_bytes % 1000);
+        printf("[log] formatacao: %llu us no total, %lu ns/amostra\n", encode_time_us,
+               (uint32_t)(encode_time_us * 1000 / sample_counter));
+#if DATALOGGER_LOG_BLOCKS
+        const block_log_stats_t *bs = block_log_stats();
+        printf("[log] blocos: %lu (%lu sem compressao), %llu B brutos -> %llu B, "
+               "pior bloco %lu us, esperas do core 0: %lu\n",
+               bs->blocks, bs->stored_blocks, bs->raw_bytes, log_writer.total,
+               bs->max_compress_us, bs->waits);
+#endif
+    }
+    if (display_frames > 0) {
+        uint32_t draw_us = (uint32_t)(display_draw_us / display_frames);
+        printf("[oled] %lu quadros: desenho %lu us/quadro (%lu ciclos), envio %lu us/quadro de CPU, "
+               "%lu B/quadro na I2C (quadro inteiro: 1044 B), %lu envios abortados\n",
+               display_frames, draw_us, draw_us * (clock_get_hz(clk_sys) / 1000000),
+               (uint32_t)(display_send_us / display_frames),
+               (uint32_t)(display_bytes / display_frames), ssd.send_errors);
+    }
+    return fr == FR_OK;
+}
+
 bool mount_sd_card() {
     FRESULT fr = f_mount(&fs, "0:", 1); // "0:" é o nome lógico do drive
     if (FR_OK != fr) {
@@ -235,6 +543,11 @@ bool mount_sd_card() {
         return false;
     }
     sd_card_mounted = true;
+    fr = sd_space_init(&fs); // Uma única contagem de clusters livres por montagem
+    if (FR_OK != fr) {
+        DBG_PRINTF("f_getfree error: %s (%d)\n", FRESULT_str(fr), fr);
+    }
+    printf("SD montado: %lu MB livres\n", (unsigned long)(sd_space_free_bytes() >> 20));
     return true;
 }
 
@@ -250,65 +563,74 @@ bool unmount_sd_card() {
 
 // --- Funções do Display OLED ---
 
+static absolute_time_t chart_idle_sample; // Leitura do IMU fora da gravação
+
+// Alimenta o gráfico com a amostra que a aquisição acabou de ler
+static void chart_add_sample(const int16_t accel[3], const int16_t gyro[3]) {
+    const int16_t values[SAMPLE_RING_CHANNELS] = {accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]};
+    sample_ring_push(&chart_ring, values);
+}
+
 void update_display() {
-    ssd1306_fill(&ssd, false); // Limpa o display
-
-    char line_buffer[25]; // Buffer para as linhas de texto
-
-    if (current_display_page == 0) { // Página de Status
-        ssd1306_draw_string(&ssd, "DATALOGGER IMU", 0, 0);
-        ssd1306_draw_string(&ssd, "----------------", 0, 10);
-
-        switch (current_system_state) {
-            case SYS_INITIALIZING:
-                ssd1306_draw_string(&ssd, "Inicializando...", 0, 25);
-                break;
-            case SYS_SD_NOT_DETECTED:
-                ssd1306_draw_string(&ssd, "SD Nao Detectado", 0, 25);
-                ssd1306_draw_string(&ssd, "Verifique Conexao", 0, 35);
-                break;
-            case SYS_READY:
-                ssd1306_draw_string(&ssd, "Pronto para Gravar", 0, 25);
-                ssd1306_draw_string(&ssd, "Pressione BOTAO A", 0, 35);
-                break;
-            case SYS_RECORDING:
-                ssd1306_draw_string(&ssd, "Gravando...", 0, 25);
-                sprintf(line_buffer, "Amostras: %lu", sample_counter);
-                ssd1306_draw_string(&ssd, line_buffer, 0, 35);
-                uint64_t elapsed_ms = absolute_time_diff_us(recording_start_time, get_absolute_time()) / 1000;
-                sprintf(line_buffer, "Tempo: %lu s", elapsed_ms / 1000);
-                ssd1306_draw_string(&ssd, line_buffer, 0, 45);
-                break;
-            case SYS_DATA_SAVED:
-                ssd1306_draw_string(&ssd, "Dados Salvos!", 0, 25);
-                sprintf(line_buffer, "Amostras: %lu", sample_counter);
-                ssd1306_draw_string(&ssd, line_buffer, 0, 35);
-                ssd1306_draw_string(&ssd, "Pressione BOTAO A", 0, 45);
-                break;
-            case SYS_ERROR:
-                ssd1306_draw_string(&ssd, "ERRO NO SISTEMA!", 0, 25);
-                ssd1306_draw_string(&ssd, "Reinicie o Pico", 0, 35);
-                break;
+    uint32_t t0 = time_us_32();
+    // Retrato do estado para lib/display_pages.c (as páginas não leem nada)
+    display_view_t view = {
+        .page = current_display_page,
+        .state = current_system_state,
+        .samples = sample_counter,
+        .ring = &chart_ring,
+        .chart_channel = chart_channel,
+    };
+    if (current_display_page == 0) {
+        view.space_low = sd_space_low();
+        view.free_mb = (uint32_t)(sd_space_free_bytes() >> 20);
+        if (current_system_state == SYS_RECORDING) {
+            view.elapsed_s = (uint32_t)(absolute_time_diff_us(recording_start_time, get_absolute_time()) / 1000000);
+            view.remaining_s = sd_space_remaining_s();
         }
-    } else if (current_display_page == 1) { // Página de Dados IMU (em tempo real)
-        ssd1306_draw_string(&ssd, "DADOS IMU", 0, 0);
-        ssd1306_draw_string(&ssd, "----------------", 0, 10);
-
+    } else if (current_display_page == 1) {
+        mpu6050_read_raw(view.accel, view.gyro, &view.temp);
+    } else if (!recording_active &&
+               absolute_time_diff_us(chart_idle_sample, get_absolute_time()) >= SAMPLE_PERIOD_MS * 1000) {
+        // Gravando, quem alimenta o gráfico é a aquisição; parado, o IMU é
+        // lido aqui no mesmo intervalo
+        chart_idle_sample = get_absolute_time();
         int16_t accel[3], gyro[3], temp;
         mpu6050_read_raw(accel, gyro, &temp);
-
-        sprintf(line_buffer, "Ax: %d Ay: %d Az: %d", accel[0], accel[1], accel[2]);
-        ssd1306_draw_string(&ssd, line_buffer, 0, 25);
-
-        sprintf(line_buffer, "Gx: %d Gy: %d Gz: %d", gyro[0], gyro[1], gyro[2]);
-        ssd1306_draw_string(&ssd, line_buffer, 0, 35);
-
-        float temp_c = temp / 340.0 + 36.53; // Conversão típica para MPU6050
-        sprintf(line_buffer, "Temp: %.1f C", temp_c);
-        ssd1306_draw_string(&ssd, line_buffer, 0, 45);
+        chart_add_sample(accel, gyro);
     }
+    display_pages_draw(&ssd, &view);
+
+    uint32_t t1 = time_us_32();
+    uint32_t bytes = ssd.bytes_sent;
+    // Só as janelas que mudaram, por DMA: a amostragem segue enquanto o quadro
+    // sai. Se o anterior ainda não terminou, as mudanças vão no próximo
+    ssd1306_send_data_async(&ssd);
+    display_draw_us += t1 - t0;
+    display_send_us += time_us_32() - t1;
+    display_bytes += ssd.bytes_sent - bytes;
+    display_frames++;
+}
 
-    ssd1306_send_data(&ssd);
+// --- Funções de diagnóstico ---
+
+// Símbolos do linker script do RP2040: o heap vai de __end__ até __StackLimit
+extern char __end__, __StackLimit;
+
+// Imprime o uso de heap pela USB. Complementa o relatório de RAM estática
+// gerado no build (tools/ram_report.py).
+//   em uso: blocos alocados agora (uordblks)
+//   arena: o que o sbrk já tirou da região do heap; a newlib quase nunca
+//     devolve, então na prática é o pico
+//   livre: o que ainda não saiu da região mais os blocos livres da arena
+//   total: a região inteira, de __end__ até __StackLimit
+void print_memory_usage(const char *when) {
+    struct mallinfo mi = mallinfo();
+    size_t heap_total = (size_t)(&__StackLimit - &__end__);
+    printf("[mem %s] perfil %s: heap em uso %u B, arena (pico) %u B, livre %u B de %u B\n",
+           when, DATALOGGER_PROFILE_NAME, (unsigned)mi.uordblks, (unsigned)mi.arena,
+           (unsigned)(heap_total - mi.arena + mi.fordblks), (unsigned)heap_total);
+    mem_pool_report_all();
 }
 
 // --- Funções de Controle de Botões ---
@@ -316,6 +638,7 @@ void update_display() {
 // Variáveis para debouncing
 static uint64_t last_button_a_press_time = 0;
 static uint64_t last_button_b_press_time = 0;
+static uint64_t last_button_joy_press_time = 0;
 const uint64_t debounce_delay_ms = 200; // 200 ms
 
 bool is_button_pressed(uint gpio_pin, uint64_t *last_press_time) { // CORRIGIDO: uint66_t para uint64_t
@@ -337,6 +660,202 @@ void gpio_irq_handler_bootsel(uint gpio, uint32_t events) {
     }
 }
 
+// --- Tarefas do laço principal ---
+
+static task_sched_t sched;
+static task_t acquisition_task, card_task; // Definidas depois das funções
+
+static void stop_recording(const char *stop_reason);
+
+// Sessão interrompida no meio, sem o trailer. Nada mais vai para o log: o
+// writer fica em erro (numa falha de escrita ele já está) e os blocos que o
+// core 1 ainda tem são soltos sem gravar.
+//   card_gone = false: erro de escrita com o cartão no soquete; os arquivos
+//     são fechados e o que já foi gravado continua legível
+//   card_gone = true: cartão retirado; nenhum f_close (ele tentaria gravar a
+//     FAT e a entrada do diretório), o f_unmount em seguida invalida os FIL
+static void abort_recording(bool card_gone) {
+    current_system_state = SYS_ERROR;
+    recording_active = false;
+    task_stop(&acquisition_task);
+    if (log_writer.error == FR_OK)
+        log_writer.error = FR_NOT_READY;
+#if DATALOGGER_LOG_BLOCKS
+    block_log_discard();
+#endif
+    if (card_gone) {
+        log_index.open = false;
+        log_preview.open = false;
+        return;
+    }
+    f_close(&log_file);
+    log_index_close(&log_index);
+    log_preview_close(&log_preview);
+}
+
+// Uma amostra por SAMPLE_PERIOD_MS, só durante a gravação: lê o IMU e
+// formata/codifica o registro no buffer do log (o cartão fica com storage)
+static void acquisition_run(task_t *task) {
+    (void)task;
+    int16_t accel[3], gyro[3], temp;
+    mpu6050_read_raw(accel, gyro, &temp);
+    chart_add_sample(accel, gyro);
+
+    if (!write_log_record(sample_counter, accel, gyro)) {
+        abort_recording(false);
+        return;
+    }
+    sample_counter++;
+    if (sd_space_low()) {
+        // Cartão quase cheio: encerra a sessão antes de o f_write falhar
+        DBG_PRINTF("Espaco livre na reserva, encerrando gravacao\n");
+        beep_duplo();
+        stop_recording("cartao_cheio");
+    }
+}
+
+// Descarrega o log fora da aquisição: com o buffer quase cheio (ou os blocos
+// que o core 1 já comprimiu), antes que a próxima amostra precise esperar o
+// f_write
+static void storage_run(task_t *task) {
+    (void)task;
+    if (!recording_active)
+        return;
+#if DATALOGGER_LOG_BLOCKS
+    FRESULT fr = block_log_poll();
+#else
+    FRESULT fr = log_writer.error;
+    if (LOG_WRITER_BUFFER_SIZE - log_writer.len < 4 * LOG_MAX_RECORD)
+        fr = log_writer_flush_sectors(&log_writer); // O setor parcial fica no buffer
+#endif
+    // Com blocos, o total só cresce aqui, quando o core 1 entrega o bloco
+    sd_space_session_bytes(log_writer.total);
+    if (fr != FR_OK) {
+        DBG_PRINTF("Erro ao escrever no SD: %s (%d)\n", FRESULT_str(fr), fr);
+        abort_recording(false);
+    }
+}
+
+static void start_recording(void) {
+    beep_curto();
+    current_system_state = SYS_RECORDING;
+    recording_active = true;
+    sample_counter = 0;
+    recording_start_time = get_absolute_time();
+    sd_space_session_start();
+    // Abre o arquivo de log
+    char* filename = get_next_log_filename();
+    led_pattern_flash(&led_sd_access);
+    if (!open_log_file(filename)) {
+        current_system_state = SYS_ERROR;
+        recording_active = false;
+        return;
+    }
+    task_sched_reset_stats(&sched);
+    task_start(&sched, &acquisition_task, 0);
+}
+
+static void stop_recording(const char *stop_reason) {
+    recording_active = false;
+    task_stop(&acquisition_task);
+    led_pattern_flash(&led_sd_access);
+    close_log_file(stop_reason); // Descarrega o buffer e fecha o arquivo
+    task_sched_report(&sched);
+    current_system_state = SYS_DATA_SAVED;
+    print_memory_usage("fim da gravacao");
+}
+
+// Botão A (estado e navegação) e botão do joystick (canal do gráfico)
+static void button_run(task_t *task) {
+    (void)task;
+    if (is_button_pressed(BOTAO_A_PIN, &last_button_a_press_time)) {
+        if (current_system_state == SYS_READY && sd_space_low()) {
+            // Sem espaço para uma nova sessão: avisa e continua em READY
+            beep_duplo();
+        } else if (current_system_state == SYS_READY) {
+            start_recording();
+        } else if (current_system_state == SYS_RECORDING) {
+            beep_duplo();
+            stop_recording("botao");
+        } else if (current_system_state == SYS_DATA_SAVED || current_system_state == SYS_SD_NOT_DETECTED || current_system_state == SYS_ERROR) {
+            // Volta para o estado READY ou tenta remontar SD
+            current_system_state = SYS_INITIALIZING; // Tenta re-inicializar
+            task_start(&sched, &card_task, 0);
+        }
+
+        // Lógica de navegação de página do display (sempre que o botão A for pressionado e não estiver gravando)
+        if (!recording_active) {
+            current_display_page = (current_display_page + 1) % 3; // Alterna entre as páginas 0, 1 e 2
+        }
+    }
+
+    // Botão do joystick: próximo canal no gráfico
+    if (is_button_pressed(BOTAO_JOY_PIN, &last_button_joy_press_time) && current_display_page == 2) {
+        chart_channel = (chart_channel + 1) % SAMPLE_RING_CHANNELS;
+    }
+}
+
+// LED RGB: o padrão do estado atual; o timer do led_pattern faz o resto
+static void ui_run(task_t *task) {
+    (void)task;
+    led_pattern_set(&state_led[current_system_state]);
+}
+
+static void display_run(task_t *task) {
+    (void)task;
+    update_display();
+}
+
+// Cartão ainda no soquete: o card detect, quando ligado, e um CMD13 para
+// confirmar (com o cartão ocupado numa escrita o DO em zero já basta)
+static bool sd_card_present(void) {
+    sd_card_t *sd = sd_get_by_num(0);
+    return sd_card_detect(sd) && sd->sd_test_com(sd);
+}
+
+// Cartão SD: montagem na inicialização e novas tentativas a cada
+// CARD_PERIOD_MS enquanto não for detectado; montado, confere a cada período
+// se ele continua lá e, se foi retirado, encerra a gravação e desmonta
+static void card_run(task_t *task) {
+    (void)task;
+    if (current_system_state == SYS_READY || current_system_state == SYS_RECORDING ||
+        current_system_state == SYS_DATA_SAVED) {
+        if (sd_card_present())
+            return;
+        DBG_PRINTF("Cartao SD removido\n");
+        if (recording_active)
+            abort_recording(true); // O que estava no buffer se perde com o cartão
+        unmount_sd_card();
+        current_system_state = SYS_SD_NOT_DETECTED;
+        led_pattern_flash(&led_sd_missing);
+        beep_duplo();
+        return;
+    }
+    if (current_system_state != SYS_INITIALIZING && current_system_state != SYS_SD_NOT_DETECTED)
+        return;
+    bool was_missing = current_system_state == SYS_SD_NOT_DETECTED;
+    if (mount_sd_card()) {
+        current_system_state = SYS_READY;
+    } else if (!was_missing) {
+        current_system_state = SYS_SD_NOT_DETECTED;
+        led_pattern_flash(&led_sd_missing);
+    }
+}
+
+// Prioridade: a amostragem primeiro; o display, que pode perder quadros, e o
+// cartão ausente por último
+static task_t acquisition_task = {.name = "aquisicao", .run = acquisition_run, .priority = 0,
+                                  .period_us = SAMPLE_PERIOD_MS * 1000};
+static task_t button_task = {.name = "botoes", .run = button_run, .priority = 1,
+                             .period_us = BUTTON_PERIOD_MS * 1000};
+static task_t storage_task = {.name = "cartao", .run = storage_run, .priority = 2,
+                              .period_us = STORAGE_PERIOD_MS * 1000};
+static task_t ui_task = {.name = "led", .run = ui_run, .priority = 3, .period_us = UI_PERIOD_MS * 1000};
+static task_t display_task = {.name = "display", .run = display_run, .priority = 4,
+                              .period_us = DISPLAY_PERIOD_MS * 1000};
+static task_t card_task = {.name = "deteccao", .run = card_run, .priority = 5,
+                           .period_us = CARD_PERIOD_MS * 1000};
+
 // --- Função Principal ---
 int main() {
     stdio_init_all();
@@ -365,117 +884,43 @@ int main() {
 
     // Inicializa o display SSD1306
     ssd1306_init(&ssd, OLED_WIDTH, OLED_HEIGHT, false, OLED_ADDR, I2C_PORT_DISP);
-    ssd1306_config(&ssd);
+    uint32_t t_config = time_us_32();
+    ssd1306_config(&ssd); // Uma transação com todos os comandos
     ssd1306_send_data(&ssd);
+    printf("[oled] configuracao e primeiro quadro: %lu us, %lu B\n",
+           time_us_32() - t_config, ssd.bytes_sent);
+    if (!ssd1306_dma_init(&ssd)) { // Quadros seguintes saem por DMA
+        DBG_PRINTF("OLED sem DMA: envio bloqueante\n");
+    }
 
-    // --- Loop Principal da Máquina de Estados ---
-    while (true) {
-        // Lógica de Botão A para controle de estado e navegação
-        if (is_button_pressed(BOTAO_A_PIN, &last_button_a_press_time)) {
-            if (current_system_state == SYS_READY) {
-                // Inicia a gravação
-                beep_curto();
-                current_system_state = SYS_RECORDING;
-                recording_active = true;
-                sample_counter = 0;
-                recording_start_time = get_absolute_time();
-                // Abre o arquivo de log
-                char* filename = get_next_log_filename();
-                set_led_color(false, false, true); // Azul piscando para acesso ao SD
-                blink_led(false, false, true, 100, 2); // 2 piscadas rápidas
-                FRESULT fr = f_open(&log_file, filename, FA_WRITE | FA_CREATE_ALWAYS);
-                if (fr == FR_OK) {
-                    // Escreve o cabeçalho CSV
-                    f_printf(&log_file, "Sample,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ\n");
-                } else {
-                    current_system_state = SYS_ERROR;
-                    DBG_PRINTF("Erro ao abrir arquivo de log: %s (%d)\n", FRESULT_str(fr), fr);
-                }
-            } else if (current_system_state == SYS_RECORDING) {
-                // Para a gravação
-                beep_duplo();
-                recording_active = false;
-                set_led_color(false, false, true); // Azul piscando para acesso ao SD
-                blink_led(false, false, true, 100, 2); // 2 piscadas rápidas
-                f_close(&log_file); // Fecha o arquivo
-                current_system_state = SYS_DATA_SAVED;
-            } else if (current_system_state == SYS_DATA_SAVED || current_system_state == SYS_SD_NOT_DETECTED || current_system_state == SYS_ERROR) {
-                // Volta para o estado READY ou tenta remontar SD
-                current_system_state = SYS_INITIALIZING; // Tenta re-inicializar
-            }
-
-            // Lógica de navegação de página do display (sempre que o botão A for pressionado e não estiver gravando)
-            if (!recording_active) {
-                current_display_page = (current_display_page + 1) % 2; // Alterna entre página 0 e 1
-            }
-        }
+    sample_ring_init(&chart_ring, CHART_DECIMATION);
+
+    print_memory_usage("boot");
+
+#if DATALOGGER_LOG_BLOCKS
+    block_log_init(); // Core 1 passa a comprimir os blocos do log
+#endif
+
+    // --- Laço principal: escalonador cooperativo ---
+    // Cada parte do sistema é uma tarefa que roda até o fim quando vence o
+    // seu prazo; nenhuma dorme. Sem tarefa vencida o core 0 dorme até o
+    // próximo prazo (ver task_sched.h)
+    task_sched_init(&sched, time_us_64);
+    task_add(&sched, &acquisition_task);
+    task_add(&sched, &button_task);
+    task_add(&sched, &storage_task);
+    task_add(&sched, &ui_task);
+    task_add(&sched, &display_task);
+    task_add(&sched, &card_task);
+    task_start(&sched, &button_task, 0);
+    task_start(&sched, &storage_task, 0);
+    task_start(&sched, &ui_task, 0);
+    task_start(&sched, &display_task, 0);
+    task_start(&sched, &card_task, 0);
 
-        // --- Lógica da Máquina de Estados ---
-        switch (current_system_state) {
-            case SYS_INITIALIZING:
-                set_led_color(true, true, false); // Amarelo
-                update_display();
-                if (mount_sd_card()) {
-                    current_system_state = SYS_READY;
-                } else {
-                    current_system_state = SYS_SD_NOT_DETECTED;
-                    blink_led(true, false, true, 200, 5); // Roxo piscando para erro
-                }
-                break;
-
-            case SYS_SD_NOT_DETECTED:
-                set_led_color(true, false, true); // Roxo
-                update_display();
-                sleep_ms(1000); // Espera antes de tentar novamente ou para o usuário ver
-                // O usuário pode pressionar A para tentar re-inicializar
-                break;
-
-            case SYS_READY:
-                set_led_color(false, true, false); // Verde
-                update_display();
-                // Espera pelo botão A para iniciar a gravação
-                break;
-
-            case SYS_RECORDING: {
-                set_led_color(true, false, false); // Vermelho
-                update_display(); // Atualiza display com contador
-
-                int16_t accel[3], gyro[3], temp;
-                mpu6050_read_raw(accel, gyro, &temp);
-
-                char data_line[100];
-                sprintf(data_line, "%lu,%d,%d,%d,%d,%d,%d\n",
-                                    sample_counter, accel[0], accel[1], accel[2],
-                                    gyro[0], gyro[1], gyro[2]);
-
-                UINT bw;
-                set_led_color(false, false, true); // Azul piscando para acesso ao SD
-                FRESULT fr = f_write(&log_file, data_line, strlen(data_line), &bw);
-                set_led_color(true, false, false); // Volta para vermelho
-                if (fr != FR_OK || bw != strlen(data_line)) {
-                    current_system_state = SYS_ERROR;
-                    DBG_PRINTF("Erro ao escrever no SD: %s (%d)\n", FRESULT_str(fr), fr);
-                    f_close(&log_file);
-                } else {
-                    sample_counter++;
-                }
-                sleep_ms(100); // Intervalo entre amostras (100ms)
-                break;
-            }
-
-            case SYS_DATA_SAVED:
-                set_led_color(false, true, false); // Verde
-                update_display();
-                sleep_ms(1000); // Exibe "Dados Salvos!" por um tempo
-                // Espera pelo botão A para voltar ao READY
-                break;
-
-            case SYS_ERROR:
-                set_led_color(true, false, true); // Roxo
-                update_display();
-                blink_led(true, false, true, 200, 1); // Piscada contínua de erro
-                sleep_ms(500); // Pequeno delay para o piscar
-                break;
+    while (true) {
+        if (!task_sched_run_once(&sched)) {
+            sleep_until(from_us_since_boot(task_sched_next_due(&sched)));
         }
     }
     return 0;
@@ -0,0 +1,323 @@
+"""Descompressor e validador dos logs em blocos (.lzb) do datalogger.
+
+Formato descrito em lib/block_frame.h: cada bloco tem um cabecalho de 32 bytes
+("LZB2", numero de sequencia, primeira amostra e seu tempo em ms, tamanho
+bruto, tamanho comprimido, CRC32 dos dados brutos e CRC32 do proprio
+cabecalho) seguido dos dados no formato de bloco do LZ4 (ou brutos, se nao
+comprimiram). Os blocos descomprimidos, concatenados, formam o .csv ou o .imu
+original. Logs antigos usam o cabecalho de 16 bytes "LZB1" (sem sequencia,
+amostra nem CRC do cabecalho), que continua sendo lido.
+
+No formato colunar ("columns") o cabecalho tem 60 bytes ("LZC1"): os mesmos
+campos mais o numero de amostras do bloco e o minimo e o maximo de cada canal.
+Os dados trazem os seis canais em sequencia (int16 little-endian, count
+valores cada; a amostra i e first_sample + i) e depois o texto de metadados.
+
+Um trecho corrompido perde so os blocos atingidos: a leitura procura o proximo
+"LZB2"/"LZC1" com cabecalho valido e continua dali. O resumo lista as amostras (e os
+segundos) perdidos.
+
+    python block_decode.py log_000.lzb               # valida e mostra o resumo
+    python block_decode.py log_000.lzb --out log.imu # grava o conteudo original
+"""
+
+import argparse
+import collections
+import os
+import struct
+import sys
+import zlib
+
+import numpy as np
+
+import imu_decode
+
+MAGIC = b'LZB2'
+MAGIC_V1 = b'LZB1'
+MAGIC_COLUMNS = b'LZC1'
+HEADER_SIZE = 32
+HEADER_SIZE_V1 = 16
+HEADER_SIZE_COLUMNS = 60
+HEADER_SIZES = {MAGIC: HEADER_SIZE, MAGIC_V1: HEADER_SIZE_V1, MAGIC_COLUMNS: HEADER_SIZE_COLUMNS}
+MAX_RAW = 65536
+MIN_MATCH = 4
+
+# count, min e max (tuplas com os seis canais) so existem no cabecalho colunar
+Header = collections.namedtuple('Header',
+                                'size seq first_sample first_ms raw_len comp_len crc count min max',
+                                defaults=(None, None, None))
+
+# Um bloco lido: raw e None se esta corrompido (err diz o motivo). seq,
+# first_sample e first_ms sao None nos blocos versao 1 e nos trechos ilegiveis;
+# count (amostras do bloco colunar) e None fora do formato colunar
+Block = collections.namedtuple('Block',
+                               'offset raw_len comp_len raw err seq first_sample first_ms count',
+                               defaults=(None,))
+
+
+def lz_decompress(src, raw_len):
+    """Descompressao do formato de bloco do LZ4 (mesmo de lib/lz_block.c)."""
+    out = bytearray()
+    pos = 0
+    end = len(src)
+
+    def length(value):
+        nonlocal pos
+        if value == 15:
+            while True:
+                b = src[pos]
+                pos += 1
+                value += b
+                if b != 255:
+                    break
+        return value
+
+    while pos < end:
+        token = src[pos]
+        pos += 1
+        lit = length(token >> 4)
+        out += src[pos:pos + lit]
+        pos += lit
+        if pos >= end:
+            break
+        offset = src[pos] | (src[pos + 1] << 8)
+        pos += 2
+        match = length(token & 15) + MIN_MATCH
+        if offset == 0 or offset > len(out):
+            raise ValueError('offset invalido')
+        start = len(out) - offset
+        if match <= offset:
+            out += out[start:start + match]
+        else:                                   # Match sobreposto: byte a byte
+            for i in range(match):
+                out.append(out[start + i])
+    if len(out) != raw_len:
+        raise ValueError(f'tamanho descomprimido {len(out)} != {raw_len}')
+    return bytes(out)
+
+
+def parse_header(data, pos=0):
+    """Cabecalho (Header) em data[pos:], ou None se nao ha um cabecalho valido
+    ali (sincronismo, tamanhos ou CRC do cabecalho) ou se ele esta cortado."""
+    magic = bytes(data[pos:pos + 4])
+    if magic == MAGIC and len(data) - pos >= HEADER_SIZE:
+        fields = struct.unpack_from('<7I', data, pos + 4)
+        if fields[6] != zlib.crc32(data[pos:pos + 28]):
+            return None
+        h = Header(HEADER_SIZE, *fields[:6])
+    elif magic == MAGIC_COLUMNS and len(data) - pos >= HEADER_SIZE_COLUMNS:
+        fields = struct.unpack_from('<6IHH6h6hI', data, pos + 4)
+        if fields[-1] != zlib.crc32(data[pos:pos + 56]):
+            return None
+        h = Header(HEADER_SIZE_COLUMNS, *fields[:6], fields[6], fields[8:14], fields[14:20])
+        if h.raw_len < h.count * 2 * imu_decode.CHANNELS:
+            return None
+    elif magic == MAGIC_V1 and len(data) - pos >= HEADER_SIZE_V1:
+        raw_len, comp_len, crc = struct.unpack_from('<III', data, pos + 4)
+        h = Header(HEADER_SIZE_V1, None, None, None, raw_len, comp_len, crc)
+    else:
+        return None
+    if not 0 < h.raw_len <= MAX_RAW or h.comp_len > h.raw_len:
+        return None
+    return h
+
+
+def find_sync(data, pos):
+    """Offset do proximo cabecalho valido a partir de pos (len(data) se nao ha)."""
+    while True:
+        pos = data.find(b'LZ', pos)
+        if pos < 0:
+            return len(data)
+        if parse_header(data, pos):
+            return pos
+        pos += 1
+
+
+def read_blocks(data, decompress=None):
+    """Gera um Block para cada bloco do arquivo e para cada trecho ilegivel.
+    decompress(payload, raw_len) troca o descompressor (log_loader usa o lz4)."""
+    decompress = decompress or lz_decompress
+    pos = 0
+    while pos < len(data):
+        h = parse_header(data, pos)
+        if h is None:
+            size = HEADER_SIZES.get(bytes(data[pos:pos + 4]))
+            if size and len(data) - pos < size:
+                yield Block(pos, 0, 0, None, 'cabecalho truncado', None, None, None)
+                return
+            end = find_sync(data, pos + 1)
+            yield Block(pos, 0, 0, None, f'{end - pos} bytes ilegiveis', None, None, None)
+            pos = end
+            continue
+        payload = bytes(data[pos + h.size:pos + h.size + h.comp_len])
+        if len(payload) < h.comp_len:
+            yield Block(pos, h.raw_len, h.comp_len, None, 'bloco truncado', h.seq,
+                        h.first_sample, h.first_ms, h.count)
+            return
+        try:
+            raw = payload if h.comp_len == h.raw_len else decompress(payload, h.raw_len)
+            err = None if zlib.crc32(raw) == h.crc else 'CRC invalido'
+        except (ValueError, IndexError) as e:
+            raw, err = None, str(e)
+        yield Block(pos, h.raw_len, h.comp_len, raw if err is None else None, err, h.seq,
+                    h.first_sample, h.first_ms, h.count)
+        pos += h.size + h.comp_len
+
+
+def first_block(f):
+    """Dados brutos do primeiro bloco do arquivo aberto f (None se ilegivel)."""
+    f.seek(0)
+    data = f.read(HEADER_SIZE_COLUMNS)
+    h = parse_header(data)
+    if h is None:
+        return None
+    data += f.read(max(0, h.size + h.comp_len - len(data)))
+    return next(read_blocks(data)).raw
+
+
+def decompress_file(file_name):
+    """Retorna (lista dos blocos validos (Block), erros [(offset, mensagem)])."""
+    with open(file_name, 'rb') as f:
+        data = f.read()
+    blocks, errors = [], []
+    for b in read_blocks(data):
+        if b.err:
+            errors.append((b.offset, b.err))
+        else:
+            blocks.append(b)
+    return blocks, errors
+
+
+def content_type(blocks):
+    """'columns', 'imu' ou 'csv', pelo cabecalho do primeiro bloco (ou pelo
+    conteudo)."""
+    if not blocks:
+        return 'csv'
+    if blocks[0].count is not None:
+        return 'columns'
+    first = blocks[0].raw
+    if first.startswith(imu_decode.MAGIC):
+        return 'imu'
+    if blocks[0].offset == 0 or first[:1].isdigit():
+        return 'csv'
+    return 'imu'
+
+
+def column_rows(block):
+    """Amostras de um bloco colunar (sample + seis canais) e o texto dele."""
+    n = block.count
+    values = np.frombuffer(block.raw, '<i2', n * imu_decode.CHANNELS).reshape(imu_decode.CHANNELS, n)
+    samples = block.first_sample + np.arange(n, dtype=np.int64)
+    rows = np.column_stack([samples, values.T.astype(np.int64)])
+    return rows, block.raw[n * 2 * imu_decode.CHANNELS:].decode('ascii', errors='replace')
+
+
+def parse_blocks(blocks, kind=None, meta=None):
+    """Amostras dos blocos validos. Cada bloco decodifica sozinho, entao um
+    bloco corrompido so remove as amostras dele. kind ('imu'/'csv') vem do
+    indice quando os blocos nao incluem o primeiro do arquivo; blocos colunares
+    se identificam pelo cabecalho. Se meta for uma lista, recebe o texto de
+    metadados (cabecalho e trailer)."""
+    kind = kind or content_type(blocks)
+    meta = [] if meta is None else meta
+    parts = []
+    for b in blocks:
+        raw = b.raw
+        if b.count is not None:
+            rows, text = column_rows(b)
+            meta.append(text)
+            parts.append(rows.astype(float))
+        elif kind == 'imu':
+            start = 0
+            if raw.startswith(imu_decode.MAGIC):
+                _, start, text = imu_decode.read_header(raw)
+                meta.append(text)
+            parts.append(imu_decode.decode_records(raw, start, meta).astype(float))
+        else:
+            text = raw.decode('ascii', errors='replace')
+            meta.extend(ln + '\n' for ln in text.splitlines() if ln.startswith('#'))
+            # Sem a linha de colunas e os comentarios de metadados
+            lines = [ln for ln in text.splitlines() if ln and ln[0] not in 'S#']
+            if lines:
+                parts.append(np.loadtxt(lines, delimiter=',', ndmin=2))
+    if not parts:
+        return np.empty((0, 1 + imu_decode.CHANNELS))
+    return np.vstack(parts)
+
+
+def lost_ranges(rows, blocks, errors, period=None):
+    """Trechos de amostras perdidos nos erros de leitura: lista de (primeira
+    amostra, amostra seguinte ao trecho ou None se vai ate o fim, inicio (s),
+    fim (s)). Os tempos vem dos cabecalhos dos blocos validos (versao 2),
+    interpolados, ou de period (s por amostra); sem nenhum dos dois sao None."""
+    if not errors:
+        return []
+    samples = rows[:, 0].astype(np.int64)
+    gaps = np.flatnonzero(np.diff(samples) > 1)
+    ranges = [(int(samples[i]) + 1, int(samples[i + 1])) for i in gaps]
+    if len(samples) and samples[0] > 0:
+        ranges.insert(0, (0, int(samples[0])))
+    if not blocks or errors[-1][0] > blocks[-1].offset:
+        ranges.append((int(samples[-1]) + 1 if len(samples) else 0, None))
+
+    anchors = [(0, 0)] + [(b.first_sample, b.first_ms) for b in blocks if b.first_sample is not None]
+    s = np.array([a[0] for a in anchors], dtype=float)
+    ms = np.array([a[1] for a in anchors], dtype=float)
+
+    def seconds(sample):
+        if sample is None:
+            return None
+        if len(s) > 1 and s[-1] > 0:
+            if sample <= s[-1]:
+                return float(np.interp(sample, s, ms)) / 1000.0
+            return (ms[-1] + (sample - s[-1]) * ms[-1] / s[-1]) / 1000.0
+        return sample * period if period else None
+
+    return [(a, b, seconds(a), seconds(b)) for a, b in ranges]
+
+
+def load_blocks(file_name):
+    """Amostras de um .lzb no mesmo formato de np.loadtxt() do CSV."""
+    blocks, _ = decompress_file(file_name)
+    return parse_blocks(blocks)
+
+
+def main():
+    import log_meta  # log_meta importa este modulo
+    parser = argparse.ArgumentParser(description='Descompressor/validador dos logs .lzb')
+    parser.add_argument('file', help='Arquivo .lzb')
+    parser.add_argument('--out', help='Grava o conteudo descomprimido (.csv ou .imu)')
+    args = parser.parse_args()
+
+    blocks, errors = decompress_file(args.file)
+    content = b''.join(b.raw for b in blocks)
+    size = os.path.getsize(args.file)
+    stored = sum(1 for b in blocks if b.raw_len == b.comp_len)
+    version = 1 if blocks and blocks[0].seq is None else 2
+    print(f'{os.path.basename(args.file)}: {len(blocks)} blocos validos ({stored} sem compressao), '
+          f'versao {version}, conteudo {content_type(blocks)}')
+    texts = []
+    rows = parse_blocks(blocks, meta=texts)
+    if content:
+        print(f'  {size} B no cartao -> {len(content)} B descomprimidos ({len(content) / size:.2f}x)')
+        print(f'  {len(rows)} amostras')
+    for offset, err in errors:
+        print(f'  ERRO no byte {offset}: {err}')
+    period = log_meta.sample_period_s(log_meta.parse(''.join(texts)))
+    for first, end, t0, t1 in lost_ranges(rows, blocks, errors, period):
+        samples = f'amostras {first} a {end - 1}' if end is not None else f'amostras {first} ate o fim'
+        if t0 is None:
+            print(f'  perdidas {samples}')
+        elif end is None:
+            print(f'  perdidas {samples} (de {t0:.3f} s ate o fim)')
+        else:
+            print(f'  perdidas {samples} ({t0:.3f} s a {t1:.3f} s)')
+    if args.out:
+        with open(args.out, 'wb') as f:
+            f.write(content)
+        print(f'Conteudo gravado em {args.out}')
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
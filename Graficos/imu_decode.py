@@ -0,0 +1,205 @@
+"""Leitura dos logs .imu (delta + zigzag varint) gerados pelo datalogger.
+
+Formato descrito em lib/imu_codec.h. Uso:
+
+    python imu_decode.py log_000.imu                 # resumo do arquivo
+    python imu_decode.py log_000.imu --csv saida.csv # converte para CSV
+    python imu_decode.py --encode log_000.csv        # taxa de compressao de um CSV
+
+O texto de metadados (lib/log_meta.h) do cabecalho e do registro de fim e
+interpretado por log_meta.py. A funcao load_imu() devolve o mesmo array que np.loadtxt() daria para o CSV
+equivalente (colunas Sample, AccelX..Z, GyroX..Z), entao plot_imu.py aceita
+os dois formatos.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+import numpy as np
+
+MAGIC = b'IMUZ'
+VERSION = 2
+CHANNELS = 6
+HEADER_SIZE = 10          # Sem o texto de metadados (versao 1: 8 bytes, sem texto)
+END_MARK = 0xFFFFFFFF     # Primeiro varint do registro de fim (trailer)
+CSV_HEADER = 'Sample,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ'
+RAW_RECORD_SIZE = 4 + 2 * CHANNELS  # uint32 + 6 x int16
+
+
+def _unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def _zigzag(v):
+    return ((v << 1) ^ (v >> 31)) & 0xFFFFFFFF
+
+
+def _put_varint(out, v):
+    while v >= 0x80:
+        out.append((v & 0x7F) | 0x80)
+        v >>= 7
+    out.append(v)
+
+
+def read_header(data):
+    """Retorna (intervalo de keyframe, offset do primeiro registro, texto de metadados)."""
+    if len(data) < 8 or data[:4] != MAGIC:
+        raise ValueError('arquivo nao e um log .imu (magic invalido)')
+    version, channels, keyframe = struct.unpack_from('<BBH', data, 4)
+    if version not in (1, VERSION) or channels != CHANNELS:
+        raise ValueError(f'versao {version} / {channels} canais nao suportados')
+    if version == 1:
+        return keyframe, 8, ''
+    text_len = struct.unpack_from('<H', data, 8)[0]
+    text = data[HEADER_SIZE:HEADER_SIZE + text_len].decode('ascii', errors='replace')
+    return keyframe, HEADER_SIZE + text_len, text
+
+
+def decode_records(data, pos=0, trailer=None):
+    """Decodifica registros a partir de data[pos:] (sem cabecalho).
+
+    O primeiro registro precisa ser um keyframe, como no inicio do arquivo ou
+    de cada bloco de um .lzb. A decodificacao para no registro de fim; se
+    trailer for uma lista, o texto dele e acrescentado nela.
+    """
+    rows = []
+    prev = [0] * CHANNELS
+    sample = -1
+    end = len(data)
+
+    def varint():
+        nonlocal pos
+        shift = result = 0
+        while True:
+            if pos >= end:
+                raise EOFError
+            b = data[pos]
+            pos += 1
+            result |= (b & 0x7F) << shift
+            if b < 0x80:
+                return result
+            shift += 7
+
+    while pos < end:
+        start = pos
+        try:
+            first = varint()
+            if first == END_MARK:                   # Registro de fim
+                if pos + 2 > end:
+                    raise EOFError
+                text_len = struct.unpack_from('<H', data, pos)[0]
+                if trailer is not None:
+                    trailer.append(data[pos + 2:pos + 2 + text_len].decode('ascii', errors='replace'))
+                break
+            if first & 1:                           # Keyframe: valores absolutos
+                sample = first >> 1
+                values = [_unzigzag(varint()) for _ in range(CHANNELS)]
+            else:                                   # Delta sobre a amostra anterior
+                if sample < 0:
+                    raise ValueError(f'registro delta antes do primeiro keyframe (byte {start})')
+                sample += 1
+                deltas = [_unzigzag(first >> 1)] + [_unzigzag(varint()) for _ in range(CHANNELS - 1)]
+                values = [(p + d + 0x8000) % 0x10000 - 0x8000 for p, d in zip(prev, deltas)]
+        except EOFError:
+            print(f'aviso: registro incompleto no fim dos dados (byte {start}) descartado',
+                  file=sys.stderr)
+            break
+        prev = values
+        rows.append([sample] + values)
+
+    return np.array(rows, dtype=np.int64).reshape(-1, 1 + CHANNELS)
+
+
+def decode(data):
+    """Decodifica o conteudo de um .imu; retorna (array Nx7, intervalo de
+    keyframe, texto de metadados do cabecalho e do trailer)."""
+    keyframe, pos, text = read_header(data)
+    trailer = []
+    rows = decode_records(data, pos, trailer)
+    return rows, keyframe, text + ''.join(trailer)
+
+
+def encode(rows, keyframe=256, meta=''):
+    """Codificador de referencia (mesmo algoritmo de lib/imu_codec.c)."""
+    text = meta.encode('ascii')
+    out = bytearray(MAGIC + struct.pack('<BBHH', VERSION, CHANNELS, keyframe, len(text)) + text)
+    prev = None
+    last_sample = None
+    since_key = keyframe
+    for row in rows:
+        sample, values = int(row[0]), [int(v) for v in row[1:1 + CHANNELS]]
+        if since_key >= keyframe or last_sample is None or sample != last_sample + 1:
+            _put_varint(out, ((sample << 1) | 1) & 0xFFFFFFFF)
+            for v in values:
+                _put_varint(out, _zigzag(v))
+            since_key = 0
+        else:
+            _put_varint(out, (_zigzag(values[0] - prev[0]) << 1) & 0xFFFFFFFF)
+            for v, p in zip(values[1:], prev[1:]):
+                _put_varint(out, _zigzag(v - p))
+        since_key += 1
+        last_sample = sample
+        prev = values
+    return bytes(out)
+
+
+def load_imu(file_name):
+    with open(file_name, 'rb') as f:
+        rows, _, _ = decode(f.read())
+    return rows.astype(float)
+
+
+def _csv_size(rows):
+    lines = [CSV_HEADER] + [','.join(str(int(v)) for v in r) for r in rows]
+    return len('\n'.join(lines)) + 1
+
+
+def report(rows, size, keyframe, label):
+    n = len(rows)
+    if n == 0:
+        print(f'{label}: nenhuma amostra')
+        return
+    csv_size = _csv_size(rows)
+    raw_size = HEADER_SIZE + n * RAW_RECORD_SIZE
+    print(f'{label}: {n} amostras (keyframe a cada {keyframe})')
+    print(f'  .imu:           {size:>9} B  ({size / n:.2f} B/amostra)')
+    print(f'  CSV equivalente:{csv_size:>9} B  ({csv_size / n:.2f} B/amostra)  -> {csv_size / size:.2f}x')
+    print(f'  binario bruto:  {raw_size:>9} B  ({RAW_RECORD_SIZE} B/amostra)      -> {raw_size / size:.2f}x')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodificador dos logs .imu do DataloggerIMU')
+    parser.add_argument('file', help='Arquivo .imu (ou .csv com --encode)')
+    parser.add_argument('--csv', metavar='SAIDA', help='Grava as amostras decodificadas em CSV')
+    parser.add_argument('--encode', action='store_true',
+                        help='Codifica um CSV existente e mostra a taxa de compressao')
+    parser.add_argument('--keyframe', type=int, default=256,
+                        help='Intervalo de keyframe usado com --encode (padrao 256)')
+    args = parser.parse_args()
+
+    if args.encode:
+        rows = np.loadtxt(args.file, delimiter=',', skiprows=1, dtype=np.int64, ndmin=2)
+        blob = encode(rows, args.keyframe)
+        decoded, keyframe, _ = decode(blob)
+        if not np.array_equal(decoded, rows):
+            print('ERRO: decodificacao nao reproduz o CSV de entrada', file=sys.stderr)
+            return 1
+        report(rows, len(blob), keyframe, os.path.basename(args.file))
+        return 0
+
+    with open(args.file, 'rb') as f:
+        data = f.read()
+    rows, keyframe, text = decode(data)
+    report(rows, len(data), keyframe, os.path.basename(args.file))
+    if text:
+        print('  ' + text.strip().replace('\n', '\n  '))
+    if args.csv:
+        np.savetxt(args.csv, rows, fmt='%d', delimiter=',', header=CSV_HEADER, comments='')
+        print(f'CSV gravado em {args.csv}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
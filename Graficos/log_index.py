@@ -0,0 +1,116 @@
+"""Leitura de janelas dos logs usando o indice .idx gravado junto com o log.
+
+Formato descrito em lib/log_index.h. Com o indice, ler "10 s a partir do
+minuto 42" le do cartao so os bytes entre as duas entradas mais proximas, em
+vez do arquivo inteiro.
+
+    python log_index.py log_003.csv                  # resumo do indice
+    python log_index.py log_003.csv 2520 10          # amostras de 2520 s a 2530 s
+"""
+
+import os
+import struct
+import sys
+
+import numpy as np
+
+import block_decode
+import imu_decode
+
+MAGIC = b'IDX1'
+ENTRY = np.dtype([('sample', '<u4'), ('time_ms', '<u4'), ('offset', '<u8')])
+KINDS = {0: 'csv', 1: 'imu', 2: 'lzb'}
+
+
+def index_path(data_file):
+    return os.path.splitext(data_file)[0] + '.idx'
+
+
+def read_index(idx_file):
+    """Retorna (tipo, intervalo, entradas) com entradas num array estruturado."""
+    with open(idx_file, 'rb') as f:
+        data = f.read()
+    if data[:4] != MAGIC:
+        raise ValueError(f'{idx_file}: indice invalido')
+    kind, interval = data[4], struct.unpack_from('<H', data, 6)[0]
+    n = (len(data) - ENTRY.itemsize) // ENTRY.itemsize
+    entries = np.frombuffer(data, dtype=ENTRY, count=n, offset=ENTRY.itemsize)
+    return KINDS.get(kind, 'csv'), interval, entries
+
+
+def _parse_chunk(kind, chunk, inner='csv'):
+    if kind == 'imu':
+        return imu_decode.decode_records(chunk).astype(float)
+    if kind == 'lzb':
+        blocks = [b for b in block_decode.read_blocks(chunk) if b.err is None]
+        return block_decode.parse_blocks(blocks, kind=inner)
+    lines = [ln for ln in chunk.decode('ascii', errors='replace').splitlines()
+             if ln and ln[0] != '#']
+    return np.loadtxt(lines, delimiter=',', ndmin=2) if lines else np.empty((0, 7))
+
+
+def _lzb_inner(f):
+    """Formato dentro de um .lzb ('imu' ou 'csv'), pelo primeiro bloco do arquivo."""
+    raw = block_decode.first_block(f)
+    return 'imu' if raw is not None and raw.startswith(imu_decode.MAGIC) else 'csv'
+
+
+def sample_times(entries, samples):
+    """Tempo (s) de cada amostra, interpolado entre as entradas do indice. Depois
+    da ultima entrada, extrapola com a taxa media do log."""
+    s, ms = entries['sample'].astype(float), entries['time_ms'].astype(float)
+    t = np.interp(samples, s, ms)
+    if len(s) > 1 and s[-1] > s[0]:
+        after = samples > s[-1]
+        t[after] = ms[-1] + (samples[after] - s[-1]) * (ms[-1] - ms[0]) / (s[-1] - s[0])
+    return t / 1000.0
+
+
+def read_window(data_file, start_s, duration_s):
+    """Amostras com tempo em [start_s, start_s + duration_s) e seus tempos (s).
+
+    Le do arquivo apenas o trecho entre as entradas do indice que cercam a
+    janela. Retorna (rows, t) com rows no formato de np.loadtxt() do CSV.
+    """
+    kind, _, entries = read_index(index_path(data_file))
+    if len(entries) == 0:
+        raise ValueError('indice vazio')
+    t0, t1 = start_s * 1000.0, (start_s + duration_s) * 1000.0
+
+    lo = max(np.searchsorted(entries['time_ms'], t0, side='right') - 1, 0)
+    hi = np.searchsorted(entries['time_ms'], t1, side='left')
+    start = int(entries['offset'][lo])
+    with open(data_file, 'rb') as f:
+        inner = _lzb_inner(f) if kind == 'lzb' else kind
+        f.seek(start)
+        chunk = f.read(int(entries['offset'][hi]) - start) if hi < len(entries) else f.read()
+
+    rows = _parse_chunk(kind, chunk, inner)
+    if len(rows) == 0:
+        return rows, np.empty(0)
+    t = sample_times(entries, rows[:, 0])
+    keep = (t >= start_s) & (t < start_s + duration_s)
+    return rows[keep], t[keep]
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+    data_file = sys.argv[1]
+    kind, interval, entries = read_index(index_path(data_file))
+    span = entries['time_ms'][-1] / 1000.0 if len(entries) else 0
+    print(f'{os.path.basename(data_file)}: indice {kind}, {len(entries)} entradas, '
+          f'intervalo {interval or "1 por bloco"}, ultima entrada em {span:.1f} s')
+    if len(sys.argv) >= 4:
+        rows, t = read_window(data_file, float(sys.argv[2]), float(sys.argv[3]))
+        print(f'janela: {len(rows)} amostras', end='')
+        if len(rows):
+            print(f' (amostras {int(rows[0, 0])}..{int(rows[-1, 0])}, {t[0]:.2f}..{t[-1]:.2f} s)')
+        else:
+            print()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
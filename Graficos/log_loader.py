@@ -0,0 +1,317 @@
+"""Carregamento rapido dos logs do datalogger (.csv, .imu, .lzb) com cache.
+
+- .imu: o arquivo e mapeado em memoria (mmap) e os varints sao decodificados
+  de forma vetorizada com numpy; so o trecho entre keyframes e percorrido em
+  Python (um passo a cada ~256 amostras).
+- .lzb: blocos descomprimidos com o pacote lz4 quando instalado (mesmo formato
+  de bloco), senao com block_decode.py; o conteudo segue o caminho do .csv ou
+  do .imu. No formato colunar cada bloco vira um array com np.frombuffer.
+- .csv: pandas (motor em C) quando instalado, senao np.loadtxt.
+
+O resultado fica em <log>.npz ao lado do arquivo, valido enquanto o tamanho e
+a data de modificacao do log nao mudarem: a segunda leitura e quase imediata.
+
+    python log_loader.py log_003.imu [log_004.lzb ...] [--no-cache]
+"""
+
+import argparse
+import io
+import json
+import mmap
+import os
+import struct
+import sys
+import time
+
+import numpy as np
+
+import block_decode
+import imu_decode
+import log_meta
+
+CACHE_VERSION = 1
+COLUMNS = 1 + imu_decode.CHANNELS
+_KEY_SEARCH = 1024  # Registros procurados por vez atras do proximo keyframe
+
+try:
+    import lz4.block as _lz4
+except ImportError:
+    _lz4 = None
+
+try:
+    import pandas as _pd
+except ImportError:
+    _pd = None
+
+
+# --- .imu ---
+
+def _varints(b):
+    """Todos os varints de b (uint8), vetorizado. Retorna (valores, offset final de cada um)."""
+    ends = np.flatnonzero(b < 0x80)
+    starts = np.empty_like(ends)
+    starts[0:1] = 0
+    starts[1:] = ends[:-1] + 1
+    lens = ends - starts + 1
+    values = np.zeros(len(ends), dtype=np.uint64)
+    for j in range(int(lens.max(initial=0))):
+        m = lens > j
+        values[m] |= (b[starts[m] + j] & 0x7F).astype(np.uint64) << np.uint64(7 * j)
+    return values, ends
+
+
+def _unzigzag(v):
+    v = v.astype(np.int64)
+    return (v >> 1) ^ -(v & 1)
+
+
+def decode_imu_records(b):
+    """Registros a partir de b (uint8, sem cabecalho; comeca num keyframe).
+
+    Retorna (rows int64 Nx7, offset do registro de fim em b ou None).
+    """
+    v, ends = _varints(b)
+    odd = (v & 1).astype(bool)
+    n = len(v)
+
+    # Inicio dos segmentos (keyframe + deltas): um keyframe ocupa 7 varints e
+    # um delta 6; o proximo keyframe e o primeiro inicio de registro impar
+    seg_start, seg_deltas = [], []
+    end_offset = None
+    r = 0
+    while r + COLUMNS <= n:
+        if v[r] == imu_decode.END_MARK:
+            end_offset = int(ends[r]) + 1
+            break
+        if not odd[r]:
+            raise ValueError(f'registro delta antes do primeiro keyframe (varint {r})')
+        q = r + COLUMNS
+        deltas = 0
+        while True:
+            window = odd[q:q + 6 * _KEY_SEARCH:6]
+            hit = int(np.argmax(window)) if len(window) else 0
+            if len(window) and window[hit]:
+                deltas += hit
+                q += 6 * hit
+                break
+            deltas += len(window)
+            q += 6 * len(window)
+            if q + 6 > n:
+                break
+        # Delta incompleto no fim dos dados: descartado
+        while deltas and r + COLUMNS + 6 * deltas > n:
+            deltas -= 1
+        seg_start.append(r)
+        seg_deltas.append(deltas)
+        r = r + COLUMNS + 6 * deltas
+        if q + 6 > n and not (q < n and odd[q]):
+            break
+
+    if not seg_start:
+        return np.empty((0, COLUMNS), dtype=np.int64), end_offset
+    seg_start = np.array(seg_start)
+    seg_deltas = np.array(seg_deltas)
+    counts = seg_deltas + 1
+    total = int(counts.sum())
+
+    # Posicao do primeiro varint de cada registro
+    row_seg = np.repeat(np.arange(len(seg_start)), counts)
+    first_row = np.cumsum(counts) - counts
+    k = np.arange(total) - first_row[row_seg]          # 0 = keyframe
+    pos = seg_start[row_seg] + np.where(k == 0, 0, COLUMNS + 6 * (k - 1))
+    is_key = k == 0
+
+    # Amostra: absoluta no keyframe, +1 por delta. Canais: absolutos no
+    # keyframe, deltas depois. Soma acumulada por segmento (cumsum global
+    # menos o acumulado antes do keyframe)
+    x = np.empty((total, COLUMNS), dtype=np.int64)
+    first = v[pos]
+    x[:, 0] = np.where(is_key, (first >> np.uint64(1)).astype(np.int64), 1)
+    x[is_key, 1] = _unzigzag(v[pos[is_key] + 1])
+    x[~is_key, 1] = _unzigzag(first[~is_key] >> np.uint64(1))
+    for c in range(1, imu_decode.CHANNELS):
+        x[:, 1 + c] = _unzigzag(v[pos + c + is_key])
+    acc = np.cumsum(x, axis=0)
+    base = np.zeros((len(seg_start), COLUMNS), dtype=np.int64)
+    base[1:] = acc[first_row[1:] - 1]
+    rows = acc - base[row_seg]
+    rows[:, 1:] = (rows[:, 1:] + 0x8000) % 0x10000 - 0x8000
+    return rows, end_offset
+
+
+def _trailer_text(b, end_offset):
+    if end_offset is None or end_offset + 2 > len(b):
+        return ''
+    n = struct.unpack_from('<H', b, end_offset)[0]
+    return bytes(b[end_offset + 2:end_offset + 2 + n]).decode('ascii', errors='replace')
+
+
+def _load_imu_bytes(data):
+    b = np.frombuffer(data, dtype=np.uint8)
+    pos, text = 0, ''
+    if bytes(b[:4]) == imu_decode.MAGIC:
+        _, pos, text = imu_decode.read_header(bytes(b[:imu_decode.HEADER_SIZE + 65536]))
+    rows, end = decode_imu_records(b[pos:])
+    return rows, text + _trailer_text(b[pos:], end)
+
+
+def load_imu(file_name):
+    with open(file_name, 'rb') as f:
+        if os.fstat(f.fileno()).st_size == 0:
+            return np.empty((0, COLUMNS), dtype=np.int64), {}
+        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            rows, text = _load_imu_bytes(mm)
+    return rows, log_meta.parse(text)
+
+
+# --- .csv ---
+
+def _csv_rows(content, header=True):
+    """Amostras de um CSV, sem a linha de colunas e as linhas '#'. Uma linha
+    incompleta no fim (cartao removido durante a gravacao) e descartada."""
+    end = content.rfind(b'\n') + 1
+    if end < len(content):
+        print(f'aviso: linha incompleta no fim dos dados (byte {end}) descartada', file=sys.stderr)
+    source = io.BytesIO(content[:end])
+    skip = 1 if header else 0
+    if end == 0 or (header and content.find(b'\n', 0, end) == end - 1):
+        return np.empty((0, COLUMNS), dtype=np.int64)
+    if _pd is not None:
+        frame = _pd.read_csv(source, comment='#', header=None, skiprows=skip,
+                             dtype=np.int64, engine='c')
+        return frame.to_numpy().reshape(-1, COLUMNS)
+    return np.loadtxt(source, delimiter=',', skiprows=skip, dtype=np.int64,
+                      ndmin=2).reshape(-1, COLUMNS)
+
+
+def _csv_meta_text(content, edge=4096):
+    """Linhas '#' do inicio e do fim do CSV (cabecalho e trailer)."""
+    head = content[:edge]
+    tail = content[max(len(content) - edge, len(head)):]
+    # A linha cortada no inicio do trecho final nao e usada
+    lines = head.split(b'\n') + (tail.split(b'\n')[1:] if tail else [])
+    return '\n'.join(ln.decode('ascii', errors='replace') for ln in lines if ln.startswith(b'#'))
+
+
+def load_csv(file_name):
+    with open(file_name, 'rb') as f:
+        content = f.read()
+    return _csv_rows(content), log_meta.parse(_csv_meta_text(content))
+
+
+# --- .lzb ---
+
+def _lz4_decompress(payload, raw_len):
+    try:
+        return _lz4.decompress(payload, uncompressed_size=raw_len)
+    except Exception as e:  # LZ4BlockError: mesmo tratamento do lz_decompress
+        raise ValueError(str(e))
+
+
+def _decompress_blocks(data):
+    """Blocos validos e erros [(offset, mensagem)], como em block_decode."""
+    blocks, errors = [], []
+    decompress = _lz4_decompress if _lz4 is not None else None
+    for b in block_decode.read_blocks(data, decompress):
+        if b.err:
+            errors.append((b.offset, b.err))
+        else:
+            blocks.append(b)
+    return blocks, errors
+
+
+def load_lzb(file_name):
+    with open(file_name, 'rb') as f:
+        if os.fstat(f.fileno()).st_size == 0:
+            return np.empty((0, COLUMNS), dtype=np.int64), {}
+        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            blocks, errors = _decompress_blocks(mm)
+    content = b''.join(b.raw for b in blocks if b.count is None)
+    first_ok = bool(blocks) and blocks[0].offset == 0
+    # Tipo do conteudo como em block_decode.content_type()
+    if any(b.count is not None for b in blocks):
+        # Colunar: cada bloco ja e um array por canal
+        parts = [block_decode.column_rows(b) for b in blocks]
+        rows = np.vstack([r for r, _ in parts] + [np.empty((0, COLUMNS), dtype=np.int64)])
+        text = ''.join(t for _, t in parts)
+    elif content.startswith(imu_decode.MAGIC) or not (first_ok or content[:1].isdigit()):
+        rows, text = _load_imu_bytes(content)
+    else:
+        rows, text = _csv_rows(content, header=first_ok), _csv_meta_text(content)
+    meta = log_meta.parse(text)
+    if errors:
+        print(f'aviso: {file_name}: {len(errors)} trecho(s) ilegivel(is) descartado(s)',
+              file=sys.stderr)
+        period = log_meta.sample_period_s(meta)
+        for first, end, t0, t1 in block_decode.lost_ranges(rows, blocks, errors, period):
+            last = 'o fim' if end is None else end - 1
+            when = '' if t0 is None else f' ({t0:.3f} s' + (')' if t1 is None else f' a {t1:.3f} s)')
+            print(f'aviso: {file_name}: perdidas as amostras {first} a {last}{when}', file=sys.stderr)
+    return rows, meta
+
+
+# --- Cache ---
+
+def cache_path(file_name):
+    return file_name + '.npz'
+
+
+def _stamp(file_name):
+    st = os.stat(file_name)
+    return np.array([CACHE_VERSION, st.st_size, st.st_mtime_ns], dtype=np.int64)
+
+
+def _read_cache(file_name):
+    try:
+        with np.load(cache_path(file_name)) as z:
+            if np.array_equal(z['stamp'], _stamp(file_name)):
+                return z['rows'], json.loads(str(z['meta']))
+    except (OSError, KeyError, ValueError):
+        pass
+    return None
+
+
+def _write_cache(file_name, rows, meta):
+    try:
+        np.savez(cache_path(file_name), rows=rows.astype(np.int32), stamp=_stamp(file_name),
+                 meta=json.dumps(meta))
+    except OSError:
+        pass  # Pasta sem permissao de escrita: segue sem cache
+
+
+def load(file_name, use_cache=True):
+    """Amostras (float, formato de np.loadtxt() do CSV) e metadados de um log."""
+    cached = _read_cache(file_name) if use_cache else None
+    if cached is not None:
+        rows, meta = cached
+    else:
+        if file_name.endswith('.imu'):
+            rows, meta = load_imu(file_name)
+        elif file_name.endswith('.lzb'):
+            rows, meta = load_lzb(file_name)
+        else:
+            rows, meta = load_csv(file_name)
+        if use_cache:
+            _write_cache(file_name, rows, meta)
+    return rows.astype(float), meta
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Carrega logs do datalogger (com cache .npz)')
+    parser.add_argument('files', nargs='+', help='Arquivos .csv, .imu ou .lzb')
+    parser.add_argument('--no-cache', action='store_true', help='Ignora e nao grava o cache')
+    args = parser.parse_args()
+    for name in args.files:
+        if name.endswith(('.npz', '.idx')):
+            continue  # Cache e indice de outro log (ex.: log_loader.py pasta/*)
+        hit = not args.no_cache and _read_cache(name) is not None
+        t0 = time.perf_counter()
+        rows, meta = load(name, use_cache=not args.no_cache)
+        dt = time.perf_counter() - t0
+        print(f'{name}: {len(rows)} amostras em {dt * 1000:.1f} ms'
+              f'{" (cache)" if hit else ""}, {len(meta)} metadados')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
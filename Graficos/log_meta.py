@@ -0,0 +1,99 @@
+"""Metadados da sessao gravados no log (cabecalho e trailer "# chave=valor").
+
+Formato descrito em lib/log_meta.h. Com eles as amostras brutas do MPU6050
+sao convertidas direto para g e graus/s, e o eixo de tempo sai do intervalo
+de amostragem e da duracao gravada no trailer.
+
+    python log_meta.py log_003.csv      # mostra os metadados (.csv, .imu ou .lzb)
+"""
+
+import sys
+
+import numpy as np
+
+import block_decode
+import imu_decode
+
+
+def parse(text):
+    """Dicionario das linhas '# chave=valor' (numeros convertidos)."""
+    meta = {}
+    for line in text.splitlines():
+        if not line.startswith('#') or '=' not in line:
+            continue
+        key, value = line[1:].strip().split('=', 1)
+        for kind in (int, float):
+            try:
+                value = kind(value)
+                break
+            except ValueError:
+                pass
+        meta[key] = value
+    return meta
+
+
+def load_log(file_name):
+    """Amostras brutas (formato de np.loadtxt() do CSV) e metadados de um log."""
+    if file_name.endswith('.imu'):
+        with open(file_name, 'rb') as f:
+            rows, _, text = imu_decode.decode(f.read())
+        return rows.astype(float), parse(text)
+    if file_name.endswith('.lzb'):
+        blocks, _ = block_decode.decompress_file(file_name)
+        texts = []
+        rows = block_decode.parse_blocks(blocks, meta=texts)
+        return rows, parse(''.join(texts))
+    with open(file_name) as f:
+        text = f.read()
+    rows = np.loadtxt(text.splitlines(), delimiter=',', skiprows=1, ndmin=2)
+    return rows, parse(text)
+
+
+def read_header(file_name):
+    """So os metadados do cabecalho, lendo apenas o inicio do arquivo."""
+    with open(file_name, 'rb') as f:
+        if file_name.endswith('.lzb'):             # Conteudo do primeiro bloco
+            head = block_decode.first_block(f) or b''
+        else:
+            head = f.read(4096)
+    if head.startswith(imu_decode.MAGIC):
+        return parse(imu_decode.read_header(head)[2])
+    return parse(head.decode('ascii', errors='replace'))
+
+
+def to_physical(rows, meta):
+    """Copia de rows com aceleracao em g e velocidade angular em graus/s.
+
+    Retorna None se o log nao traz as sensibilidades (logs antigos)."""
+    if 'accel_lsb_per_g' not in meta or 'gyro_lsb_per_dps' not in meta:
+        return None
+    out = rows.astype(float)
+    out[:, 1:4] /= meta['accel_lsb_per_g']
+    out[:, 4:7] /= meta['gyro_lsb_per_dps']
+    return out
+
+
+def sample_period_s(meta):
+    """Intervalo medio entre amostras: pelo trailer (medido) ou pelo nominal."""
+    if meta.get('samples', 0) > 1 and 'duration_ms' in meta:
+        return meta['duration_ms'] / 1000.0 / meta['samples']
+    if 'period_ms' in meta:
+        return meta['period_ms'] / 1000.0
+    return None
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+    rows, meta = load_log(sys.argv[1])
+    for key, value in meta.items():
+        print(f'{key:>22} = {value}')
+    print(f'{len(rows)} amostras')
+    if meta.get('samples') not in (None, len(rows)):
+        print(f'aviso: trailer indica {meta["samples"]} amostras')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
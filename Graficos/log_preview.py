@@ -0,0 +1,85 @@
+"""Leitura da previa .pvw (min/max/media em varias resolucoes) gravada junto com o log.
+
+Formato descrito em lib/log_preview.h. A previa de uma sessao inteira ocupa
+poucos KB por hora de gravacao, entao plot_imu.py desenha a visao geral sem
+abrir o log e so le amostras brutas (pelo indice .idx) depois do zoom.
+
+    python log_preview.py log_003.csv        # resumo dos niveis
+"""
+
+import os
+import struct
+import sys
+
+import numpy as np
+
+MAGIC = b'PVW1'
+HEADER_SIZE = 16
+CHANNELS = 6
+ENTRY = np.dtype([('level', 'u1'), ('reserved', 'u1'), ('count', '<u2'),
+                  ('sample', '<u4'), ('time_ms', '<u4'),
+                  ('min', '<i2', CHANNELS), ('max', '<i2', CHANNELS),
+                  ('mean', '<i2', CHANNELS)])
+
+
+def preview_path(data_file):
+    return os.path.splitext(data_file)[0] + '.pvw'
+
+
+def read_preview(pvw_file):
+    """Retorna (fator entre niveis, {nivel: entradas}) com as entradas de cada
+    nivel num array estruturado, em ordem de tempo. O nivel n agrega fator**n
+    amostras por entrada (a ultima de cada nivel pode ter menos)."""
+    with open(pvw_file, 'rb') as f:
+        data = f.read()
+    if data[:4] != MAGIC:
+        raise ValueError(f'{pvw_file}: previa invalida')
+    levels, channels, factor, entry_size = struct.unpack_from('<BBHH', data, 4)
+    if channels != CHANNELS or entry_size != ENTRY.itemsize:
+        raise ValueError(f'{pvw_file}: {channels} canais / entrada de {entry_size} B nao suportados')
+    # Um arquivo cortado (cartao removido) perde so a entrada incompleta
+    n = (len(data) - HEADER_SIZE) // ENTRY.itemsize
+    entries = np.frombuffer(data, dtype=ENTRY, count=n, offset=HEADER_SIZE)
+    return factor, {lv: entries[entries['level'] == lv] for lv in range(1, levels + 1)}
+
+
+def pick_level(levels, start_s, end_s, max_points):
+    """Nivel mais detalhado com no maximo max_points entradas em [start_s, end_s)
+    (o mais grosso, se nenhum couber). Retorna (nivel, entradas na janela)."""
+    best = None
+    for lv in sorted(levels, reverse=True):
+        e = levels[lv]
+        t = e['time_ms'] / 1000.0
+        lo, hi = np.searchsorted(t, start_s, side='right') - 1, np.searchsorted(t, end_s)
+        window = e[max(lo, 0):hi + 1]
+        if best is None or len(window) <= max_points:
+            best = (lv, window)
+        else:
+            break
+    return best
+
+
+def as_rows(entries, field):
+    """Campo 'min', 'max' ou 'mean' no formato de np.loadtxt() do CSV (coluna 0
+    = primeira amostra de cada entrada), para log_meta.to_physical()."""
+    rows = np.empty((len(entries), 1 + CHANNELS))
+    rows[:, 0] = entries['sample']
+    rows[:, 1:] = entries[field]
+    return rows
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+    factor, levels = read_preview(preview_path(sys.argv[1]))
+    print(f'{os.path.basename(sys.argv[1])}: previa com {len(levels)} niveis (fator {factor})')
+    for lv, e in levels.items():
+        span = e['time_ms'][-1] / 1000.0 if len(e) else 0
+        print(f'  1:{factor ** lv:<5} {len(e):>8} entradas, {int(e["count"].sum())} amostras, '
+              f'ate {span:.1f} s')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
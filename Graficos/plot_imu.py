@@ -1,16 +1,46 @@
+import os
+import sys
+
 import numpy as np
 import matplotlib.pyplot as plt
 
-# Nome do arquivo de dados gerado pelo Pico
+import log_index
+import log_loader
+import log_meta
+import log_preview
+
+# Nome do arquivo de dados gerado pelo Pico (.csv, .imu ou .lzb)
 # Certifique-se de que este arquivo esteja na mesma pasta do script Python
-file_name = 'log_001.csv'
+# Também pode ser passado na linha de comando: python plot_imu.py log_002.imu
+file_name = sys.argv[1] if len(sys.argv) > 1 else 'log_001.csv'
+
+# Janela opcional em segundos: python plot_imu.py log_003.csv 2520 10
+# Com o índice (.idx) gravado junto com o log, só esse trecho é lido
+window = (float(sys.argv[2]), float(sys.argv[3])) if len(sys.argv) > 3 else None
+
+# Visão geral pela prévia (.pvw, min/max/média a cada 16/256/4096 amostras):
+# sem janela na linha de comando, o log só é lido quando o zoom mostra no
+# máximo RAW_POINTS amostras
+RAW_POINTS = 20000
+PREVIEW_POINTS = 2000
+pvw_file = log_preview.preview_path(file_name)
+preview = None
 
-# Carregar os dados do arquivo CSV
-# np.loadtxt é usado para carregar dados de um arquivo de texto
-# delimiter=',' especifica que os valores são separados por vírgulas
-# skiprows=1 ignora a primeira linha, que é o cabeçalho
+# Carregar os dados do arquivo
+# log_loader.py lê .csv, .imu e .lzb (mmap + numpy) e guarda o resultado em
+# <log>.npz: abrir de novo o mesmo log é quase imediato. Os metadados do
+# cabeçalho/trailer são interpretados por log_meta.py
+t = None
+data = None
 try:
-    data = np.loadtxt(file_name, delimiter=',', skiprows=1)
+    if not window and os.path.exists(pvw_file):
+        _, preview = log_preview.read_preview(pvw_file)
+        meta = log_meta.read_header(file_name)
+    elif window and os.path.exists(log_index.index_path(file_name)):
+        data, t = log_index.read_window(file_name, *window)
+        meta = log_meta.read_header(file_name)
+    else:
+        data, meta = log_loader.load(file_name)
 except FileNotFoundError:
     print(f"Erro: O arquivo '{file_name}' não foi encontrado.")
     print("Certifique-se de que o arquivo está na mesma pasta do script Python.")
@@ -19,69 +49,124 @@ except Exception as e:
     print(f"Ocorreu um erro ao carregar o arquivo: {e}")
     exit()
 
-# Extrair as colunas para variáveis separadas
-# data[:, 0] pega todas as linhas da primeira coluna (índice 0)
-# e assim por diante para as outras colunas
-sample = data[:, 0]
-accel_x = data[:, 1]
-accel_y = data[:, 2]
-accel_z = data[:, 3]
-gyro_x = data[:, 4]
-gyro_y = data[:, 5]
-gyro_z = data[:, 6]
-
-# --- Gerar gráficos individuais para cada variável ---
-
-# Aceleração no eixo X
-plt.figure(figsize=(10, 6)) # Define o tamanho da figura
-plt.plot(sample, accel_x, 'b-') # 'b-' para linha azul contínua
-plt.title('Aceleração no Eixo X (AccelX)')
-plt.xlabel('Amostra')
-plt.ylabel('Aceleração (unidades brutas)')
-plt.grid(True)
-
-# Aceleração no eixo Y
-plt.figure(figsize=(10, 6))
-plt.plot(sample, accel_y, 'g-') # 'g-' para linha verde contínua
-plt.title('Aceleração no Eixo Y (AccelY)')
-plt.xlabel('Amostra')
-plt.ylabel('Aceleração (unidades brutas)')
-plt.grid(True)
-
-# Aceleração no eixo Z
-plt.figure(figsize=(10, 6))
-plt.plot(sample, accel_z, 'r-') # 'r-' para linha vermelha contínua
-plt.title('Aceleração no Eixo Z (AccelZ)')
-plt.xlabel('Amostra')
-plt.ylabel('Aceleração (unidades brutas)')
-plt.grid(True)
-
-# Giroscópio no eixo X
-plt.figure(figsize=(10, 6))
-plt.plot(sample, gyro_x, 'c-') # 'c-' para linha ciano contínua
-plt.title('Giroscópio no Eixo X (GyroX)')
-plt.xlabel('Amostra')
-plt.ylabel('Velocidade Angular (unidades brutas)')
-plt.grid(True)
-
-# Giroscópio no eixo Y
-plt.figure(figsize=(10, 6))
-plt.plot(sample, gyro_y, 'm-') # 'm-' para linha magenta contínua
-plt.title('Giroscópio no Eixo Y (GyroY)')
-plt.xlabel('Amostra')
-plt.ylabel('Velocidade Angular (unidades brutas)')
-plt.grid(True)
-
-# Giroscópio no eixo Z
-plt.figure(figsize=(10, 6))
-plt.plot(sample, gyro_z, 'y-') # 'y-' para linha amarela contínua
-plt.title('Giroscópio no Eixo Z (GyroZ)')
-plt.xlabel('Amostra')
-plt.ylabel('Velocidade Angular (unidades brutas)')
-plt.grid(True)
+# Logs com metadados trazem o fundo de escala: converte para g e °/s.
+# Logs antigos (sem cabeçalho) ficam em unidades brutas
+def to_units(rows):
+    physical = log_meta.to_physical(rows, meta)
+    return physical if physical is not None else rows
+
+
+if log_meta.to_physical(np.zeros((0, 7)), meta) is not None:
+    accel_label = 'Aceleração (g)'
+    gyro_label = 'Velocidade Angular (°/s)'
+else:
+    accel_label = 'Aceleração (unidades brutas)'
+    gyro_label = 'Velocidade Angular (unidades brutas)'
+
+# Eixo de tempo: pelo índice ou pelo intervalo de amostragem do cabeçalho
+period = log_meta.sample_period_s(meta)
+if data is not None:
+    data = to_units(data)
+    if t is None and period:
+        t = data[:, 0] * period
+        if window:
+            keep = (t >= window[0]) & (t < window[0] + window[1])
+            data, t = data[keep], t[keep]
+
+# --- Uma figura com os seis gráficos ---
+# Coluna da esquerda: aceleração X/Y/Z; da direita: giroscópio X/Y/Z.
+# sharex=True faz o zoom/deslocamento em um gráfico valer para todos
+fig, axes = plt.subplots(3, 2, sharex=True, figsize=(14, 9))
+fig.suptitle(os.path.basename(file_name))
+plots = [
+    # (coluna em data, linha, coluna do gráfico, título, estilo, rótulo y)
+    (1, 0, 0, 'Aceleração no Eixo X (AccelX)', 'b-', accel_label),  # azul
+    (2, 1, 0, 'Aceleração no Eixo Y (AccelY)', 'g-', accel_label),  # verde
+    (3, 2, 0, 'Aceleração no Eixo Z (AccelZ)', 'r-', accel_label),  # vermelho
+    (4, 0, 1, 'Giroscópio no Eixo X (GyroX)', 'c-', gyro_label),    # ciano
+    (5, 1, 1, 'Giroscópio no Eixo Y (GyroY)', 'm-', gyro_label),    # magenta
+    (6, 2, 1, 'Giroscópio no Eixo Z (GyroZ)', 'y-', gyro_label),    # amarelo
+]
+for column, row, col, title, style, y_label in plots:
+    ax = axes[row, col]
+    ax.set_title(title)
+    ax.set_ylabel(y_label)
+    ax.grid(True)
+
+if preview is None:
+    # Log inteiro (ou a janela pedida) já carregado
+    x, x_label = (t, 'Tempo (s)') if t is not None else (data[:, 0], 'Amostra')
+    for column, row, col, title, style, y_label in plots:
+        axes[row, col].plot(x, data[:, column], style, linewidth=0.8)
+else:
+    x_label = 'Tempo (s)'
+    artists = []
+    shown = [None]
+    full_log = []  # Log inteiro, só se não houver índice para ler a janela
+
+    def raw_window(t0, t1):
+        """Amostras brutas com tempo em [t0, t1), pelo índice se houver."""
+        if os.path.exists(log_index.index_path(file_name)):
+            return log_index.read_window(file_name, t0, t1 - t0)
+        if not full_log:
+            full_log.append(log_loader.load(file_name)[0])
+        rows = full_log[0]
+        t_rows = rows[:, 0] * period
+        keep = (t_rows >= t0) & (t_rows < t1)
+        return rows[keep], t_rows[keep]
+
+    def draw(t0, t1):
+        """Redesenha os gráficos para o intervalo [t0, t1) em segundos: amostras
+        brutas se couberem, senão o nível da prévia com até PREVIEW_POINTS
+        entradas (faixa min-max e a média)."""
+        for artist in artists:
+            artist.remove()
+        artists.clear()
+        if period and (t1 - t0) / period <= RAW_POINTS:
+            rows, t_raw = raw_window(max(t0, 0), t1)
+            rows = to_units(rows)
+            for column, row, col, title, style, y_label in plots:
+                artists.extend(axes[row, col].plot(t_raw, rows[:, column], style, linewidth=0.8))
+            lo = hi = rows
+        else:
+            level, entries = log_preview.pick_level(preview, t0, t1, PREVIEW_POINTS)
+            t_pv = entries['time_ms'] / 1000.0
+            lo = to_units(log_preview.as_rows(entries, 'min'))
+            hi = to_units(log_preview.as_rows(entries, 'max'))
+            mean = to_units(log_preview.as_rows(entries, 'mean'))
+            for column, row, col, title, style, y_label in plots:
+                ax = axes[row, col]
+                artists.append(ax.fill_between(t_pv, lo[:, column], hi[:, column], step='post',
+                                               color=style[0], alpha=0.3, linewidth=0))
+                artists.extend(ax.plot(t_pv, mean[:, column], style, linewidth=0.8,
+                                       drawstyle='steps-post'))
+        # Escala y pelo que está visível (fill_between não entra no autoscale)
+        for column, row, col, title, style, y_label in plots:
+            if len(lo):
+                y0, y1 = lo[:, column].min(), hi[:, column].max()
+                margin = (y1 - y0) * 0.05 or 1
+                axes[row, col].set_ylim(y0 - margin, y1 + margin)
+        shown[0] = (t0, t1)
+
+    def on_xlim_changed(ax):
+        t0, t1 = ax.get_xlim()
+        if shown[0] != (t0, t1):
+            draw(t0, t1)
+            fig.canvas.draw_idle()
+
+    # Visão geral: a sessão inteira, do início ao fim da prévia
+    end_s = max(float(e['time_ms'][-1]) / 1000.0 for e in preview.values() if len(e))
+    end_s += period * 16 if period else 0
+    draw(0.0, end_s)
+    axes[0, 0].set_xlim(0.0, end_s)
+    shown[0] = axes[0, 0].get_xlim()
+    axes[0, 0].callbacks.connect('xlim_changed', on_xlim_changed)
+
+for ax in axes[-1]:
+    ax.set_xlabel(x_label)
 
 # Ajustar o layout para evitar sobreposição de títulos/rótulos
 plt.tight_layout()
 
-# Mostrar todos os gráficos
+# Mostrar os gráficos
 plt.show()
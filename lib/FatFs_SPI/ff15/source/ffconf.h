@@ -4,6 +4,10 @@
 
 #define FFCONF_DEF	80286	/* Revision ID */
 
+/* Options guarded by #ifndef below can be overridden from the build system.
+/  DATALOGGER_PROFILE in the top-level CMakeLists.txt sets them together
+/  (lean-logger or full). */
+
 /*---------------------------------------------------------------------------/
 / Function Configurations
 /---------------------------------------------------------------------------*/
@@ -113,8 +117,12 @@
 */
 
 
+#ifndef FF_USE_LFN
 #define FF_USE_LFN		3
+#endif
+#ifndef FF_MAX_LFN
 #define FF_MAX_LFN		255
+#endif
 /* The FF_USE_LFN switches the support for LFN (long file name).
 /
 /   0: Disable LFN. FF_MAX_LFN has no effect.
@@ -203,7 +211,9 @@
 /  GET_SECTOR_SIZE command. */
 
 
+#ifndef FF_LBA64
 #define FF_LBA64		1
+#endif
 /* This option switches support for 64-bit LBA. (0:Disable or 1:Enable)
 /  To enable the 64-bit LBA, also exFAT needs to be enabled. (FF_FS_EXFAT == 1) */
 
@@ -213,10 +223,12 @@
 /  f_fdisk function. 0x100000000 max. This option has no effect when FF_LBA64 == 0. */
 
 
-#define FF_USE_TRIM		0
+#ifndef FF_USE_TRIM
+#define FF_USE_TRIM		1
+#endif
 /* This option switches support for ATA-TRIM. (0:Disable or 1:Enable)
 /  To enable Trim function, also CTRL_TRIM command should be implemented to the
-/  disk_ioctl() function. */
+/  disk_ioctl() function. (Implemented in glue.c with SD ERASE.) */
 
 
 
@@ -224,14 +236,18 @@
 / System Configurations
 /---------------------------------------------------------------------------*/
 
+#ifndef FF_FS_TINY
 #define FF_FS_TINY		0
+#endif
 /* This option switches tiny buffer configuration. (0:Normal or 1:Tiny)
 /  At the tiny configuration, size of file object (FIL) is shrinked FF_MAX_SS bytes.
 /  Instead of private sector buffer eliminated from the file object, common sector
 /  buffer in the filesystem object (FATFS) is used for the file data transfer. */
 
 
+#ifndef FF_FS_EXFAT
 #define FF_FS_EXFAT		1
+#endif
 /* This option switches support for exFAT filesystem. (0:Disable or 1:Enable)
 /  To enable exFAT, also LFN needs to be enabled. (FF_USE_LFN >= 1)
 /  Note that enabling exFAT discards ANSI C (C89) compatibility. */
@@ -263,7 +279,9 @@
 */
 
 
+#ifndef FF_FS_LOCK
 #define FF_FS_LOCK		16
+#endif
 /* The option FF_FS_LOCK switches file lock function to control duplicated file open
 /  and illegal operation to open objects. This option must be 0 when FF_FS_READONLY
 /  is 1.
@@ -12,13 +12,24 @@
 /*------------------------------------------------------------------------*/
 
 #include <stdlib.h>		/* with POSIX API */
+#include "mem_pool.h"
+
+/* LFN working buffers come from a static pool sized for this configuration
+/  (see INIT_NAMBUF in ff.c). Larger requests (directory table clear, f_mkfs
+/  work area) and requests beyond FF_LFNBUF_BLOCKS fall back to the heap. */
+#define FF_LFNBUF_SIZE	((FF_MAX_LFN + 1) * 2 + (FF_FS_EXFAT ? (FF_MAX_LFN + 44U) / 15 * 32 : 0))
+#ifndef FF_LFNBUF_BLOCKS
+#define FF_LFNBUF_BLOCKS	1
+#endif
+
+MEM_POOL_DEFINE(ff_lfn_pool, "FatFs LFN", FF_LFNBUF_SIZE, FF_LFNBUF_BLOCKS, MEM_POOL_FALLBACK_HEAP);
 
 
 void* ff_memalloc (	/* Returns pointer to the allocated memory block (null if not enough core) */
 	UINT msize		/* Number of bytes to allocate */
 )
 {
-	return malloc((size_t)msize);	/* Allocate a new memory block */
+	return mem_pool_alloc(&ff_lfn_pool, (size_t)msize);	/* Allocate a new memory block */
 }
 
 
@@ -26,7 +37,7 @@ void ff_memfree (
 	void* mblock	/* Pointer to the memory block to free (no effect if null) */
 )
 {
-	free(mblock);	/* Free the memory block */
+	mem_pool_free(&ff_lfn_pool, mblock);	/* Free the memory block */
 }
 
 #endif
@@ -22,9 +22,19 @@ specific language governing permissions and limitations under the License.
 #include "my_debug.h"
 
 #define BaseType_t int
-#define FF_FILE FIL
 
-#define ff_rewind f_rewind
+// Size of the user-space buffer embedded in each FF_FILE stream. Small
+// ff_fputc/ff_fgetc/ff_fgets/ff_fwrite/ff_fread calls are served from this
+// buffer instead of going through f_write/f_read one call at a time.
+#ifndef FF_STDIO_BUFFER_SIZE
+#define FF_STDIO_BUFFER_SIZE 256
+#endif
+
+// Number of streams served from the static FF_FILE pool (see mem_pool.h)
+#ifndef FF_STDIO_MAX_STREAMS
+#define FF_STDIO_MAX_STREAMS 2
+#endif
+
 #define pvPortMalloc malloc
 #define vPortFree free
 #define ffconfigMAX_FILENAME 250
@@ -37,8 +47,20 @@ specific language governing permissions and limitations under the License.
 #define FF_SEEK_END 2
 #define pdFALSE 0
 #define pdTRUE 1
-#define ff_filelength f_size
-#define ff_feof f_eof
+
+// Buffered stream: stdio-like, one buffer shared by reads and writes.
+// Switching direction, seeking, truncating and closing flush the buffer.
+typedef struct {
+    FIL fil;
+    UINT buf_pos;   // Write: bytes pending. Read: next byte to hand out.
+    UINT buf_len;   // Read: valid bytes in buf.
+    BYTE buf_mode;  // FF_BUF_IDLE, FF_BUF_READ or FF_BUF_WRITE
+    BYTE buf[FF_STDIO_BUFFER_SIZE];
+} FF_FILE;
+
+#define FF_BUF_IDLE 0
+#define FF_BUF_READ 1
+#define FF_BUF_WRITE 2
 
 typedef struct FF_STAT {
     uint32_t st_size; /* Size of the object in number of bytes. */
@@ -75,3 +97,7 @@ FF_FILE *ff_truncate( const char * pcFileName, long lTruncateSize );
 int ff_seteof( FF_FILE *pxStream );
 int ff_rename( const char *pcOldName, const char *pcNewName, int bDeleteIfExists );
 char *ff_fgets(char *pcBuffer, size_t xCount, FF_FILE *pxStream);
+int ff_fflush(FF_FILE *pxStream);
+int ff_rewind(FF_FILE *pxStream);
+int ff_feof(FF_FILE *pxStream);
+size_t ff_filelength(FF_FILE *pxStream);
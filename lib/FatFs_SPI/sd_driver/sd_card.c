@@ -1024,6 +1024,53 @@ int sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
     return status;
 }
 
+/**
+ * @brief Erase (discard) a contiguous range of blocks
+ *
+ *  Tells the card's flash translation layer that the blocks no longer hold
+ *  live data. After the erase the blocks read back as all 0s or all 1s,
+ *  depending on the card (DATA_STAT_AFTER_ERASE in the SCR).
+ *
+ *  @param  ulSectorNumber  First block of the range
+ *  @param  blockCnt        Number of blocks to erase
+ *  @return         SD_BLOCK_DEVICE_ERROR_NONE(0) - success
+ *                  SD_BLOCK_DEVICE_ERROR_PARAMETER - invalid parameter
+ *                  SD_BLOCK_DEVICE_ERROR_ERASE - erase error
+ *                  SD_BLOCK_DEVICE_ERROR_NO_RESPONSE - no response from card
+ */
+static int in_sd_erase_blocks(sd_card_t *pSD, uint64_t ulSectorNumber,
+                              uint32_t blockCnt) {
+    if (!blockCnt) return SD_BLOCK_DEVICE_ERROR_NONE;
+    if (ulSectorNumber + blockCnt > pSD->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (pSD->m_Status & (STA_NOINIT | STA_NODISK))
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+
+    int status = SD_BLOCK_DEVICE_ERROR_NONE;
+    while (blockCnt && SD_BLOCK_DEVICE_ERROR_NONE == status) {
+        sd_erase_chunk_t c = sd_erase_chunk(SDCARD_V2HC == pSD->card_type, ulSectorNumber, blockCnt);
+        status = sd_cmd(pSD, CMD32_ERASE_WR_BLK_START_ADDR, c.start_addr, false, 0);
+        if (SD_BLOCK_DEVICE_ERROR_NONE == status)
+            status = sd_cmd(pSD, CMD33_ERASE_WR_BLK_END_ADDR, c.end_addr, false, 0);
+        if (SD_BLOCK_DEVICE_ERROR_NONE == status)
+            status = sd_cmd(pSD, CMD38_ERASE, 0, false, 0);  // R1b: waits for busy
+        if (SD_BLOCK_DEVICE_ERROR_NONE != status)
+            DBG_PRINTF("Erase of %" PRIu32 " blocks at 0x%llx failed: %d\r\n", c.blocks,
+                       ulSectorNumber, status);
+        ulSectorNumber += c.blocks;
+        blockCnt -= c.blocks;
+    }
+    return status;
+}
+
+int sd_erase_blocks(sd_card_t *pSD, uint64_t ulSectorNumber, uint32_t blockCnt) {
+    sd_acquire(pSD);
+    TRACE_PRINTF("sd_erase_blocks(0x%llx, 0x%lx)\r\n", ulSectorNumber, blockCnt);
+    int status = in_sd_erase_blocks(pSD, ulSectorNumber, blockCnt);
+    sd_release(pSD);
+    return status;
+}
+
 static int sd_init_medium(sd_card_t *pSD) {
     int32_t status = SD_BLOCK_DEVICE_ERROR_NONE;
     uint32_t response, arg;
@@ -1137,6 +1184,7 @@ static void sd_ctor(sd_card_t *pSD) {
     pSD->init = sd_init;
     pSD->write_blocks = sd_write_blocks;
     pSD->read_blocks = sd_read_blocks;
+    pSD->erase_blocks = sd_erase_blocks;
     pSD->sd_test_com = sd_test_com;
 }
 bool sd_init_driver() {
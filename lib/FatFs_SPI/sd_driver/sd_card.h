@@ -60,6 +60,9 @@ struct sd_card_t {
                     uint64_t ulSectorNumber, uint32_t blockCnt);
     int (*read_blocks)(sd_card_t *sd_card_p, uint8_t *buffer, uint64_t ulSectorNumber,
                     uint32_t ulSectorCount);
+    // Discards blockCnt blocks starting at ulSectorNumber (CMD32/CMD33/CMD38)
+    int (*erase_blocks)(sd_card_t *sd_card_p, uint64_t ulSectorNumber,
+                    uint32_t blockCnt);
 
     // Useful when use_card_detect is false - call periodically to check for presence of SD card
     // Returns true if and only if SD card was sensed on the bus
@@ -87,6 +90,41 @@ struct sd_card_t {
 //    STA_PROTECT = 0x04 /* Write protected */
 //};
 
+/* Largest range handed to a single CMD32/CMD33/CMD38 sequence. The card holds
+ * the bus busy (R1b) until the erase completes, and sd_wait_ready() gives up
+ * after SD_COMMAND_TIMEOUT, so long ranges are split into several erases. */
+#ifndef SD_ERASE_MAX_BLOCKS
+#define SD_ERASE_MAX_BLOCKS 8192  // 4 MiB
+#endif
+
+// Arguments of one CMD32/CMD33 pair of an erase
+typedef struct {
+    uint32_t start_addr;  // CMD32_ERASE_WR_BLK_START_ADDR argument
+    uint32_t end_addr;    // CMD33_ERASE_WR_BLK_END_ADDR argument (inclusive)
+    uint32_t blocks;      // Blocks covered by this pair
+} sd_erase_chunk_t;
+
+/**
+ * @brief First chunk of an erase of blockCnt (> 0) blocks at ulSectorNumber
+ *
+ *  SDSC Cards (CCS=0) use byte unit addresses; SDHC and SDXC Cards (CCS=1)
+ *  use block unit addresses (512 Bytes unit). The caller advances
+ *  ulSectorNumber and blockCnt by .blocks until blockCnt is 0.
+ */
+static inline sd_erase_chunk_t sd_erase_chunk(bool block_addressing, uint64_t ulSectorNumber,
+                                              uint32_t blockCnt) {
+    sd_erase_chunk_t c;
+    c.blocks = blockCnt < SD_ERASE_MAX_BLOCKS ? blockCnt : SD_ERASE_MAX_BLOCKS;
+    uint64_t start = ulSectorNumber, end = ulSectorNumber + c.blocks - 1;
+    if (!block_addressing) {
+        start *= 512;
+        end *= 512;
+    }
+    c.start_addr = (uint32_t)start;
+    c.end_addr = (uint32_t)end;
+    return c;
+}
+
 bool sd_card_detect(sd_card_t *pSD);
 uint64_t sd_sectors(sd_card_t *pSD);
 
@@ -23,10 +23,16 @@ specific language governing permissions and limitations under the License.
 //
 #include "f_util.h"
 #include "ff_stdio.h"
+#include "mem_pool.h"
 
 #define TRACE_PRINTF(fmt, args...) {}
 //#define TRACE_PRINTF printf
 
+// Streams come from a static pool instead of the heap; if more than
+// FF_STDIO_MAX_STREAMS are open at once the extra ones fall back to malloc.
+MEM_POOL_DEFINE(ff_file_pool, "FF_FILE", sizeof(FF_FILE), FF_STDIO_MAX_STREAMS,
+                MEM_POOL_FALLBACK_HEAP);
+
 static BYTE posix2mode(const char *pcMode) {
     if (0 == strcmp("r", pcMode)) return FA_READ;
     if (0 == strcmp("r+", pcMode)) return FA_READ | FA_WRITE;
@@ -86,6 +92,59 @@ int fresult2errno(FRESULT fr) {
     }
 }
 
+static void stream_init(FF_FILE *pxStream) {
+    pxStream->buf_pos = 0;
+    pxStream->buf_len = 0;
+    pxStream->buf_mode = FF_BUF_IDLE;
+}
+
+// Write out whatever is pending in the write buffer.
+static FRESULT stream_flush_write(FF_FILE *pxStream) {
+    FRESULT fr = FR_OK;
+    if (FF_BUF_WRITE == pxStream->buf_mode && pxStream->buf_pos) {
+        UINT bw = 0;
+        fr = f_write(&pxStream->fil, pxStream->buf, pxStream->buf_pos, &bw);
+        if (FR_OK == fr && bw != pxStream->buf_pos) fr = FR_DENIED;  // Disk full
+        if (FR_OK != fr)
+            TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
+    }
+    stream_init(pxStream);
+    return fr;
+}
+
+// Bring the FatFs file pointer back to the logical stream position and empty
+// the buffer: flushes pending writes or gives back read-ahead bytes.
+static FRESULT stream_sync(FF_FILE *pxStream) {
+    if (FF_BUF_WRITE == pxStream->buf_mode)
+        return stream_flush_write(pxStream);
+    FRESULT fr = FR_OK;
+    if (FF_BUF_READ == pxStream->buf_mode &&
+        pxStream->buf_pos != pxStream->buf_len) {
+        fr = f_lseek(&pxStream->fil, f_tell(&pxStream->fil) -
+                                         (pxStream->buf_len - pxStream->buf_pos));
+    }
+    stream_init(pxStream);
+    return fr;
+}
+
+// Refill the read buffer. Returns the number of bytes now available.
+static UINT stream_fill_read(FF_FILE *pxStream) {
+    if (FF_BUF_READ != pxStream->buf_mode) {
+        FRESULT fr = stream_sync(pxStream);
+        errno = fresult2errno(fr);
+        if (FR_OK != fr) return 0;
+    }
+    UINT br = 0;
+    FRESULT fr = f_read(&pxStream->fil, pxStream->buf, sizeof pxStream->buf, &br);
+    if (FR_OK != fr)
+        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
+    errno = fresult2errno(fr);
+    pxStream->buf_pos = 0;
+    pxStream->buf_len = br;
+    pxStream->buf_mode = br ? FF_BUF_READ : FF_BUF_IDLE;
+    return br;
+}
+
 FF_FILE *ff_fopen(const char *pcFile, const char *pcMode) {
     TRACE_PRINTF("%s\n", __func__);
     // FRESULT f_open (FIL* fp, const TCHAR* path, BYTE mode);
@@ -94,16 +153,17 @@ FF_FILE *ff_fopen(const char *pcFile, const char *pcMode) {
     //  const TCHAR* path, /* [IN] File name */
     //  BYTE mode          /* [IN] Mode flags */
     //);
-    FIL *fp = malloc(sizeof(FIL));
+    FF_FILE *fp = mem_pool_alloc(&ff_file_pool, sizeof(FF_FILE));
     if (!fp) {
         errno = ENOMEM;
         return NULL;
     }
-    FRESULT fr = f_open(fp, pcFile, posix2mode(pcMode));
+    stream_init(fp);
+    FRESULT fr = f_open(&fp->fil, pcFile, posix2mode(pcMode));
     errno = fresult2errno(fr);
     if (FR_OK != fr) {
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-        free(fp);
+        mem_pool_free(&ff_file_pool, fp);
         fp = 0;
     }
     return fp;
@@ -113,11 +173,13 @@ int ff_fclose(FF_FILE *pxStream) {
     // FRESULT f_close (
     //  FIL* fp     /* [IN] Pointer to the file object */
     //);
-    FRESULT fr = f_close(pxStream);
+    FRESULT fr = stream_flush_write(pxStream);
+    FRESULT fr2 = f_close(&pxStream->fil);
+    if (FR_OK == fr) fr = fr2;
     if (FR_OK != fr)
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    free(pxStream);
+    mem_pool_free(&ff_file_pool, pxStream);
     if (FR_OK == fr)
         return 0;
     else
@@ -152,8 +214,28 @@ size_t ff_fwrite(const void *pvBuffer, size_t xSize, size_t xItems,
     //  UINT* bw          /* [OUT] Pointer to the variable to return number of
     //  bytes written */
     //);
+    if (!xSize) return 0;
+    UINT btw = xSize * xItems;
     UINT bw = 0;
-    FRESULT fr = f_write(pxStream, pvBuffer, xSize * xItems, &bw);
+    FRESULT fr = FR_OK;
+    if (FF_BUF_WRITE != pxStream->buf_mode) {
+        fr = stream_sync(pxStream);
+        pxStream->buf_mode = FF_BUF_WRITE;
+    }
+    if (FR_OK == fr && pxStream->buf_pos + btw > sizeof pxStream->buf) {
+        fr = stream_flush_write(pxStream);
+        pxStream->buf_mode = FF_BUF_WRITE;
+    }
+    if (FR_OK == fr) {
+        if (btw >= sizeof pxStream->buf) {
+            // Large writes go straight to FatFs (sector-aligned when possible)
+            fr = f_write(&pxStream->fil, pvBuffer, btw, &bw);
+        } else {
+            memcpy(pxStream->buf + pxStream->buf_pos, pvBuffer, btw);
+            pxStream->buf_pos += btw;
+            bw = btw;
+        }
+    }
     if (FR_OK != fr)
         TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
@@ -168,11 +250,33 @@ size_t ff_fread(void *pvBuffer, size_t xSize, size_t xItems,
     //  UINT btr,    /* [IN] Number of bytes to read */
     //  UINT* br     /* [OUT] Number of bytes read */
     //);
+    if (!xSize) return 0;
+    UINT btr = xSize * xItems;
     UINT br = 0;
-    FRESULT fr = f_read(pxStream, pvBuffer, xSize * xItems, &br);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    errno = fresult2errno(fr);
+    BYTE *dst = pvBuffer;
+    errno = 0;
+    while (br < btr) {
+        if (FF_BUF_READ == pxStream->buf_mode &&
+            pxStream->buf_pos < pxStream->buf_len) {
+            UINT n = pxStream->buf_len - pxStream->buf_pos;
+            if (n > btr - br) n = btr - br;
+            memcpy(dst + br, pxStream->buf + pxStream->buf_pos, n);
+            pxStream->buf_pos += n;
+            br += n;
+        } else if (btr - br >= sizeof pxStream->buf) {
+            // Buffer is empty and the rest is large: read it directly
+            FRESULT fr = stream_sync(pxStream);
+            UINT n = 0;
+            if (FR_OK == fr) fr = f_read(&pxStream->fil, dst + br, btr - br, &n);
+            if (FR_OK != fr)
+                TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
+            errno = fresult2errno(fr);
+            br += n;
+            break;
+        } else if (!stream_fill_read(pxStream)) {
+            break;  // End of file or error (errno set)
+        }
+    }
     return br / xSize;
 }
 int ff_chdir(const char *pcDirectoryName) {
@@ -237,21 +341,24 @@ int ff_fputc(int iChar, FF_FILE *pxStream) {
     //  UINT* bw          /* [OUT] Pointer to the variable to return number of
     //  bytes written */
     //);
-    UINT bw = 0;
-    uint8_t buff[1];
-    buff[0] = iChar;
-    FRESULT fr = f_write(pxStream, buff, 1, &bw);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
+    FRESULT fr = FR_OK;
+    if (FF_BUF_WRITE != pxStream->buf_mode) {
+        fr = stream_sync(pxStream);
+        pxStream->buf_mode = FF_BUF_WRITE;
+    } else if (pxStream->buf_pos == sizeof pxStream->buf) {
+        fr = stream_flush_write(pxStream);
+        pxStream->buf_mode = FF_BUF_WRITE;
+    }
     errno = fresult2errno(fr);
     // On success the byte written to the file is returned. If any other value
     // is returned then the byte was not written to the file and the task's
     // errno will be set to indicate the reason.
-    if (1 == bw)
-        return iChar;
-    else {
+    if (FR_OK != fr) {
+        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
         return -1;
     }
+    pxStream->buf[pxStream->buf_pos++] = (BYTE)iChar;
+    return iChar;
 }
 int ff_fgetc(FF_FILE *pxStream) {
     // TRACE_PRINTF("%s(pxStream=%p)\n", __func__, pxStream);
@@ -261,19 +368,16 @@ int ff_fgetc(FF_FILE *pxStream) {
     //  UINT btr,    /* [IN] Number of bytes to read */
     //  UINT* br     /* [OUT] Number of bytes read */
     //);
-    uint8_t buff[1] = {0};
-    UINT br;
-    FRESULT fr = f_read(pxStream, buff, 1, &br);
-    if (FR_OK != fr)
-        TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    errno = fresult2errno(fr);
     // On success the byte read from the file system is returned. If a byte
     // could not be read from the file because the read position is already at
     // the end of the file then FF_EOF is returned.
-    if (1 == br)
-        return buff[0];
-    else
-        return FF_EOF;
+    if (FF_BUF_READ != pxStream->buf_mode ||
+        pxStream->buf_pos == pxStream->buf_len) {
+        if (!stream_fill_read(pxStream)) return FF_EOF;
+    } else {
+        errno = 0;
+    }
+    return pxStream->buf[pxStream->buf_pos++];
 }
 int ff_rmdir(const char *pcDirectory) {
     TRACE_PRINTF("%s\n", __func__);
@@ -304,25 +408,32 @@ long ff_ftell(FF_FILE *pxStream) {
     // FSIZE_t f_tell (
     //  FIL* fp   /* [IN] File object */
     //);
-    FSIZE_t pos = f_tell(pxStream);
+    FSIZE_t pos = f_tell(&pxStream->fil);
+    if (FF_BUF_WRITE == pxStream->buf_mode)
+        pos += pxStream->buf_pos;
+    else if (FF_BUF_READ == pxStream->buf_mode)
+        pos -= pxStream->buf_len - pxStream->buf_pos;
     myASSERT(pos < LONG_MAX);
     return pos;
 }
 int ff_fseek(FF_FILE *pxStream, int iOffset, int iWhence) {
     TRACE_PRINTF("%s\n", __func__);
-    FRESULT fr = -1;
+    FRESULT fr = stream_sync(pxStream);
+    errno = fresult2errno(fr);
+    if (FR_OK != fr) return -1;
+    FIL *fp = &pxStream->fil;
     switch (iWhence) {
         case FF_SEEK_CUR:  // The current file position.
-            if ((int)f_tell(pxStream) + iOffset < 0) return -1;
-            fr = f_lseek(pxStream, f_tell(pxStream) + iOffset);
+            if ((int)f_tell(fp) + iOffset < 0) return -1;
+            fr = f_lseek(fp, f_tell(fp) + iOffset);
             break;
         case FF_SEEK_END:  // The end of the file.
-            if ((int)f_size(pxStream) + iOffset < 0) return -1;
-            fr = f_lseek(pxStream, f_size(pxStream) + iOffset);
+            if ((int)f_size(fp) + iOffset < 0) return -1;
+            fr = f_lseek(fp, f_size(fp) + iOffset);
             break;
         case FF_SEEK_SET:  // The beginning of the file.
             if (iOffset < 0) return -1;
-            fr = f_lseek(pxStream, iOffset);
+            fr = f_lseek(fp, iOffset);
             break;
         default:
             myASSERT(!"Bad iWhence");
@@ -389,43 +500,59 @@ int ff_findnext(FF_FindData_t *pxFindData) {
 }
 FF_FILE *ff_truncate(const char *pcFileName, long lTruncateSize) {
     TRACE_PRINTF("%s\n", __func__);
-    FIL *fp = malloc(sizeof(FIL));
-    if (!fp) {
+    FF_FILE *pxStream = mem_pool_alloc(&ff_file_pool, sizeof(FF_FILE));
+    if (!pxStream) {
         errno = ENOMEM;
         return NULL;
     }
+    stream_init(pxStream);
+    FIL *fp = &pxStream->fil;
     FRESULT fr = f_open(fp, pcFileName, FA_OPEN_APPEND | FA_WRITE);
     if (FR_OK != fr)
         printf("%s: f_open error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
     errno = fresult2errno(fr);
-    if (FR_OK != fr) return NULL;
+    if (FR_OK != fr) {
+        mem_pool_free(&ff_file_pool, pxStream);
+        return NULL;
+    }
+    // Zero-fill up to the requested size, a buffer at a time
+    memset(pxStream->buf, 0, sizeof pxStream->buf);
     while (f_tell(fp) < (FSIZE_t)lTruncateSize) {
         UINT bw = 0;
-        char c = 0;
-        fr = f_write(fp, &c, 1, &bw);
+        UINT btw = sizeof pxStream->buf;
+        if ((FSIZE_t)lTruncateSize - f_tell(fp) < btw)
+            btw = (FSIZE_t)lTruncateSize - f_tell(fp);
+        fr = f_write(fp, pxStream->buf, btw, &bw);
         if (FR_OK != fr)
             TRACE_PRINTF("%s error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
         errno = fresult2errno(fr);
-        if (1 != bw) return NULL;
+        if (btw != bw) {
+            f_close(fp);
+            mem_pool_free(&ff_file_pool, pxStream);
+            return NULL;
+        }
     }
     fr = f_lseek(fp, lTruncateSize);
     errno = fresult2errno(fr);
     if (FR_OK != fr)
         printf("%s: f_lseek error: %s (%d)\n", __func__, FRESULT_str(fr), fr);
-    if (FR_OK != fr) return NULL;
-    fr = f_truncate(fp);
-    if (FR_OK != fr)
-        printf("%s: f_truncate error: %s (%d)\n", __func__, FRESULT_str(fr),
-               fr);
+    if (FR_OK == fr) {
+        fr = f_truncate(fp);
+        if (FR_OK != fr)
+            printf("%s: f_truncate error: %s (%d)\n", __func__, FRESULT_str(fr),
+                   fr);
+    }
     errno = fresult2errno(fr);
     if (FR_OK == fr)
-        return fp;
-    else
-        return NULL;
+        return pxStream;
+    f_close(fp);
+    mem_pool_free(&ff_file_pool, pxStream);
+    return NULL;
 }
 int ff_seteof(FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
-    FRESULT fr = f_truncate(pxStream);
+    FRESULT fr = stream_sync(pxStream);
+    if (FR_OK == fr) fr = f_truncate(&pxStream->fil);
     errno = fresult2errno(fr);
     if (FR_OK == fr)
         return 0;
@@ -451,13 +578,59 @@ int ff_rename(const char *pcOldName, const char *pcNewName,
 }
 char *ff_fgets(char *pcBuffer, size_t xCount, FF_FILE *pxStream) {
     TRACE_PRINTF("%s\n", __func__);
-    TCHAR *p = f_gets(pcBuffer, xCount, pxStream);
+    // Same contract as f_gets(): read up to xCount - 1 bytes, stop after a
+    // '\n', always terminate. Bytes are copied as-is (UTF-8 in, UTF-8 out).
+    size_t n = 0;
+    while (n + 1 < xCount) {
+        if (FF_BUF_READ != pxStream->buf_mode ||
+            pxStream->buf_pos == pxStream->buf_len) {
+            if (!stream_fill_read(pxStream)) break;
+        }
+        // Scan the buffered bytes for the end of line in one go
+        UINT avail = pxStream->buf_len - pxStream->buf_pos;
+        if (avail > xCount - 1 - n) avail = xCount - 1 - n;
+        const BYTE *src = pxStream->buf + pxStream->buf_pos;
+        const BYTE *nl = memchr(src, '\n', avail);
+        UINT take = nl ? (UINT)(nl - src) + 1 : avail;
+        memcpy(pcBuffer + n, src, take);
+        pxStream->buf_pos += take;
+        n += take;
+        if (nl) break;
+    }
+    if (xCount) pcBuffer[n] = 0;
     // On success a pointer to pcBuffer is returned. If there is a read error
     // then NULL is returned and the task's errno is set to indicate the reason.
-    if (p == pcBuffer)
+    if (n)
         return pcBuffer;
     else {
         errno = EIO;
         return NULL;
     }
 }
+int ff_fflush(FF_FILE *pxStream) {
+    TRACE_PRINTF("%s\n", __func__);
+    FRESULT fr = FR_OK;
+    if (FF_BUF_WRITE == pxStream->buf_mode) fr = stream_flush_write(pxStream);
+    if (FR_OK == fr) fr = f_sync(&pxStream->fil);
+    errno = fresult2errno(fr);
+    if (FR_OK == fr)
+        return 0;
+    else
+        return -1;
+}
+int ff_rewind(FF_FILE *pxStream) {
+    return ff_fseek(pxStream, 0, FF_SEEK_SET);
+}
+int ff_feof(FF_FILE *pxStream) {
+    if (FF_BUF_READ == pxStream->buf_mode &&
+        pxStream->buf_pos < pxStream->buf_len)
+        return 0;
+    if (FF_BUF_WRITE == pxStream->buf_mode) return 0;
+    return f_eof(&pxStream->fil);
+}
+size_t ff_filelength(FF_FILE *pxStream) {
+    // Pending writes may extend the file past what FatFs knows about
+    FSIZE_t size = f_size(&pxStream->fil);
+    FSIZE_t pos = ff_ftell(pxStream);
+    return pos > size ? pos : size;
+}
@@ -32,6 +32,45 @@ specific language governing permissions and limitations under the License.
 #define TRACE_PRINTF(fmt, args...)
 //#define TRACE_PRINTF printf  // task_printf
 
+#if FF_USE_TRIM
+/* FatFs issues CTRL_TRIM once per contiguous run of freed clusters (see
+/  remove_chain in ff.c). The range is held until the next CTRL_SYNC (f_unlink,
+/  f_truncate and f_sync all end with one) and adjacent runs that arrive in the
+/  meantime are merged, so the card sees one erase sequence per range. A write
+/  that lands inside the pending range flushes it first, so freshly written
+/  data is never erased. */
+typedef struct {
+    LBA_t start;
+    LBA_t end;  // Inclusive
+    bool pending;
+} trim_range_t;
+static trim_range_t trim_ranges[FF_VOLUMES];
+
+static int trim_flush(sd_card_t *p_sd, BYTE pdrv) {
+    trim_range_t *tr = &trim_ranges[pdrv];
+    if (!tr->pending) return SD_BLOCK_DEVICE_ERROR_NONE;
+    tr->pending = false;
+    return p_sd->erase_blocks(p_sd, tr->start, (uint32_t)(tr->end - tr->start + 1));
+}
+
+static int trim_add(sd_card_t *p_sd, BYTE pdrv, LBA_t start, LBA_t end) {
+    trim_range_t *tr = &trim_ranges[pdrv];
+    int rc = SD_BLOCK_DEVICE_ERROR_NONE;
+    if (tr->pending) {
+        if (start == tr->end + 1 || end + 1 == tr->start) {
+            if (start < tr->start) tr->start = start;
+            if (end > tr->end) tr->end = end;
+            return rc;
+        }
+        rc = trim_flush(p_sd, pdrv);
+    }
+    tr->start = start;
+    tr->end = end;
+    tr->pending = true;
+    return rc;
+}
+#endif
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -116,6 +155,11 @@ DRESULT disk_write(BYTE pdrv, /* Physical drive nmuber to identify the drive */
     TRACE_PRINTF(">>> %s\n", __FUNCTION__);
     sd_card_t *p_sd = sd_get_by_num(pdrv);
     if (!p_sd) return RES_PARERR;
+#if FF_USE_TRIM
+    trim_range_t *tr = &trim_ranges[pdrv];
+    if (tr->pending && sector <= tr->end && sector + count > tr->start)
+        trim_flush(p_sd, pdrv);
+#endif
     int rc = p_sd->write_blocks(p_sd, buff, sector, count);
     return sdrc2dresult(rc);
 }
@@ -161,7 +205,21 @@ DRESULT disk_ioctl(BYTE pdrv, /* Physical drive nmuber (0..) */
             return RES_OK;
         }
         case CTRL_SYNC:
+#if FF_USE_TRIM
+            return sdrc2dresult(trim_flush(p_sd, pdrv));
+#else
             return RES_OK;
+#endif
+#if FF_USE_TRIM
+        case CTRL_TRIM: {  // Informs the device that the data on the block of
+                           // sectors specified by the LBA_t array {start,
+                           // end} pointed by buff (both inclusive) is no
+                           // longer needed. Required when FF_USE_TRIM == 1.
+            LBA_t *range = (LBA_t *)buff;
+            if (range[1] < range[0]) return RES_PARERR;
+            return sdrc2dresult(trim_add(p_sd, pdrv, range[0], range[1]));
+        }
+#endif
         default:
             return RES_PARERR;
     }
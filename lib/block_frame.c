@@ -0,0 +1,106 @@
+#include <string.h>
+
+#include "block_frame.h"
+#include "crc32.h"
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+size_t block_frame_write_header(uint8_t *dst, const block_frame_t *frame) {
+    memcpy(dst, frame->columns ? BLOCK_FRAME_MAGIC_COLUMNS : BLOCK_FRAME_MAGIC, 4);
+    put_u32(dst + 4, frame->seq);
+    put_u32(dst + 8, frame->first_sample);
+    put_u32(dst + 12, frame->first_ms);
+    put_u32(dst + 16, frame->raw_len);
+    put_u32(dst + 20, frame->comp_len);
+    put_u32(dst + 24, frame->crc);
+    if (!frame->columns) {
+        put_u32(dst + 28, crc32_update(0, dst, 28));
+        return BLOCK_FRAME_HEADER_SIZE;
+    }
+    put_u16(dst + 28, frame->count);
+    put_u16(dst + 30, 0);
+    for (int c = 0; c < BLOCK_FRAME_CHANNELS; c++) {
+        put_u16(dst + 32 + 2 * c, (uint16_t)frame->min[c]);
+        put_u16(dst + 44 + 2 * c, (uint16_t)frame->max[c]);
+    }
+    put_u32(dst + 56, crc32_update(0, dst, 56));
+    return BLOCK_FRAME_HEADER_SIZE_COLUMNS;
+}
+
+int block_frame_parse_header(const uint8_t *src, size_t len, block_frame_t *frame) {
+    size_t magic_len = len < 4 ? len : 4;
+    bool columns = memcmp(src, BLOCK_FRAME_MAGIC_COLUMNS, magic_len) == 0;
+    if (columns || memcmp(src, BLOCK_FRAME_MAGIC, magic_len) == 0) {
+        size_t crc_at = columns ? 56 : 28;
+        if (len < crc_at + 4)
+            return 0;
+        if (get_u32(src + crc_at) != crc32_update(0, src, crc_at))
+            return -1;
+        memset(frame, 0, sizeof(*frame));
+        frame->version = 2;
+        frame->columns = columns;
+        frame->seq = get_u32(src + 4);
+        frame->first_sample = get_u32(src + 8);
+        frame->first_ms = get_u32(src + 12);
+        frame->raw_len = get_u32(src + 16);
+        frame->comp_len = get_u32(src + 20);
+        frame->crc = get_u32(src + 24);
+        if (columns) {
+            frame->count = get_u16(src + 28);
+            for (int c = 0; c < BLOCK_FRAME_CHANNELS; c++) {
+                frame->min[c] = (int16_t)get_u16(src + 32 + 2 * c);
+                frame->max[c] = (int16_t)get_u16(src + 44 + 2 * c);
+            }
+            if (frame->raw_len < (uint32_t)frame->count * 2 * BLOCK_FRAME_CHANNELS)
+                return -1;
+        }
+    } else if (memcmp(src, BLOCK_FRAME_MAGIC_V1, magic_len) == 0) {
+        if (len < BLOCK_FRAME_HEADER_SIZE_V1)
+            return 0;
+        memset(frame, 0, sizeof(*frame));
+        frame->version = 1;
+        frame->raw_len = get_u32(src + 4);
+        frame->comp_len = get_u32(src + 8);
+        frame->crc = get_u32(src + 12);
+    } else {
+        return -1;
+    }
+    // O CRC do cabeçalho v1 não existe: os tamanhos são a única checagem
+    if (frame->raw_len == 0 || frame->raw_len > BLOCK_FRAME_MAX_RAW ||
+        frame->comp_len > frame->raw_len)
+        return -1;
+    if (frame->version == 1)
+        return BLOCK_FRAME_HEADER_SIZE_V1;
+    return columns ? BLOCK_FRAME_HEADER_SIZE_COLUMNS : BLOCK_FRAME_HEADER_SIZE;
+}
+
+size_t block_frame_find_sync(const uint8_t *src, size_t len, size_t from) {
+    block_frame_t frame;
+    for (size_t pos = from; pos < len; pos++) {
+        const uint8_t *p = memchr(src + pos, 'L', len - pos);
+        if (!p)
+            break;
+        pos = (size_t)(p - src);
+        if (block_frame_parse_header(p, len - pos, &frame) >= 0)
+            return pos;
+    }
+    return len;
+}
@@ -0,0 +1,68 @@
+#ifndef BLOCK_FRAME_H
+#define BLOCK_FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Cabeçalho dos blocos do log .lzb (lib/block_log.h). Portátil: usado pelo
+// firmware e pelas ferramentas do host (tools/).
+//
+// Versão 2 (32 bytes, little-endian):
+//   "LZB2" (palavra de sincronismo) | seq (u32, 0, 1, 2... na sessão) |
+//   primeira amostra (u32) | instante da primeira amostra em ms (u32) |
+//   raw_len (u32) | comp_len (u32) | crc32 dos dados brutos (u32) |
+//   crc32 dos 28 bytes anteriores do cabeçalho (u32)
+// Colunar (60 bytes, log no formato "columns", ver lib/column_block.h):
+//   "LZC1" | os mesmos seq, primeira amostra, ms, raw_len, comp_len e crc32
+//   dos dados | amostras no bloco (u16) | reservado (u16) | mínimo de cada
+//   canal (6 x i16) | máximo de cada canal (6 x i16) | crc32 dos 56 bytes
+//   anteriores do cabeçalho
+// Versão 1 (16 bytes, ainda lida):
+//   "LZB1" | raw_len (u32) | comp_len (u32) | crc32 dos dados brutos (u32)
+//
+// Se comp_len == raw_len o bloco foi gravado sem compressão. Depois de um
+// trecho ilegível, o leitor procura a próxima palavra de sincronismo cujo
+// cabeçalho tenha CRC válido e continua dali; seq e a primeira amostra dizem
+// exatamente o que se perdeu. O mínimo e o máximo do bloco colunar deixam uma
+// busca descartar blocos inteiros lendo só os cabeçalhos (tools/logquery.c).
+
+#define BLOCK_FRAME_MAGIC "LZB2"
+#define BLOCK_FRAME_MAGIC_V1 "LZB1"
+#define BLOCK_FRAME_MAGIC_COLUMNS "LZC1"
+#define BLOCK_FRAME_HEADER_SIZE 32
+#define BLOCK_FRAME_HEADER_SIZE_V1 16
+#define BLOCK_FRAME_HEADER_SIZE_COLUMNS 60
+#define BLOCK_FRAME_MAX_HEADER_SIZE BLOCK_FRAME_HEADER_SIZE_COLUMNS
+#define BLOCK_FRAME_MAX_RAW 65536
+#define BLOCK_FRAME_CHANNELS 6
+
+typedef struct {
+    uint8_t version; // 1 ou 2; na versão 1 seq/first_* ficam em zero
+    bool columns;    // Cabeçalho "LZC1" (versão 2): count, min e max valem
+    uint32_t seq;
+    uint32_t first_sample;
+    uint32_t first_ms;
+    uint32_t raw_len;
+    uint32_t comp_len;
+    uint32_t crc; // Dos dados brutos
+    uint16_t count; // Amostras do bloco colunar
+    int16_t min[BLOCK_FRAME_CHANNELS]; // Sem amostras: INT16_MAX / INT16_MIN
+    int16_t max[BLOCK_FRAME_CHANNELS];
+} block_frame_t;
+
+// Escreve o cabeçalho versão 2 (ou colunar, se frame->columns) em dst e
+// retorna o tamanho dele
+size_t block_frame_write_header(uint8_t *dst, const block_frame_t *frame);
+
+// Interpreta o cabeçalho em src (len bytes disponíveis). Retorna o tamanho do
+// cabeçalho, 0 se faltam bytes para decidir ou -1 se não é um cabeçalho
+// válido (sincronismo, tamanhos ou CRC do cabeçalho).
+int block_frame_parse_header(const uint8_t *src, size_t len, block_frame_t *frame);
+
+// Offset do próximo cabeçalho válido em src a partir de from. Um candidato
+// cortado no fim do buffer também é devolvido (o chamador lê mais e tenta de
+// novo); sem nenhum, retorna len.
+size_t block_frame_find_sync(const uint8_t *src, size_t len, size_t from);
+
+#endif
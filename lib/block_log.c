@@ -0,0 +1,232 @@
+#include <string.h>
+
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
+
+#include "block_log.h"
+#include "column_block.h"
+#include "crc32.h"
+#include "lz_block.h"
+
+typedef enum { BLOCK_FREE, BLOCK_FILLING, BLOCK_BUSY } block_state_t;
+
+typedef struct {
+    block_state_t state;
+    uint32_t raw_len;
+    uint32_t out_len; // Cabeçalho + dados
+    uint32_t compress_us;
+    uint32_t seq;          // Número do bloco na sessão
+    uint32_t first_sample; // Primeira amostra do bloco e seu instante
+    uint32_t first_ms;
+#if BLOCK_LOG_COLUMNS
+    uint16_t rows; // Amostras em raw (linhas de seis int16); 0 = texto
+#endif
+    uint8_t raw[BLOCK_LOG_BLOCK_SIZE] __attribute__((aligned(4)));
+    uint8_t out[BLOCK_LOG_HEADER_SIZE + BLOCK_LOG_BLOCK_SIZE];
+} block_t;
+
+static block_t blocks[BLOCK_LOG_BUFFERS];
+static int current = -1; // Bloco sendo preenchido
+static uint32_t next_seq;
+static log_writer_t *log_out;
+static block_log_written_cb written_cb;
+static block_log_stats_t stats;
+
+// Usados só pelo core 1
+#if BLOCK_LOG_COMPRESS
+static uint16_t hash_table[LZ_BLOCK_HASH_SIZE];
+#endif
+#if BLOCK_LOG_COLUMNS
+static uint8_t columns[BLOCK_LOG_BLOCK_SIZE]; // Bloco transposto
+#endif
+
+// --- Core 1 ---
+
+static void compress_block(block_t *b) {
+    uint32_t t0 = time_us_32();
+    uint8_t *payload = b->out + BLOCK_LOG_HEADER_SIZE;
+    const uint8_t *src = b->raw;
+    block_frame_t frame = {
+        .seq = b->seq,
+        .first_sample = b->first_sample,
+        .first_ms = b->first_ms,
+        .raw_len = b->raw_len,
+    };
+#if BLOCK_LOG_COLUMNS
+    frame.columns = true;
+    frame.count = b->rows;
+    column_block_pack((const int16_t (*)[COLUMN_BLOCK_CHANNELS])b->raw, b->rows, columns,
+                      frame.min, frame.max);
+    if (b->rows)
+        src = columns;
+#endif
+#if BLOCK_LOG_COMPRESS
+    uint32_t comp_len = lz_block_compress(src, b->raw_len, payload, b->raw_len - 1, hash_table);
+#else
+    uint32_t comp_len = 0;
+#endif
+    if (comp_len == 0) { // Não comprimiu: grava os dados brutos
+        memcpy(payload, src, b->raw_len);
+        comp_len = b->raw_len;
+    }
+    frame.comp_len = comp_len;
+    frame.crc = crc32_update(0, src, b->raw_len);
+    block_frame_write_header(b->out, &frame);
+    b->out_len = BLOCK_LOG_HEADER_SIZE + comp_len;
+    b->compress_us = time_us_32() - t0;
+}
+
+static void core1_entry(void) {
+    while (true) {
+        uint32_t idx = multicore_fifo_pop_blocking();
+        __mem_fence_acquire();
+        compress_block(&blocks[idx]);
+        __mem_fence_release();
+        multicore_fifo_push_blocking(idx);
+    }
+}
+
+// --- Core 0 ---
+
+void block_log_init(void) {
+    multicore_launch_core1(core1_entry);
+}
+
+static FRESULT write_finished(uint32_t idx) {
+    __mem_fence_acquire();
+    block_t *b = &blocks[idx];
+    b->state = BLOCK_FREE;
+    stats.blocks++;
+    if (b->out_len == BLOCK_LOG_HEADER_SIZE + b->raw_len)
+        stats.stored_blocks++;
+    if (b->compress_us > stats.max_compress_us)
+        stats.max_compress_us = b->compress_us;
+    if (written_cb)
+        written_cb(log_out->total, b->first_sample, b->first_ms);
+    return log_writer_write(log_out, b->out, b->out_len);
+}
+
+static void seal_current(void) {
+    if (current < 0)
+        return;
+    block_t *b = &blocks[current];
+    if (b->raw_len == 0) {
+        b->state = BLOCK_FREE;
+    } else {
+        b->seq = next_seq++;
+        b->state = BLOCK_BUSY;
+        __mem_fence_release();
+        multicore_fifo_push_blocking((uint32_t)current);
+    }
+    current = -1;
+}
+
+void block_log_discard(void) {
+    // Espera o core 1 devolver cada bloco e solta sem gravar; sem isso o
+    // índice deles fica na FIFO e o bloco velho vai para o arquivo seguinte
+    for (int i = 0; i < BLOCK_LOG_BUFFERS; i++) {
+        while (blocks[i].state == BLOCK_BUSY)
+            blocks[multicore_fifo_pop_blocking()].state = BLOCK_FREE;
+    }
+    if (current >= 0)
+        blocks[current].state = BLOCK_FREE;
+    current = -1;
+}
+
+void block_log_start(log_writer_t *writer, block_log_written_cb on_written) {
+    block_log_discard(); // Sobras de uma sessão interrompida
+    log_out = writer;
+    written_cb = on_written;
+    memset(&stats, 0, sizeof(stats));
+    current = -1;
+    next_seq = 0;
+    for (int i = 0; i < BLOCK_LOG_BUFFERS; i++)
+        blocks[i].state = BLOCK_FREE;
+}
+
+// Cabe no bloco atual? No modo colunar, texto e amostras não se misturam
+static bool fits(uint32_t n, bool row) {
+    if (current < 0 || blocks[current].raw_len + n > BLOCK_LOG_BLOCK_SIZE)
+        return false;
+#if BLOCK_LOG_COLUMNS
+    return blocks[current].raw_len == 0 || row == (blocks[current].rows > 0);
+#else
+    (void)row;
+    return true;
+#endif
+}
+
+static uint8_t *reserve(uint32_t n, uint32_t sample, uint32_t time_ms, bool row, bool *new_block) {
+    *new_block = false;
+    if (fits(n, row))
+        return blocks[current].raw + blocks[current].raw_len;
+
+    seal_current();
+    for (;;) {
+        for (int i = 0; i < BLOCK_LOG_BUFFERS; i++) {
+            if (blocks[i].state == BLOCK_FREE) {
+                current = i;
+                blocks[i].state = BLOCK_FILLING;
+                blocks[i].raw_len = 0;
+#if BLOCK_LOG_COLUMNS
+                blocks[i].rows = 0;
+#endif
+                blocks[i].first_sample = sample;
+                blocks[i].first_ms = time_ms;
+                *new_block = true;
+                return blocks[i].raw;
+            }
+        }
+        // Todos no core 1: espera o mais antigo (tempo de compressão limitado)
+        stats.waits++;
+        if (write_finished(multicore_fifo_pop_blocking()) != FR_OK)
+            return NULL;
+    }
+}
+
+uint8_t *block_log_reserve(uint32_t n, uint32_t sample, uint32_t time_ms, bool *new_block) {
+    return reserve(n, sample, time_ms, false, new_block);
+}
+
+void block_log_commit(uint32_t n) {
+    blocks[current].raw_len += n;
+    stats.raw_bytes += n;
+}
+
+#if BLOCK_LOG_COLUMNS
+bool block_log_add_row(uint32_t sample, uint32_t time_ms, const int16_t values[6]) {
+    bool new_block;
+    uint8_t *dst = reserve(COLUMN_BLOCK_ROW_SIZE, sample, time_ms, true, &new_block);
+    if (!dst)
+        return false;
+    memcpy(dst, values, COLUMN_BLOCK_ROW_SIZE);
+    blocks[current].rows++;
+    block_log_commit(COLUMN_BLOCK_ROW_SIZE);
+    return true;
+}
+#endif
+
+FRESULT block_log_poll(void) {
+    FRESULT fr = FR_OK;
+    while (multicore_fifo_rvalid() && fr == FR_OK)
+        fr = write_finished(multicore_fifo_pop_blocking());
+    return fr;
+}
+
+FRESULT block_log_finish(void) {
+    FRESULT fr = FR_OK;
+    seal_current();
+    for (int i = 0; i < BLOCK_LOG_BUFFERS; i++) {
+        while (blocks[i].state == BLOCK_BUSY) {
+            FRESULT r = write_finished(multicore_fifo_pop_blocking());
+            if (fr == FR_OK)
+                fr = r;
+        }
+    }
+    return fr;
+}
+
+const block_log_stats_t *block_log_stats(void) {
+    return &stats;
+}
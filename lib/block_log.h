@@ -0,0 +1,94 @@
+#ifndef BLOCK_LOG_H
+#define BLOCK_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "block_frame.h"
+#include "ff.h"
+#include "log_writer.h"
+
+// Log em blocos comprimidos (formato .lzb).
+//
+// O core 0 preenche um bloco de registros (CSV ou .imu) e o entrega ao core 1
+// pela FIFO do multicore. O core 1 comprime com lz_block (tempo O(n),
+// limitado), calcula o CRC32 e devolve o bloco pela FIFO; o core 0 grava o
+// resultado pelo log_writer. O FatFs só é usado no core 0.
+//
+// Cada bloco começa com o cabeçalho de lib/block_frame.h (sincronismo,
+// número de sequência, primeira amostra, tamanhos e CRC32 dos dados e do
+// próprio cabeçalho): um setor ruim perde só os blocos que ele atinge e o
+// leitor retoma no próximo cabeçalho válido.
+// Os registros nunca atravessam blocos: cada bloco descomprime sozinho.
+//
+// Com BLOCK_LOG_COMPRESS=0 (DATALOGGER_LOG_FRAMED) os blocos vão sem
+// compressão, só com o enquadramento e o CRC.
+//
+// Com BLOCK_LOG_COLUMNS=1 (formato "columns") as amostras entram com
+// block_log_add_row() como linhas de seis int16, uma cópia só no core 0. O
+// core 1 transpõe o bloco para o layout colunar de lib/column_block.h e grava
+// o mínimo e o máximo de cada canal no cabeçalho "LZC1". O texto de
+// metadados (block_log_reserve) vai em blocos próprios, sem amostras.
+
+#ifndef BLOCK_LOG_BLOCK_SIZE
+#define BLOCK_LOG_BLOCK_SIZE 4096 // Dados brutos por bloco (até 64 KB)
+#endif
+#ifndef BLOCK_LOG_COMPRESS
+#define BLOCK_LOG_COMPRESS 1
+#endif
+#ifndef BLOCK_LOG_COLUMNS
+#define BLOCK_LOG_COLUMNS 0
+#endif
+#define BLOCK_LOG_BUFFERS 2       // Um enchendo, outro no core 1
+#if BLOCK_LOG_COLUMNS
+#define BLOCK_LOG_HEADER_SIZE BLOCK_FRAME_HEADER_SIZE_COLUMNS
+#else
+#define BLOCK_LOG_HEADER_SIZE BLOCK_FRAME_HEADER_SIZE
+#endif
+
+typedef struct {
+    uint64_t raw_bytes;       // Total de bytes brutos da sessão
+    uint32_t blocks;
+    uint32_t stored_blocks;   // Blocos que não comprimiram
+    uint32_t max_compress_us; // Pior tempo de compressão de um bloco
+    uint32_t waits;           // Vezes que o core 0 esperou o core 1
+} block_log_stats_t;
+
+// Chamado no core 0 logo antes de cada bloco ir para o writer: offset do bloco
+// no arquivo e a primeira amostra dele (para o índice .idx)
+typedef void (*block_log_written_cb)(uint64_t file_offset, uint32_t first_sample,
+                                     uint32_t first_ms);
+
+// Inicia o core 1 (uma vez, no boot)
+void block_log_init(void);
+
+// Começa uma sessão gravando pelo writer indicado (on_written pode ser NULL).
+// Blocos de uma sessão anterior que ainda estejam no core 1 são descartados.
+void block_log_start(log_writer_t *writer, block_log_written_cb on_written);
+
+// Reserva n bytes contíguos no bloco atual para a amostra sample (instante
+// time_ms). Se não couberem, o bloco é entregue ao core 1 e outro é aberto;
+// nesse caso *new_block = true e o chamador deve reiniciar o que dependa do
+// bloco anterior (ex.: keyframe).
+uint8_t *block_log_reserve(uint32_t n, uint32_t sample, uint32_t time_ms, bool *new_block);
+void block_log_commit(uint32_t n);
+
+#if BLOCK_LOG_COLUMNS
+// Acrescenta uma amostra (seis canais) ao bloco atual. Retorna false se a
+// gravação de um bloco anterior falhou.
+bool block_log_add_row(uint32_t sample, uint32_t time_ms, const int16_t values[6]);
+#endif
+
+// Grava os blocos que o core 1 já terminou (não bloqueia)
+FRESULT block_log_poll(void);
+
+// Fecha o bloco parcial, espera o core 1 e grava tudo
+FRESULT block_log_finish(void);
+
+// Sessão interrompida: espera o core 1 e solta os blocos (o parcial também)
+// sem passar nada ao writer nem ao on_written
+void block_log_discard(void);
+
+const block_log_stats_t *block_log_stats(void);
+
+#endif
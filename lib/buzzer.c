@@ -0,0 +1,89 @@
+#include "buzzer.h"
+
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+static uint buzzer_pin;
+static uint buzzer_slice;
+
+// Fila produtor/consumidor: buzzer_play() avança o fim, o alarme o início.
+// Índices livres, reduzidos módulo BUZZER_QUEUE_SIZE no acesso.
+static buzzer_tone_t queue[BUZZER_QUEUE_SIZE];
+static volatile uint32_t queue_head, queue_tail;
+static volatile bool playing; // Há um alarme agendado
+
+static void buzzer_tone(uint16_t freq_hz) {
+    if (freq_hz == 0) {
+        pwm_set_gpio_level(buzzer_pin, 0);
+        return;
+    }
+    // Menor divisor (4 bits de fração) com o TOP cabendo em 16 bits: mais
+    // resolução no período. A 125 MHz, 500 Hz dá divisor 3,875 e TOP 64515.
+    uint32_t clk = clock_get_hz(clk_sys);
+    uint64_t step = (uint64_t)freq_hz * 65536;
+    uint32_t div16 = (uint32_t)(((uint64_t)clk * 16 + step - 1) / step);
+    if (div16 < 16)
+        div16 = 16;
+    if (div16 > 0xFFF)
+        div16 = 0xFFF;
+    uint64_t top = (uint64_t)clk * 16 / ((uint64_t)div16 * freq_hz) - 1;
+    if (top > 0xFFFF)
+        top = 0xFFFF;
+    pwm_set_clkdiv_int_frac(buzzer_slice, (uint8_t)(div16 >> 4), div16 & 15);
+    pwm_set_wrap(buzzer_slice, (uint16_t)top);
+    pwm_set_gpio_level(buzzer_pin, (uint16_t)((top + 1) / 2)); // Onda quadrada
+}
+
+// Alarme: fim do tom atual, começa o próximo da fila
+static int64_t buzzer_next(alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    if (queue_head == queue_tail) {
+        buzzer_tone(0);
+        playing = false;
+        return 0;
+    }
+    buzzer_tone_t tone = queue[queue_head % BUZZER_QUEUE_SIZE];
+    queue_head++;
+    buzzer_tone(tone.freq_hz);
+    // Negativo: relativo ao instante em que este alarme devia disparar, sem
+    // acumular a latência da interrupção nas sequências longas
+    return -(int64_t)(tone.ms ? tone.ms : 1) * 1000;
+}
+
+void buzzer_init(uint pin) {
+    buzzer_pin = pin;
+    buzzer_slice = pwm_gpio_to_slice_num(pin);
+    queue_head = queue_tail = 0;
+    playing = false;
+    gpio_set_function(pin, GPIO_FUNC_PWM);
+    pwm_set_gpio_level(pin, 0);
+    pwm_set_enabled(buzzer_slice, true);
+}
+
+bool buzzer_play(const buzzer_tone_t *tones, size_t count) {
+    // O alarme roda neste núcleo: sem interrupções, ele não consome a fila
+    // nem encerra a reprodução enquanto ela é estendida
+    uint32_t irq = save_and_disable_interrupts();
+    if (queue_tail - queue_head + count > BUZZER_QUEUE_SIZE) {
+        restore_interrupts(irq);
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+        queue[(queue_tail + i) % BUZZER_QUEUE_SIZE] = tones[i];
+    queue_tail += count;
+    bool start = !playing && count > 0;
+    if (start)
+        playing = true;
+    restore_interrupts(irq);
+
+    // Sem alarme livre o som se perde, mas a fila não fica presa
+    if (start && add_alarm_in_us(1, buzzer_next, NULL, true) < 0) {
+        irq = save_and_disable_interrupts();
+        queue_head = queue_tail;
+        playing = false;
+        restore_interrupts(irq);
+    }
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pico/stdlib.h"
+
+// Buzzer passivo tocado por PWM. Os tons e pausas ficam numa fila curta e são
+// sequenciados por um alarme do timer: buzzer_play() só copia a sequência e
+// retorna, e o laço principal não gasta CPU com o som.
+
+#ifndef BUZZER_QUEUE_SIZE
+#define BUZZER_QUEUE_SIZE 16 // Potência de 2
+#endif
+
+typedef struct {
+    uint16_t freq_hz; // 0: pausa
+    uint16_t ms;
+} buzzer_tone_t;
+
+// Configura o pino (fica em silêncio)
+void buzzer_init(uint pin);
+
+// Põe a sequência na fila, depois do que já estiver tocando. Retorna false
+// (e não toca nada dela) se a sequência não couber na fila.
+bool buzzer_play(const buzzer_tone_t *tones, size_t count);
+
+#endif
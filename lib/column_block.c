@@ -0,0 +1,26 @@
+#include "column_block.h"
+
+void column_block_pack(const int16_t (*rows)[COLUMN_BLOCK_CHANNELS], uint32_t count,
+                       uint8_t *dst, int16_t min[COLUMN_BLOCK_CHANNELS],
+                       int16_t max[COLUMN_BLOCK_CHANNELS]) {
+    for (int c = 0; c < COLUMN_BLOCK_CHANNELS; c++) {
+        int16_t lo = INT16_MAX, hi = INT16_MIN;
+        uint8_t *out = dst + 2 * (size_t)c * count;
+        for (uint32_t i = 0; i < count; i++) {
+            int16_t v = rows[i][c];
+            lo = v < lo ? v : lo;
+            hi = v > hi ? v : hi;
+            out[2 * i] = (uint8_t)v;
+            out[2 * i + 1] = (uint8_t)((uint16_t)v >> 8);
+        }
+        min[c] = lo;
+        max[c] = hi;
+    }
+}
+
+void column_block_get(const uint8_t *src, uint32_t count, uint32_t i,
+                      int16_t values[COLUMN_BLOCK_CHANNELS]) {
+    const uint8_t *p = src + 2 * (size_t)i;
+    for (int c = 0; c < COLUMN_BLOCK_CHANNELS; c++, p += 2 * (size_t)count)
+        values[c] = (int16_t)(p[0] | p[1] << 8);
+}
@@ -0,0 +1,32 @@
+#ifndef COLUMN_BLOCK_H
+#define COLUMN_BLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Conteúdo dos blocos colunares "LZC1" (lib/block_frame.h), usado no formato
+// de log "columns".
+//
+// As count amostras do bloco vão como seis vetores int16 little-endian
+// contíguos (AccelX[count], AccelY[count], ..., GyroZ[count]), seguidos do
+// texto de metadados do bloco, se houver. A amostra i do bloco é a
+// first_sample + i do cabeçalho. O mínimo e o máximo de cada canal vão no
+// cabeçalho, para o host descartar blocos sem descomprimir.
+//
+// Código portátil (sem dependências do SDK): também compila no host.
+
+#define COLUMN_BLOCK_CHANNELS 6
+#define COLUMN_BLOCK_ROW_SIZE (2 * COLUMN_BLOCK_CHANNELS) // Bytes por amostra
+
+// Transpõe count amostras (uma linha de seis canais por amostra) para os
+// vetores em dst (count * COLUMN_BLOCK_ROW_SIZE bytes) e calcula o mínimo e
+// o máximo de cada canal. Sem amostras, min = INT16_MAX e max = INT16_MIN.
+void column_block_pack(const int16_t (*rows)[COLUMN_BLOCK_CHANNELS], uint32_t count,
+                       uint8_t *dst, int16_t min[COLUMN_BLOCK_CHANNELS],
+                       int16_t max[COLUMN_BLOCK_CHANNELS]);
+
+// Valores da amostra i de um bloco com count amostras
+void column_block_get(const uint8_t *src, uint32_t count, uint32_t i,
+                      int16_t values[COLUMN_BLOCK_CHANNELS]);
+
+#endif
@@ -0,0 +1,54 @@
+#include "csv_format.h"
+
+static const uint32_t pow10_u32[] = {
+    1000000000u, 100000000u, 10000000u, 1000000u, 100000u,
+    10000u, 1000u, 100u, 10u, 1u,
+};
+
+// Decimal de 32 bits por subtração (o M0+ não tem divisão de 32 bits em
+// hardware; o número da amostra raramente passa de 6 dígitos)
+static inline char *put_u32(char *p, uint32_t v) {
+    int i = 0;
+    while (i < 9 && v < pow10_u32[i])
+        i++; // Pula zeros à esquerda; "0" sai pela última potência
+    for (; i < 10; i++) {
+        uint32_t pw = pow10_u32[i];
+        char d = '0';
+        while (v >= pw) {
+            v -= pw;
+            d++;
+        }
+        *p++ = d;
+    }
+    return p;
+}
+
+// Decimal de int16: x / 10 == (x * 0xCCCD) >> 19 para todo x < 81920
+static inline char *put_i16(char *p, int16_t value) {
+    uint32_t v = value;
+    if (value < 0) {
+        *p++ = '-';
+        v = -(int32_t)value;
+    }
+    char tmp[5];
+    int n = 0;
+    do {
+        uint32_t q = (v * 0xCCCDu) >> 19;
+        tmp[n++] = (char)('0' + (v - q * 10));
+        v = q;
+    } while (v);
+    while (n)
+        *p++ = tmp[--n];
+    return p;
+}
+
+size_t csv_format_record(char *dst, uint32_t sample,
+                         const int16_t values[CSV_FORMAT_CHANNELS]) {
+    char *p = put_u32(dst, sample);
+    for (int i = 0; i < CSV_FORMAT_CHANNELS; i++) {
+        *p++ = ',';
+        p = put_i16(p, values[i]);
+    }
+    *p++ = '\n';
+    return (size_t)(p - dst);
+}
@@ -0,0 +1,28 @@
+#ifndef CSV_FORMAT_H
+#define CSV_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Formatação das linhas do log CSV sem sprintf.
+//
+// Gera exatamente o mesmo texto que
+//   sprintf(dst, "%lu,%d,%d,%d,%d,%d,%d\n", sample, v[0], ..., v[5])
+// mas sem divisões: os campos int16 usam multiplicação pelo recíproco de 10
+// e o número da amostra usa subtração de potências de 10. O texto vai direto
+// para o buffer de destino (ex.: log_writer_reserve), sem buffer de linha nem
+// strlen.
+//
+// Código portátil (sem dependências do SDK): também compila no host.
+
+#define CSV_FORMAT_CHANNELS 6
+
+// Pior caso: "4294967295" + 6 x ",-32768" + "\n"
+#define CSV_FORMAT_MAX_RECORD (10 + CSV_FORMAT_CHANNELS * 7 + 1)
+
+// Escreve uma linha em dst (até CSV_FORMAT_MAX_RECORD bytes, sem '\0') e
+// retorna o tamanho
+size_t csv_format_record(char *dst, uint32_t sample,
+                         const int16_t values[CSV_FORMAT_CHANNELS]);
+
+#endif
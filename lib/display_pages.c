@@ -0,0 +1,235 @@
+#include <stdio.h>
+
+#include "display_pages.h"
+
+// Gráfico da página 2: páginas CHART_PAGE0..7 do OLED, com o nome do canal e
+// a escala nas duas de cima. Cada entrada nova do anel desloca o gráfico uma
+// coluna para a esquerda e desenha só a coluna da direita; o envio parcial
+// manda só as páginas por onde o traço passa. A escala (valor no centro e
+// unidades brutas por pixel, em potências de 2) só muda quando o traço sai da
+// área ou a cada tela inteira, se couber numa menor; aí o gráfico é
+// redesenhado do anel.
+#define CHART_PAGE0 2
+#define CHART_TOP (CHART_PAGE0 * 8)
+#define CHART_HEIGHT (HEIGHT - CHART_TOP)
+
+static const char *const chart_names[SAMPLE_RING_CHANNELS] = {"Ax", "Ay", "Az", "Gx", "Gy", "Gz"};
+static bool chart_valid = false; // false: redesenha o gráfico inteiro
+static uint32_t chart_next = 0;  // Próxima entrada do anel a desenhar
+static uint32_t chart_columns = 0; // Colunas desenhadas desde a última escala
+static uint8_t chart_channel = 0;
+static int32_t chart_center = 0;
+static uint8_t chart_shift = 0;
+
+static int chart_y(int32_t value) {
+    return CHART_TOP + CHART_HEIGHT / 2 - ((value - chart_center) >> chart_shift);
+}
+
+static bool chart_fits(const sample_ring_entry_t *e) {
+    return chart_y(e->max[chart_channel]) >= CHART_TOP && chart_y(e->min[chart_channel]) < HEIGHT;
+}
+
+// Menor escala em que as entradas na tela cabem na área do gráfico. O centro
+// anda em passos de um quarto da altura, para o ruído não mudar a escala.
+// Retorna true se mudou.
+static bool chart_rescale(const sample_ring_t *ring) {
+    int32_t lo = INT16_MAX, hi = INT16_MIN;
+    uint32_t first = ring->count > WIDTH ? ring->count - WIDTH : 0;
+    for (uint32_t seq = first; seq < ring->count; seq++) {
+        const sample_ring_entry_t *e = sample_ring_get(ring, seq);
+        if (e->min[chart_channel] < lo)
+            lo = e->min[chart_channel];
+        if (e->max[chart_channel] > hi)
+            hi = e->max[chart_channel];
+    }
+    if (lo > hi)
+        lo = hi = 0;
+    int32_t center = 0;
+    uint8_t shift = 0;
+    for (; shift < 16; shift++) {
+        int32_t step = (int32_t)(CHART_HEIGHT / 4) << shift;
+        int32_t mid = (lo + hi) / 2;
+        center = (mid >= 0 ? mid + step / 2 : mid - step / 2) / step * step;
+        // As mesmas contas de chart_y()
+        if (((hi - center) >> shift) <= CHART_HEIGHT / 2 && ((lo - center) >> shift) > -CHART_HEIGHT / 2)
+            break;
+    }
+    bool changed = center != chart_center || shift != chart_shift;
+    chart_center = center;
+    chart_shift = shift;
+    return changed;
+}
+
+// Coluna x com a entrada seq: a faixa min..max, estendida até a coluna
+// anterior para o traço ficar contínuo
+static void chart_column(ssd1306_t *ssd, const sample_ring_t *ring, uint8_t x, uint32_t seq) {
+    const sample_ring_entry_t *e = sample_ring_get(ring, seq);
+    const sample_ring_entry_t *prev = seq ? sample_ring_get(ring, seq - 1) : NULL;
+    int32_t lo = e->min[chart_channel], hi = e->max[chart_channel];
+    if (prev) {
+        if (prev->max[chart_channel] < lo)
+            lo = prev->max[chart_channel];
+        if (prev->min[chart_channel] > hi)
+            hi = prev->min[chart_channel];
+    }
+    int top = chart_y(hi), bottom = chart_y(lo);
+    if (top < CHART_TOP)
+        top = CHART_TOP;
+    if (bottom >= HEIGHT)
+        bottom = HEIGHT - 1;
+    if (top <= bottom)
+        ssd1306_vline(ssd, x, top, bottom, true);
+}
+
+static void draw_chart(ssd1306_t *ssd, const sample_ring_t *ring) {
+    uint32_t count = ring->count;
+    uint32_t n = count - chart_next;
+    if (chart_valid && n > WIDTH)
+        chart_valid = false; // Atrasou mais que uma tela
+    for (uint32_t seq = chart_next; chart_valid && seq < count; seq++) {
+        if (!chart_fits(sample_ring_get(ring, seq)))
+            chart_valid = false;
+    }
+    if (chart_valid && chart_columns + n >= WIDTH) {
+        chart_columns = 0;
+        if (chart_rescale(ring))
+            chart_valid = false;
+    }
+
+    if (!chart_valid) {
+        chart_rescale(ring);
+        ssd1306_rect(ssd, CHART_TOP, 0, WIDTH, CHART_HEIGHT, false, true);
+        uint32_t first = count > WIDTH ? count - WIDTH : 0;
+        for (uint32_t seq = first; seq < count; seq++)
+            chart_column(ssd, ring, WIDTH - (count - seq), seq);
+        chart_valid = true;
+        chart_columns = 0;
+    } else if (n > 0) {
+        ssd1306_scroll_left(ssd, CHART_PAGE0, HEIGHT / 8 - 1, n);
+        for (uint32_t seq = chart_next; seq < count; seq++)
+            chart_column(ssd, ring, WIDTH - (count - seq), seq);
+        chart_columns += n;
+    }
+    chart_next = count;
+}
+
+// Linhas de 16 caracteres, uma por página (linha 2 em branco)
+// "Amostras: " e a contagem em até 6 caracteres (999999, 99999k, 4294M): os
+// 16 da linha. ssd1306_text_line() corta o que passar da coluna 15 sem
+// avisar, e um uint32_t inteiro (10 dígitos) perderia os últimos.
+static void format_samples(char *line, uint32_t samples) {
+    if (samples < 1000000)
+        sprintf(line, "Amostras: %lu", (unsigned long)samples);
+    else if (samples < 100000000)
+        sprintf(line, "Amostras: %luk", (unsigned long)(samples / 1000));
+    else
+        sprintf(line, "Amostras: %luM", (unsigned long)(samples / 1000000));
+}
+
+static void draw_status(ssd1306_t *ssd, const display_view_t *view) {
+    char line_buffer[25]; // Buffer para as linhas de texto
+
+    ssd1306_text_line(ssd, 0, "DATALOGGER IMU");
+    ssd1306_text_line(ssd, 1, "----------------");
+
+    switch (view->state) {
+        case SYS_INITIALIZING:
+            ssd1306_text_line(ssd, 3, "Inicializando...");
+            break;
+        case SYS_SD_NOT_DETECTED:
+            ssd1306_text_line(ssd, 3, "SD Nao Detectado");
+            ssd1306_text_line(ssd, 4, "Confira conexao");
+            break;
+        case SYS_READY:
+            ssd1306_text_line(ssd, 3, "Pronto p/ gravar");
+            ssd1306_text_line(ssd, 4, "Aperte o botao A");
+            if (view->space_low) {
+                ssd1306_text_line(ssd, 5, "Cartao cheio!");
+            } else {
+                sprintf(line_buffer, "Livre: %lu MB", (unsigned long)view->free_mb);
+                ssd1306_text_line(ssd, 5, line_buffer);
+            }
+            break;
+        case SYS_RECORDING: {
+            ssd1306_text_line(ssd, 3, "Gravando...");
+            format_samples(line_buffer, view->samples);
+            ssd1306_text_line(ssd, 4, line_buffer);
+            sprintf(line_buffer, "Tempo: %lu s", (unsigned long)view->elapsed_s);
+            ssd1306_text_line(ssd, 5, line_buffer);
+            long remaining_s = view->remaining_s;
+            if (remaining_s < 0) {
+                sprintf(line_buffer, "Resta: --");
+            } else if (remaining_s >= 3600) {
+                sprintf(line_buffer, "Resta: %ldh%02ldm", remaining_s / 3600, (remaining_s / 60) % 60);
+            } else {
+                sprintf(line_buffer, "Resta: %ldm%02lds", remaining_s / 60, remaining_s % 60);
+            }
+            ssd1306_text_line(ssd, 6, line_buffer);
+            break;
+        }
+        case SYS_DATA_SAVED:
+            ssd1306_text_line(ssd, 3, "Dados Salvos!");
+            format_samples(line_buffer, view->samples);
+            ssd1306_text_line(ssd, 4, line_buffer);
+            ssd1306_text_line(ssd, 5, "Aperte o botao A");
+            ssd1306_text_line(ssd, 6, view->space_low ? "Cartao cheio!" : "");
+            break;
+        case SYS_ERROR:
+            ssd1306_text_line(ssd, 3, "ERRO NO SISTEMA!");
+            ssd1306_text_line(ssd, 4, "Reinicie o Pico");
+            break;
+    }
+}
+
+static void draw_imu(ssd1306_t *ssd, const display_view_t *view) {
+    char line_buffer[25];
+
+    ssd1306_text_line(ssd, 0, "DADOS IMU");
+    ssd1306_text_line(ssd, 1, "----------------");
+
+    // Uma linha por eixo, aceleração e giroscópio lado a lado
+    ssd1306_text_line(ssd, 2, "    Acel   Giro");
+    for (int axis = 0; axis < 3; axis++) {
+        sprintf(line_buffer, "%c %6d %6d", 'X' + axis, view->accel[axis], view->gyro[axis]);
+        ssd1306_text_line(ssd, 3 + axis, line_buffer);
+    }
+
+    float temp_c = view->temp / 340.0 + 36.53; // Conversão típica para MPU6050
+    sprintf(line_buffer, "Temp: %.1f C", temp_c);
+    ssd1306_text_line(ssd, 7, line_buffer);
+}
+
+static void draw_graph(ssd1306_t *ssd, const display_view_t *view) {
+    char line_buffer[32];
+
+    if (view->chart_channel != chart_channel) {
+        chart_channel = view->chart_channel % SAMPLE_RING_CHANNELS;
+        chart_valid = false;
+    }
+    draw_chart(ssd, view->ring); // Páginas 2..7, fora da camada de texto
+
+    sprintf(line_buffer, "GRAFICO %s", chart_names[chart_channel]);
+    ssd1306_text_line(ssd, 0, line_buffer);
+    sprintf(line_buffer, "%d a %d", (int)(chart_center - ((int32_t)(CHART_HEIGHT / 2) << chart_shift)),
+            (int)(chart_center + ((int32_t)(CHART_HEIGHT / 2) << chart_shift)));
+    ssd1306_text_line(ssd, 1, line_buffer);
+}
+
+void display_pages_draw(ssd1306_t *ssd, const display_view_t *view) {
+    static int shown_page = -1;
+    static SystemState shown_state;
+    if (view->page != shown_page || view->state != shown_state) {
+        ssd1306_fill(ssd, false);
+        chart_valid = false;
+        shown_page = view->page;
+        shown_state = view->state;
+    }
+
+    if (view->page == 0) { // Página de Status
+        draw_status(ssd, view);
+    } else if (view->page == 1) { // Página de Dados IMU (em tempo real)
+        draw_imu(ssd, view);
+    } else if (view->page == 2) { // Gráfico rolando de um canal
+        draw_graph(ssd, view);
+    }
+}
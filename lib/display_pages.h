@@ -0,0 +1,47 @@
+#ifndef DISPLAY_PAGES_H
+#define DISPLAY_PAGES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ssd1306.h"
+#include "sample_ring.h"
+
+// Páginas do OLED desenhadas a partir de um retrato do estado do datalogger
+// (display_view_t), sem ler sensores, cartão ou relógio: o firmware preenche
+// o retrato em update_display() e tools/oledsim.c desenha as mesmas páginas
+// no PC.
+//
+// A tela só é limpa quando muda a página ou o estado; no resto, a camada de
+// texto do driver redesenha só os caracteres que mudaram e o gráfico rola.
+
+// --- Enumeração de Estados do Sistema ---
+typedef enum {
+    SYS_INITIALIZING,
+    SYS_SD_NOT_DETECTED,
+    SYS_READY,
+    SYS_RECORDING,
+    SYS_DATA_SAVED,
+    SYS_ERROR
+} SystemState;
+
+#define SYS_STATE_COUNT (SYS_ERROR + 1)
+#define DISPLAY_PAGE_COUNT 3 // 0: Status, 1: Dados IMU, 2: Gráfico
+
+typedef struct {
+    uint8_t page;
+    SystemState state;
+    uint32_t samples;     // Amostras da sessão atual/última
+    uint32_t elapsed_s;   // Tempo de gravação
+    int32_t remaining_s;  // Na taxa atual de gravação (-1 se desconhecido)
+    uint32_t free_mb;     // Livre no cartão
+    bool space_low;       // Chegou à reserva (lib/sd_space.h)
+    int16_t accel[3], gyro[3], temp; // Página 1, em unidades brutas
+    const sample_ring_t *ring;       // Página 2
+    uint8_t chart_channel;           // 0..2 Ax..Az, 3..5 Gx..Gz
+} display_view_t;
+
+// Desenha a página view->page no framebuffer (o envio fica com o chamador)
+void display_pages_draw(ssd1306_t *ssd, const display_view_t *view);
+
+#endif
@@ -0,0 +1,163 @@
+#include <string.h>
+
+#include "imu_codec.h"
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline uint8_t *put_varint(uint8_t *p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+void imu_encoder_init(imu_encoder_t *enc, uint16_t keyframe_interval) {
+    memset(enc, 0, sizeof(*enc));
+    enc->keyframe_interval = keyframe_interval ? keyframe_interval : 1;
+    imu_encoder_force_keyframe(enc);
+}
+
+void imu_encoder_force_keyframe(imu_encoder_t *enc) {
+    enc->since_keyframe = enc->keyframe_interval;
+}
+
+size_t imu_codec_write_header(const imu_encoder_t *enc, uint8_t *dst,
+                              const char *text, uint16_t text_len) {
+    memcpy(dst, IMU_CODEC_MAGIC, 4);
+    dst[4] = IMU_CODEC_VERSION;
+    dst[5] = IMU_CODEC_CHANNELS;
+    dst[6] = (uint8_t)enc->keyframe_interval;
+    dst[7] = (uint8_t)(enc->keyframe_interval >> 8);
+    dst[8] = (uint8_t)text_len;
+    dst[9] = (uint8_t)(text_len >> 8);
+    memcpy(dst + IMU_CODEC_HEADER_SIZE, text, text_len);
+    return IMU_CODEC_HEADER_SIZE + text_len;
+}
+
+size_t imu_codec_write_trailer(uint8_t *dst, const char *text, uint16_t text_len) {
+    uint8_t *p = put_varint(dst, IMU_CODEC_END_MARK);
+    *p++ = (uint8_t)text_len;
+    *p++ = (uint8_t)(text_len >> 8);
+    memcpy(p, text, text_len);
+    return IMU_CODEC_TRAILER_SIZE + text_len;
+}
+
+size_t imu_encoder_encode(imu_encoder_t *enc, uint32_t sample,
+                          const int16_t values[IMU_CODEC_CHANNELS], uint8_t *dst) {
+    uint8_t *p = dst;
+
+    if (enc->since_keyframe >= enc->keyframe_interval || sample != enc->sample + 1) {
+        p = put_varint(p, (sample << 1) | 1);
+        for (int i = 0; i < IMU_CODEC_CHANNELS; i++)
+            p = put_varint(p, zigzag(values[i]));
+        enc->since_keyframe = 0;
+    } else {
+        // Deltas de int16 cabem em 17 bits: zigzag(delta0) << 1 cabe em 32
+        p = put_varint(p, zigzag(values[0] - enc->prev[0]) << 1);
+        for (int i = 1; i < IMU_CODEC_CHANNELS; i++)
+            p = put_varint(p, zigzag(values[i] - enc->prev[i]));
+    }
+
+    enc->since_keyframe++;
+    enc->sample = sample;
+    memcpy(enc->prev, values, sizeof(enc->prev));
+    return (size_t)(p - dst);
+}
+
+// --- Decodificação ---
+
+static inline int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Lê um varint de até 5 bytes. Retorna o ponteiro após ele, NULL se faltam
+// bytes; *bad indica varint com mais de 5 bytes.
+static inline const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint32_t *v,
+                                        bool *bad) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p >= end)
+            return NULL;
+        uint8_t b = *p++;
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if (b < 0x80) {
+            *v = result;
+            return p;
+        }
+    }
+    *bad = true;
+    return NULL;
+}
+
+int32_t imu_codec_read_header(const uint8_t *src, size_t len, uint16_t *keyframe_interval,
+                              const char **text, uint16_t *text_len) {
+    if (len < 8)
+        return 0;
+    if (memcmp(src, IMU_CODEC_MAGIC, 4) != 0 || (src[4] != 1 && src[4] != IMU_CODEC_VERSION) ||
+        src[5] != IMU_CODEC_CHANNELS)
+        return -1;
+    if (keyframe_interval)
+        *keyframe_interval = (uint16_t)(src[6] | src[7] << 8);
+    uint16_t n = 0;
+    int32_t size = 8;
+    if (src[4] == IMU_CODEC_VERSION) {
+        if (len < IMU_CODEC_HEADER_SIZE)
+            return 0;
+        n = (uint16_t)(src[8] | src[9] << 8);
+        size = IMU_CODEC_HEADER_SIZE + n;
+        if (len < (size_t)size)
+            return 0;
+    }
+    if (text)
+        *text = (const char *)src + size - n;
+    if (text_len)
+        *text_len = n;
+    return size;
+}
+
+void imu_decoder_init(imu_decoder_t *dec) {
+    memset(dec, 0, sizeof(*dec));
+}
+
+imu_decode_result_t imu_decoder_decode(imu_decoder_t *dec, const uint8_t *src, size_t len,
+                                       size_t *used) {
+    const uint8_t *p = src, *end = src + len;
+    uint32_t v[IMU_CODEC_CHANNELS];
+    bool bad = false;
+
+    // Lê o registro inteiro antes de mexer no estado: se faltar byte, nada muda
+    for (int i = 0; i < IMU_CODEC_CHANNELS; i++) {
+        p = get_varint(p, end, &v[i], &bad);
+        if (!p)
+            return bad ? IMU_DECODE_ERROR : IMU_DECODE_NEED_MORE;
+        if (i == 0 && v[0] == IMU_CODEC_END_MARK) {
+            *used = (size_t)(p - src);
+            return IMU_DECODE_END;
+        }
+    }
+
+    if (v[0] & 1) { // Keyframe: o primeiro varint é o número da amostra
+        uint32_t last;
+        p = get_varint(p, end, &last, &bad);
+        if (!p)
+            return bad ? IMU_DECODE_ERROR : IMU_DECODE_NEED_MORE;
+        dec->sample = v[0] >> 1;
+        for (int i = 0; i < IMU_CODEC_CHANNELS - 1; i++)
+            dec->values[i] = (int16_t)unzigzag(v[i + 1]);
+        dec->values[IMU_CODEC_CHANNELS - 1] = (int16_t)unzigzag(last);
+        dec->synced = true;
+    } else {
+        if (!dec->synced)
+            return IMU_DECODE_ERROR;
+        dec->sample++;
+        dec->values[0] = (int16_t)(dec->values[0] + unzigzag(v[0] >> 1));
+        for (int i = 1; i < IMU_CODEC_CHANNELS; i++)
+            dec->values[i] = (int16_t)(dec->values[i] + unzigzag(v[i]));
+    }
+    *used = (size_t)(p - src);
+    return IMU_DECODE_SAMPLE;
+}
@@ -0,0 +1,95 @@
+#ifndef IMU_CODEC_H
+#define IMU_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Codificação compacta das amostras do MPU6050 (formato .imu).
+//
+// Amostras consecutivas diferem pouco, então cada canal é gravado como a
+// diferença para a amostra anterior, em zigzag + varint (1 byte para
+// |delta| < 64). A cada IMU_CODEC_KEYFRAME amostras (ou quando forçado) vai um
+// keyframe com os valores absolutos, para o leitor poder começar dali.
+//
+// Cabeçalho do arquivo (10 bytes + texto):
+//   "IMUZ" | versão (u8) | canais (u8) | intervalo de keyframe (u16 LE) |
+//   tamanho do texto (u16 LE) | texto "# chave=valor\n" (lib/log_meta.h)
+// Registro:
+//   varint(sample << 1 | 1), 6 x varint(zigzag(valor))          keyframe
+//   varint(zigzag(delta0) << 1), 5 x varint(zigzag(delta))      delta
+//   varint(0xFFFFFFFF) | tamanho (u16 LE) | texto                fim (trailer)
+// No registro delta o número da amostra é o anterior + 1. A versão 1 não tem
+// o texto no cabeçalho nem o registro de fim.
+//
+// Código portátil (sem dependências do SDK): também compila no host.
+
+#define IMU_CODEC_MAGIC "IMUZ"
+#define IMU_CODEC_VERSION 2
+#define IMU_CODEC_CHANNELS 6 // AccelX..Z, GyroX..Z
+#define IMU_CODEC_HEADER_SIZE 10 // Sem o texto
+#define IMU_CODEC_END_MARK 0xFFFFFFFFu // Keyframe da amostra 0x7FFFFFFF, reservado
+#define IMU_CODEC_TRAILER_SIZE 7   // Sem o texto
+
+#ifndef IMU_CODEC_KEYFRAME
+#define IMU_CODEC_KEYFRAME 256
+#endif
+
+// Pior caso de um registro: keyframe com sample de 32 bits e canais extremos
+#define IMU_CODEC_MAX_RECORD (5 + IMU_CODEC_CHANNELS * 3)
+
+typedef struct {
+    uint16_t keyframe_interval;
+    uint16_t since_keyframe; // Registros desde o último keyframe
+    uint32_t sample;         // Número da última amostra codificada
+    int16_t prev[IMU_CODEC_CHANNELS];
+} imu_encoder_t;
+
+void imu_encoder_init(imu_encoder_t *enc, uint16_t keyframe_interval);
+
+// O próximo registro será um keyframe (ex.: início de um bloco)
+void imu_encoder_force_keyframe(imu_encoder_t *enc);
+
+// Escreve o cabeçalho do arquivo com o texto de metadados em dst
+// (IMU_CODEC_HEADER_SIZE + text_len bytes)
+size_t imu_codec_write_header(const imu_encoder_t *enc, uint8_t *dst,
+                              const char *text, uint16_t text_len);
+
+// Escreve o registro de fim com o texto do trailer
+// (IMU_CODEC_TRAILER_SIZE + text_len bytes)
+size_t imu_codec_write_trailer(uint8_t *dst, const char *text, uint16_t text_len);
+
+// Codifica uma amostra em dst (até IMU_CODEC_MAX_RECORD bytes) e retorna o
+// tamanho. Se sample não for o anterior + 1, sai um keyframe.
+size_t imu_encoder_encode(imu_encoder_t *enc, uint32_t sample,
+                          const int16_t values[IMU_CODEC_CHANNELS], uint8_t *dst);
+
+// --- Decodificação (ferramentas do host) ---
+
+typedef struct {
+    bool synced; // Já viu um keyframe
+    uint32_t sample;
+    int16_t values[IMU_CODEC_CHANNELS];
+} imu_decoder_t;
+
+typedef enum {
+    IMU_DECODE_SAMPLE,    // Registro decodificado em dec->sample / dec->values
+    IMU_DECODE_END,       // Registro de fim: o texto do trailer vem em seguida
+    IMU_DECODE_NEED_MORE, // Registro incompleto: chamar de novo com mais bytes
+    IMU_DECODE_ERROR      // Delta antes do primeiro keyframe ou varint inválido
+} imu_decode_result_t;
+
+// Lê o cabeçalho de src[0..len). Retorna o tamanho total do cabeçalho (com o
+// texto), 0 se faltam bytes ou -1 se não é um .imu suportado (versões 1 e 2).
+// text/text_len (podem ser NULL) apontam para o texto de metadados em src.
+int32_t imu_codec_read_header(const uint8_t *src, size_t len, uint16_t *keyframe_interval,
+                              const char **text, uint16_t *text_len);
+
+// O próximo registro precisa ser um keyframe (ex.: depois de um bloco perdido)
+void imu_decoder_init(imu_decoder_t *dec);
+
+// Decodifica um registro de src[0..len); *used recebe os bytes consumidos
+imu_decode_result_t imu_decoder_decode(imu_decoder_t *dec, const uint8_t *src, size_t len,
+                                       size_t *used);
+
+#endif
@@ -0,0 +1,115 @@
+#include <string.h>
+
+#include "led_pattern.h"
+
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+static uint led_pins[3];
+static repeating_timer_t led_timer;
+
+// Lidos pelo timer: alterados com as interrupções desligadas
+static led_pattern_t base, flash;
+static uint32_t base_tick, flash_tick;
+static bool flash_active;
+
+static volatile bool activity_pending;
+static uint32_t activity_ticks;
+
+static bool same_pattern(const led_pattern_t *a, const led_pattern_t *b) {
+    return a->mode == b->mode && a->r == b->r && a->g == b->g && a->b == b->b &&
+           a->period_ms == b->period_ms && a->count == b->count;
+}
+
+static uint32_t period_ticks(const led_pattern_t *p) {
+    uint32_t ticks = p->period_ms / LED_PATTERN_TICK_MS;
+    return ticks >= 2 ? ticks : 2;
+}
+
+// Brilho (0..255) do padrão no tick dado
+static uint32_t pattern_level(const led_pattern_t *p, uint32_t tick) {
+    uint32_t period = period_ticks(p);
+    uint32_t phase = tick % period;
+    uint32_t half = period / 2;
+    switch (p->mode) {
+    case LED_SOLID:
+        return 255;
+    case LED_BLINK:
+        return phase < half ? 255 : 0;
+    case LED_PULSE:
+        return phase < half ? phase * 255 / half : (period - phase) * 255 / (period - half);
+    default:
+        return 0;
+    }
+}
+
+// Quadrado do brilho no nível do PWM: a rampa do PULSE parece linear ao olho
+static void led_write(const led_pattern_t *p, uint32_t level) {
+    const uint8_t rgb[3] = {p->r, p->g, p->b};
+    for (int i = 0; i < 3; i++) {
+        uint32_t v = rgb[i] * level / 255;
+        pwm_set_gpio_level(led_pins[i], (uint16_t)(v * v));
+    }
+}
+
+static bool led_tick(repeating_timer_t *rt) {
+    (void)rt;
+    if (activity_pending) {
+        activity_pending = false;
+        activity_ticks = (LED_PATTERN_ACTIVITY_MS + LED_PATTERN_TICK_MS - 1) / LED_PATTERN_TICK_MS;
+    }
+    if (activity_ticks) {
+        static const led_pattern_t blue = {LED_SOLID, 0, 0, 255, 0, 0};
+        activity_ticks--;
+        led_write(&blue, 255);
+    } else if (flash_active && flash_tick < period_ticks(&flash) * flash.count) {
+        led_write(&flash, pattern_level(&flash, flash_tick));
+    } else {
+        flash_active = false;
+        led_write(&base, pattern_level(&base, base_tick));
+    }
+    // As fases correm mesmo escondidas, para a base não dar um salto
+    base_tick++;
+    flash_tick++;
+    return true;
+}
+
+void led_pattern_init(uint r_pin, uint g_pin, uint b_pin) {
+    led_pins[0] = r_pin;
+    led_pins[1] = g_pin;
+    led_pins[2] = b_pin;
+    memset(&base, 0, sizeof(base));
+    flash_active = false;
+    activity_pending = false;
+    activity_ticks = 0;
+    for (int i = 0; i < 3; i++) {
+        uint slice = pwm_gpio_to_slice_num(led_pins[i]);
+        gpio_set_function(led_pins[i], GPIO_FUNC_PWM);
+        pwm_set_wrap(slice, 0xFFFF); // ~1,9 kHz a 125 MHz, sem cintilação
+        pwm_set_gpio_level(led_pins[i], 0);
+        pwm_set_enabled(slice, true);
+    }
+    // Negativo: intervalo entre os inícios das chamadas, sem deriva
+    add_repeating_timer_ms(-LED_PATTERN_TICK_MS, led_tick, NULL, &led_timer);
+}
+
+void led_pattern_set(const led_pattern_t *pattern) {
+    uint32_t irq = save_and_disable_interrupts();
+    if (!same_pattern(&base, pattern)) {
+        base = *pattern;
+        base_tick = 0;
+    }
+    restore_interrupts(irq);
+}
+
+void led_pattern_flash(const led_pattern_t *pattern) {
+    uint32_t irq = save_and_disable_interrupts();
+    flash = *pattern;
+    flash_tick = 0;
+    flash_active = true;
+    restore_interrupts(irq);
+}
+
+void led_pattern_activity(void) {
+    activity_pending = true;
+}
@@ -0,0 +1,49 @@
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+#include <stdint.h>
+
+#include "pico/stdlib.h"
+
+// LED RGB por PWM com padrões tocados por um timer repetitivo: quem muda de
+// estado só escolhe o padrão, sem sleep_ms nem tarefa acendendo e apagando.
+//
+// Prioridade na saída: atividade no cartão (led_pattern_activity), depois um
+// lampejo temporário (led_pattern_flash) e por fim o padrão de base.
+
+#ifndef LED_PATTERN_TICK_MS
+#define LED_PATTERN_TICK_MS 10
+#endif
+
+#ifndef LED_PATTERN_ACTIVITY_MS
+#define LED_PATTERN_ACTIVITY_MS 30 // Azul a cada escrita no cartão
+#endif
+
+typedef enum {
+    LED_OFF,
+    LED_SOLID,
+    LED_BLINK, // Aceso na primeira metade do período
+    LED_PULSE, // Brilho sobe e desce (triangular) ao longo do período
+} led_mode_t;
+
+typedef struct {
+    led_mode_t mode;
+    uint8_t r, g, b;    // Brilho de cada cor, 0..255
+    uint16_t period_ms; // BLINK e PULSE
+    uint8_t count;      // Ciclos de um lampejo (led_pattern_flash)
+} led_pattern_t;
+
+// Configura os pinos em PWM (apagados) e liga o timer
+void led_pattern_init(uint r_pin, uint g_pin, uint b_pin);
+
+// Padrão de base; não reinicia a fase se for o mesmo que já está tocando
+void led_pattern_set(const led_pattern_t *pattern);
+
+// Toca pattern->count ciclos por cima da base e volta a ela
+void led_pattern_flash(const led_pattern_t *pattern);
+
+// Gancho do caminho de escrita: só marca a atividade (sem tocar no hardware),
+// o timer acende o azul por LED_PATTERN_ACTIVITY_MS
+void led_pattern_activity(void);
+
+#endif
@@ -0,0 +1,62 @@
+#include <string.h>
+
+#include "log_index.h"
+
+static void put_le(uint8_t *p, uint64_t v, int n) {
+    for (int i = 0; i < n; i++, v >>= 8)
+        p[i] = (uint8_t)v;
+}
+
+static FRESULT log_index_flush(log_index_t *idx) {
+    if (idx->error != FR_OK || idx->len == 0)
+        return idx->error;
+    UINT bw;
+    FRESULT fr = f_write(&idx->file, idx->buf, idx->len, &bw);
+    if (fr == FR_OK && bw != idx->len)
+        fr = FR_DENIED;
+    idx->len = 0;
+    idx->error = fr;
+    return fr;
+}
+
+FRESULT log_index_open(log_index_t *idx, const char *filename, log_index_kind_t kind,
+                       uint16_t interval) {
+    idx->open = false;
+    idx->len = 0;
+    idx->entries = 0;
+    idx->interval = interval;
+    idx->error = f_open(&idx->file, filename, FA_WRITE | FA_CREATE_ALWAYS);
+    if (idx->error != FR_OK)
+        return idx->error;
+    idx->open = true;
+
+    memset(idx->buf, 0, LOG_INDEX_ENTRY_SIZE);
+    memcpy(idx->buf, LOG_INDEX_MAGIC, 4);
+    idx->buf[4] = (uint8_t)kind;
+    put_le(idx->buf + 6, interval, 2);
+    idx->len = LOG_INDEX_ENTRY_SIZE;
+    return FR_OK;
+}
+
+FRESULT log_index_add(log_index_t *idx, uint32_t sample, uint32_t time_ms, uint64_t offset) {
+    if (!idx->open || idx->error != FR_OK)
+        return idx->error; // Depois de um erro de escrita o setor não é mais esvaziado
+    uint8_t *p = idx->buf + idx->len;
+    put_le(p, sample, 4);
+    put_le(p + 4, time_ms, 4);
+    put_le(p + 8, offset, 8);
+    idx->len += LOG_INDEX_ENTRY_SIZE;
+    idx->entries++;
+    if (idx->len == sizeof(idx->buf))
+        return log_index_flush(idx); // Setor cheio: uma escrita alinhada
+    return idx->error;
+}
+
+FRESULT log_index_close(log_index_t *idx) {
+    if (!idx->open)
+        return FR_OK;
+    FRESULT fr = log_index_flush(idx);
+    FRESULT fr_close = f_close(&idx->file);
+    idx->open = false;
+    return fr != FR_OK ? fr : fr_close;
+}
@@ -0,0 +1,58 @@
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+
+// Índice do log (log_NNN.idx): liga número da amostra / tempo ao offset no
+// arquivo de dados, para as ferramentas do host lerem só uma janela.
+//
+// As entradas são acumuladas em um setor na RAM e gravadas 512 bytes por vez,
+// em arquivo separado: o arquivo de dados nunca sofre seek.
+//
+// Cabeçalho (16 bytes, little-endian):
+//   "IDX1" | tipo (u8: 0 csv, 1 imu, 2 lzb) | reservado (u8) |
+//   intervalo em amostras (u16; 0 = uma entrada por bloco) | reservado (u64)
+// Entrada (16 bytes):
+//   amostra (u32) | tempo desde o início em ms (u32) | offset (u64)
+// No .imu o offset aponta para um keyframe; no .lzb, para o início do bloco.
+
+#define LOG_INDEX_MAGIC "IDX1"
+#define LOG_INDEX_ENTRY_SIZE 16
+
+#ifndef LOG_INDEX_INTERVAL
+#define LOG_INDEX_INTERVAL 256 // Amostras entre entradas (csv/imu)
+#endif
+
+typedef enum {
+    LOG_INDEX_CSV = 0,
+    LOG_INDEX_IMU = 1,
+    LOG_INDEX_LZB = 2
+} log_index_kind_t;
+
+typedef struct {
+    FIL file;
+    bool open;
+    uint16_t interval;
+    uint16_t len;     // Bytes pendentes em buf
+    uint32_t entries;
+    FRESULT error;
+    uint8_t buf[512];
+} log_index_t;
+
+FRESULT log_index_open(log_index_t *idx, const char *filename, log_index_kind_t kind,
+                       uint16_t interval);
+
+// true se a amostra deve ganhar uma entrada (múltiplo do intervalo)
+static inline bool log_index_due(const log_index_t *idx, uint32_t sample) {
+    return idx->open && idx->interval && sample % idx->interval == 0;
+}
+
+FRESULT log_index_add(log_index_t *idx, uint32_t sample, uint32_t time_ms, uint64_t offset);
+
+// Grava o setor parcial e fecha o arquivo
+FRESULT log_index_close(log_index_t *idx);
+
+#endif
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "log_meta.h"
+
+// Sensibilidade nominal do MPU6050 (datasheet, tabelas 6.1 e 6.2)
+static uint32_t accel_lsb_per_g(uint8_t fs_g) {
+    return fs_g ? 32768u / fs_g : 0;
+}
+
+static const char *gyro_lsb_per_dps(uint16_t fs_dps) {
+    switch (fs_dps) {
+    case 250: return "131";
+    case 500: return "65.5";
+    case 1000: return "32.8";
+    case 2000: return "16.4";
+    default: return "0";
+    }
+}
+
+// Temperatura em °C com duas casas: raw / 340 + 36.53 (datasheet, seção 4.18)
+static int format_temp(char *dst, size_t cap, int16_t raw) {
+    int32_t centi = (int32_t)raw * 100 / 340 + 3653;
+    const char *sign = centi < 0 ? "-" : "";
+    if (centi < 0)
+        centi = -centi;
+    return snprintf(dst, cap, "%s%ld.%02ld", sign, (long)(centi / 100), (long)(centi % 100));
+}
+
+// Acrescenta "# chave=valor\n" em dst, sem passar de LOG_META_MAX_SIZE
+static size_t put_line(char *dst, size_t len, const char *key, const char *value) {
+    int n = snprintf(dst + len, LOG_META_MAX_SIZE - len, "# %s=%s\n", key, value);
+    if (n < 0 || len + (size_t)n >= LOG_META_MAX_SIZE)
+        return len;
+    return len + (size_t)n;
+}
+
+static size_t put_uint(char *dst, size_t len, const char *key, uint32_t value) {
+    char text[12];
+    snprintf(text, sizeof(text), "%lu", (unsigned long)value);
+    return put_line(dst, len, key, text);
+}
+
+size_t log_meta_format_header(char *dst, const log_meta_header_t *meta) {
+    char text[16];
+    size_t len = 0;
+    len = put_uint(dst, len, "meta_version", LOG_META_VERSION);
+    len = put_line(dst, len, "firmware", meta->firmware);
+    len = put_line(dst, len, "profile", meta->profile);
+    len = put_line(dst, len, "format", meta->format);
+    len = put_line(dst, len, "compression", meta->compressed ? "lzb" : "none");
+    len = put_line(dst, len, "file", meta->file);
+    len = put_uint(dst, len, "period_ms", meta->period_ms);
+    len = put_uint(dst, len, "accel_fs_g", meta->accel_fs_g);
+    len = put_uint(dst, len, "accel_lsb_per_g", accel_lsb_per_g(meta->accel_fs_g));
+    len = put_uint(dst, len, "gyro_fs_dps", meta->gyro_fs_dps);
+    len = put_line(dst, len, "gyro_lsb_per_dps", gyro_lsb_per_dps(meta->gyro_fs_dps));
+    format_temp(text, sizeof(text), meta->temp_raw);
+    len = put_line(dst, len, "temp_start_c", text);
+    len = put_uint(dst, len, "uptime_ms", meta->uptime_ms);
+    return len;
+}
+
+size_t log_meta_format_trailer(char *dst, const log_meta_trailer_t *meta) {
+    char text[16];
+    size_t len = 0;
+    len = put_uint(dst, len, "samples", meta->samples);
+    len = put_uint(dst, len, "duration_ms", meta->duration_ms);
+    format_temp(text, sizeof(text), meta->temp_raw);
+    len = put_line(dst, len, "temp_end_c", text);
+    len = put_uint(dst, len, "encode_ns_per_sample", meta->encode_ns_per_sample);
+    len = put_line(dst, len, "stop", meta->stop);
+    return len;
+}
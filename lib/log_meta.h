@@ -0,0 +1,48 @@
+#ifndef LOG_META_H
+#define LOG_META_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Metadados da sessão gravados no próprio log, para o host converter as
+// amostras direto para g e °/s sem arquivos externos.
+//
+// Texto em linhas "# chave=valor\n". No CSV as linhas vão logo depois da linha
+// de colunas (np.loadtxt(..., skiprows=1) ignora os comentários '#') e o
+// trailer vai no fim do arquivo. No .imu o mesmo texto vai no cabeçalho e no
+// registro de fim (lib/imu_codec.h).
+//
+// Código portátil (sem dependências do SDK): também compila no host.
+
+#define LOG_META_VERSION 1
+#define LOG_META_MAX_SIZE 512 // Maior cabeçalho ou trailer gerado
+
+// Configuração da sessão, conhecida na abertura do arquivo
+typedef struct {
+    const char *firmware; // Versão do firmware
+    const char *profile;  // Perfil de memória (DATALOGGER_PROFILE)
+    const char *format;   // "csv" ou "delta"
+    const char *file;     // Nome do arquivo de log
+    uint8_t compressed;   // Blocos .lzb comprimidos (lz_block); enquadrados sem compressão: 0
+    uint16_t period_ms;   // Intervalo nominal entre amostras
+    uint8_t accel_fs_g;   // Fundo de escala do acelerômetro: 2, 4, 8 ou 16 g
+    uint16_t gyro_fs_dps; // Fundo de escala do giroscópio: 250, 500, 1000 ou 2000 °/s
+    int16_t temp_raw;     // Leitura bruta de temperatura do MPU6050 no início
+    uint32_t uptime_ms;   // Tempo desde o boot no início da gravação
+} log_meta_header_t;
+
+// Resumo gravado ao fechar o arquivo
+typedef struct {
+    uint32_t samples;
+    uint32_t duration_ms;
+    int16_t temp_raw; // Temperatura no fim
+    uint32_t encode_ns_per_sample;
+    const char *stop; // Motivo do fim: "botao", "cartao_cheio", ...
+} log_meta_trailer_t;
+
+// Escrevem o texto em dst (até LOG_META_MAX_SIZE bytes, sem '\0') e retornam o
+// tamanho
+size_t log_meta_format_header(char *dst, const log_meta_header_t *meta);
+size_t log_meta_format_trailer(char *dst, const log_meta_trailer_t *meta);
+
+#endif
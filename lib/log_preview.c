@@ -0,0 +1,139 @@
+#include <string.h>
+
+#include "log_preview.h"
+
+static void put_le(uint8_t *p, uint32_t v, int n) {
+    for (int i = 0; i < n; i++, v >>= 8)
+        p[i] = (uint8_t)v;
+}
+
+static FRESULT log_preview_flush(log_preview_t *pv) {
+    if (pv->error != FR_OK || pv->len == 0)
+        return pv->error;
+    UINT bw;
+    FRESULT fr = f_write(&pv->file, pv->buf, pv->len, &bw);
+    if (fr == FR_OK && bw != pv->len)
+        fr = FR_DENIED;
+    pv->len = 0;
+    pv->error = fr;
+    return fr;
+}
+
+// Acrescenta bytes ao setor em RAM; a entrada pode ficar dividida entre dois setores
+static void log_preview_append(log_preview_t *pv, const uint8_t *src, uint16_t n) {
+    while (n > 0 && pv->error == FR_OK) {
+        uint16_t chunk = (uint16_t)sizeof(pv->buf) - pv->len;
+        if (chunk > n)
+            chunk = n;
+        memcpy(pv->buf + pv->len, src, chunk);
+        pv->len += chunk;
+        src += chunk;
+        n -= chunk;
+        if (pv->len == sizeof(pv->buf))
+            log_preview_flush(pv);
+    }
+}
+
+static void level_reset(log_preview_level_t *lv) {
+    lv->count = 0;
+    lv->samples = 0;
+    for (int c = 0; c < LOG_PREVIEW_CHANNELS; c++) {
+        lv->min[c] = INT16_MAX;
+        lv->max[c] = INT16_MIN;
+        lv->sum[c] = 0;
+    }
+}
+
+// Grava o agregado do nível l, soma-o ao nível seguinte e recomeça
+static void level_emit(log_preview_t *pv, int l) {
+    log_preview_level_t *lv = &pv->level[l];
+    uint8_t e[LOG_PREVIEW_ENTRY_SIZE];
+    e[0] = (uint8_t)(l + 1);
+    e[1] = 0;
+    put_le(e + 2, lv->samples, 2);
+    put_le(e + 4, lv->first_sample, 4);
+    put_le(e + 8, lv->first_ms, 4);
+    for (int c = 0; c < LOG_PREVIEW_CHANNELS; c++) {
+        put_le(e + 12 + 2 * c, (uint16_t)lv->min[c], 2);
+        put_le(e + 24 + 2 * c, (uint16_t)lv->max[c], 2);
+        put_le(e + 36 + 2 * c, (uint16_t)(int16_t)(lv->sum[c] / (int32_t)lv->samples), 2);
+    }
+    log_preview_append(pv, e, sizeof(e));
+    pv->entries++;
+
+    if (l + 1 < LOG_PREVIEW_LEVELS) {
+        log_preview_level_t *up = &pv->level[l + 1];
+        if (up->count == 0) {
+            up->first_sample = lv->first_sample;
+            up->first_ms = lv->first_ms;
+        }
+        for (int c = 0; c < LOG_PREVIEW_CHANNELS; c++) {
+            if (lv->min[c] < up->min[c])
+                up->min[c] = lv->min[c];
+            if (lv->max[c] > up->max[c])
+                up->max[c] = lv->max[c];
+            up->sum[c] += lv->sum[c];
+        }
+        up->samples += lv->samples;
+        if (++up->count == LOG_PREVIEW_FACTOR)
+            level_emit(pv, l + 1);
+    }
+    level_reset(lv);
+}
+
+FRESULT log_preview_open(log_preview_t *pv, const char *filename) {
+    pv->open = false;
+    pv->len = 0;
+    pv->entries = 0;
+    for (int l = 0; l < LOG_PREVIEW_LEVELS; l++)
+        level_reset(&pv->level[l]);
+    pv->error = f_open(&pv->file, filename, FA_WRITE | FA_CREATE_ALWAYS);
+    if (pv->error != FR_OK)
+        return pv->error;
+    pv->open = true;
+
+    memset(pv->buf, 0, LOG_PREVIEW_HEADER_SIZE);
+    memcpy(pv->buf, LOG_PREVIEW_MAGIC, 4);
+    pv->buf[4] = LOG_PREVIEW_LEVELS;
+    pv->buf[5] = LOG_PREVIEW_CHANNELS;
+    put_le(pv->buf + 6, LOG_PREVIEW_FACTOR, 2);
+    put_le(pv->buf + 8, LOG_PREVIEW_ENTRY_SIZE, 2);
+    pv->len = LOG_PREVIEW_HEADER_SIZE;
+    return FR_OK;
+}
+
+void log_preview_add(log_preview_t *pv, uint32_t sample, uint32_t time_ms,
+                     const int16_t values[LOG_PREVIEW_CHANNELS]) {
+    if (!pv->open)
+        return;
+    log_preview_level_t *lv = &pv->level[0];
+    if (lv->count == 0) {
+        lv->first_sample = sample;
+        lv->first_ms = time_ms;
+    }
+    for (int c = 0; c < LOG_PREVIEW_CHANNELS; c++) {
+        int16_t v = values[c];
+        if (v < lv->min[c])
+            lv->min[c] = v;
+        if (v > lv->max[c])
+            lv->max[c] = v;
+        lv->sum[c] += v;
+    }
+    lv->samples++;
+    if (++lv->count == LOG_PREVIEW_FACTOR)
+        level_emit(pv, 0);
+}
+
+FRESULT log_preview_close(log_preview_t *pv) {
+    if (!pv->open)
+        return FR_OK;
+    // Agregados incompletos, do nível 1 para cima: cada um entra no seguinte
+    for (int l = 0; l < LOG_PREVIEW_LEVELS; l++) {
+        if (pv->level[l].count > 0)
+            level_emit(pv, l);
+    }
+    FRESULT fr = log_preview_flush(pv);
+    FRESULT fr_close = f_close(&pv->file);
+    pv->open = false;
+    return fr != FR_OK ? fr : fr_close;
+}
@@ -0,0 +1,70 @@
+#ifndef LOG_PREVIEW_H
+#define LOG_PREVIEW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+
+// Prévia em várias resoluções do log (log_NNN.pvw): mínimo, máximo e média
+// de cada canal a cada 16, 256 e 4096 amostras, para as ferramentas do host
+// desenharem uma sessão inteira sem ler o log.
+//
+// Cada amostra atualiza só o agregado do nível 1; quando ele fecha, o
+// resultado é gravado e somado ao nível seguinte (O(1) amortizado por
+// amostra). As entradas dos níveis saem intercaladas, na ordem em que fecham,
+// e vão para o cartão 512 bytes por vez, como o índice (lib/log_index.h).
+//
+// Cabeçalho (16 bytes, little-endian):
+//   "PVW1" | níveis (u8) | canais (u8) | fator entre níveis (u16) |
+//   tamanho da entrada (u16) | reservado (6 bytes)
+// Entrada (48 bytes):
+//   nível (u8, 1 = 1:16) | reservado (u8) | amostras agregadas (u16) |
+//   primeira amostra (u32) | tempo da primeira amostra em ms (u32) |
+//   mínimo (6 x i16) | máximo (6 x i16) | média (6 x i16)
+// No fechamento os agregados incompletos também são gravados (com menos
+// amostras), para o fim da sessão aparecer na prévia.
+
+#define LOG_PREVIEW_MAGIC "PVW1"
+#define LOG_PREVIEW_HEADER_SIZE 16
+#define LOG_PREVIEW_ENTRY_SIZE 48
+#define LOG_PREVIEW_CHANNELS 6
+#define LOG_PREVIEW_LEVELS 3 // 1:16, 1:256, 1:4096
+#define LOG_PREVIEW_FACTOR 16
+
+typedef struct {
+    uint32_t first_sample;
+    uint32_t first_ms;
+    uint16_t count; // Amostras (nível 1) ou entradas do nível anterior
+    uint32_t samples;
+    int16_t min[LOG_PREVIEW_CHANNELS];
+    int16_t max[LOG_PREVIEW_CHANNELS];
+    int32_t sum[LOG_PREVIEW_CHANNELS]; // Cabe em 32 bits: 4096 x 32768
+} log_preview_level_t;
+
+typedef struct {
+    FIL file;
+    bool open;
+    uint16_t len; // Bytes pendentes em buf
+    uint32_t entries;
+    FRESULT error;
+    log_preview_level_t level[LOG_PREVIEW_LEVELS];
+    uint8_t buf[512];
+} log_preview_t;
+
+FRESULT log_preview_open(log_preview_t *pv, const char *filename);
+
+// true se a próxima amostra começa um agregado (o chamador só precisa medir o
+// tempo nesse caso)
+static inline bool log_preview_needs_time(const log_preview_t *pv) {
+    return pv->open && pv->level[0].count == 0;
+}
+
+// Soma uma amostra à prévia. time_ms só é usado quando log_preview_needs_time()
+void log_preview_add(log_preview_t *pv, uint32_t sample, uint32_t time_ms,
+                     const int16_t values[LOG_PREVIEW_CHANNELS]);
+
+// Grava os agregados incompletos e o setor parcial e fecha o arquivo
+FRESULT log_preview_close(log_preview_t *pv);
+
+#endif
@@ -0,0 +1,73 @@
+#include <string.h>
+
+#include "log_writer.h"
+
+void log_writer_init(log_writer_t *w, FIL *file) {
+    w->file = file;
+    w->len = 0;
+    w->total = 0;
+    w->error = FR_OK;
+    w->on_write = NULL;
+}
+
+// Grava os primeiros n bytes do buffer e traz o resto para o início
+static FRESULT write_out(log_writer_t *w, uint32_t n) {
+    if (w->error != FR_OK)
+        return w->error;
+    if (n == 0)
+        return FR_OK;
+
+    if (w->on_write)
+        w->on_write();
+    UINT bw;
+    FRESULT fr = f_write(w->file, w->buf, n, &bw);
+    if (fr == FR_OK && bw != n)
+        fr = FR_DENIED; // Volume cheio
+    w->error = fr;
+    if (fr != FR_OK) {
+        w->len = 0;
+        return fr;
+    }
+    w->len -= n;
+    memmove(w->buf, w->buf + n, w->len); // Menos de um setor
+    return FR_OK;
+}
+
+FRESULT log_writer_flush_sectors(log_writer_t *w) {
+    return write_out(w, w->len & ~(uint32_t)(LOG_WRITER_SECTOR_SIZE - 1));
+}
+
+FRESULT log_writer_flush(log_writer_t *w) {
+    return write_out(w, w->len);
+}
+
+uint8_t *log_writer_reserve(log_writer_t *w, uint32_t n) {
+    if (w->len + n > LOG_WRITER_BUFFER_SIZE && log_writer_flush_sectors(w) != FR_OK)
+        return NULL;
+    if (w->len + n > LOG_WRITER_BUFFER_SIZE)
+        return NULL; // n > LOG_WRITER_MAX_RESERVE
+    return w->buf + w->len;
+}
+
+void log_writer_commit(log_writer_t *w, uint32_t n) {
+    w->len += n;
+    w->total += n;
+    if (w->len == LOG_WRITER_BUFFER_SIZE)
+        log_writer_flush_sectors(w); // Buffer cheio: setores inteiros, sem sobra
+}
+
+FRESULT log_writer_write(log_writer_t *w, const void *data, uint32_t len) {
+    const uint8_t *p = data;
+    while (len) {
+        uint32_t chunk = LOG_WRITER_BUFFER_SIZE - w->len;
+        if (chunk > len)
+            chunk = len;
+        memcpy(w->buf + w->len, p, chunk);
+        log_writer_commit(w, chunk);
+        if (w->error != FR_OK)
+            return w->error;
+        p += chunk;
+        len -= chunk;
+    }
+    return w->error;
+}
@@ -0,0 +1,58 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <stdint.h>
+
+#include "ff.h"
+
+// Agrupa as escritas do log e só chama f_write com setores inteiros (512 B)
+// durante a sessão. Os registros (CSV, .imu) têm tamanho variável: o pedaço
+// de setor que sobra fica no início do buffer e sai com a escrita seguinte.
+// Com o arquivo sempre alinhado, o FatFs escreve direto do buffer para o
+// cartão (multi-block write) e nunca regrava nem relê um setor parcial (com
+// FF_FS_TINY=1 essa releitura passaria pela janela fs->win, a mesma do .idx
+// e do .pvw). Só log_writer_flush(), no fechamento, grava o setor parcial.
+
+#define LOG_WRITER_SECTOR_SIZE 512
+
+#ifndef LOG_WRITER_BUFFER_SIZE
+#define LOG_WRITER_BUFFER_SIZE 4096 // Múltiplo de LOG_WRITER_SECTOR_SIZE
+#endif
+#if LOG_WRITER_BUFFER_SIZE % LOG_WRITER_SECTOR_SIZE
+#error "LOG_WRITER_BUFFER_SIZE precisa ser multiplo de 512"
+#endif
+
+// Maior n de log_writer_reserve(): depois da descarga sobra até um setor
+// menos um byte no buffer
+#define LOG_WRITER_MAX_RESERVE (LOG_WRITER_BUFFER_SIZE - LOG_WRITER_SECTOR_SIZE + 1)
+
+typedef struct {
+    FIL *file;
+    uint32_t len;   // Bytes pendentes no buffer
+    uint64_t total; // Bytes já entregues ao writer (offset lógico no arquivo)
+    FRESULT error;  // Primeiro erro de f_write (FR_OK se nenhum)
+    void (*on_write)(void); // Chamado antes de cada f_write (NULL: nenhum)
+    uint8_t buf[LOG_WRITER_BUFFER_SIZE];
+} log_writer_t;
+
+void log_writer_init(log_writer_t *w, FIL *file);
+
+// Garante n bytes contíguos livres no buffer (descarregando os setores
+// inteiros se preciso) e devolve o ponteiro para escrever neles.
+// n <= LOG_WRITER_MAX_RESERVE. Retorna NULL se a descarga falhou.
+uint8_t *log_writer_reserve(log_writer_t *w, uint32_t n);
+
+// Confirma n bytes escritos no ponteiro devolvido por log_writer_reserve
+void log_writer_commit(log_writer_t *w, uint32_t n);
+
+// Copia len bytes para o buffer (qualquer tamanho)
+FRESULT log_writer_write(log_writer_t *w, const void *data, uint32_t len);
+
+// Grava os setores inteiros do buffer; o resto fica para a próxima escrita
+FRESULT log_writer_flush_sectors(log_writer_t *w);
+
+// Descarrega o buffer inteiro com f_write, setor parcial incluído (não chama
+// f_sync). Só no fechamento: depois dela o arquivo deixa de estar alinhado.
+FRESULT log_writer_flush(log_writer_t *w);
+
+#endif
@@ -0,0 +1,139 @@
+#include <string.h>
+
+#include "lz_block.h"
+
+#define MIN_MATCH 4
+#define LAST_LITERALS 5 // Os últimos 5 bytes são sempre literais
+#define MF_LIMIT 12     // Um match não pode começar nos últimos 12 bytes
+#define MAX_OFFSET 65535u
+
+// Leitura byte a byte: o M0+ não faz acesso desalinhado
+static inline uint32_t read32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t hash32(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_BLOCK_HASH_LOG);
+}
+
+// Comprimento em 4 bits no token + bytes de extensão (255, 255, ..., resto)
+static inline uint8_t *put_length(uint8_t *op, size_t len) {
+    for (len -= 15; len >= 255; len -= 255)
+        *op++ = 255;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+size_t lz_block_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t dst_cap,
+                         uint16_t *hash_table) {
+    if (n > LZ_BLOCK_MAX_INPUT)
+        return 0;
+
+    uint8_t *op = dst;
+    uint8_t *const op_end = dst + dst_cap;
+    size_t anchor = 0;
+
+    if (n > MF_LIMIT) {
+        const size_t match_limit = n - LAST_LITERALS;
+        const size_t ip_limit = n - MF_LIMIT;
+        size_t ip = 0;
+
+        // Entradas antigas só geram candidatos falsos, descartados na comparação
+        memset(hash_table, 0, LZ_BLOCK_HASH_SIZE * sizeof(uint16_t));
+
+        while (ip < ip_limit) {
+            uint32_t seq = read32(src + ip);
+            uint32_t h = hash32(seq);
+            size_t ref = hash_table[h];
+            hash_table[h] = (uint16_t)ip;
+            if (ref >= ip || ip - ref > MAX_OFFSET || read32(src + ref) != seq) {
+                ip++;
+                continue;
+            }
+
+            size_t len = MIN_MATCH;
+            while (ip + len < match_limit && src[ref + len] == src[ip + len])
+                len++;
+
+            // Sequência: token, literais, offset, extensão do comprimento
+            size_t lit = ip - anchor;
+            if (op + 1 + lit / 255 + 1 + lit + 2 + (len - MIN_MATCH) / 255 + 1 > op_end)
+                return 0;
+            uint8_t *token = op++;
+            *token = (uint8_t)((lit >= 15 ? 15 : lit) << 4);
+            if (lit >= 15)
+                op = put_length(op, lit);
+            memcpy(op, src + anchor, lit);
+            op += lit;
+            size_t offset = ip - ref;
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            size_t ml = len - MIN_MATCH;
+            *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+            if (ml >= 15)
+                op = put_length(op, ml);
+
+            ip += len;
+            anchor = ip;
+            if (ip < ip_limit)
+                hash_table[hash32(read32(src + ip - 2))] = (uint16_t)(ip - 2);
+        }
+    }
+
+    // Últimos literais
+    size_t lit = n - anchor;
+    if (op + 1 + lit / 255 + 1 + lit > op_end)
+        return 0;
+    uint8_t *token = op++;
+    *token = (uint8_t)((lit >= 15 ? 15 : lit) << 4);
+    if (lit >= 15)
+        op = put_length(op, lit);
+    memcpy(op, src + anchor, lit);
+    op += lit;
+    return (size_t)(op - dst);
+}
+
+static inline int read_length(const uint8_t **ip, const uint8_t *ip_end, size_t *len) {
+    uint8_t b;
+    do {
+        if (*ip >= ip_end)
+            return -1;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 0;
+}
+
+int32_t lz_block_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t dst_cap) {
+    const uint8_t *ip = src, *const ip_end = src + n;
+    uint8_t *op = dst, *const op_end = dst + dst_cap;
+
+    while (ip < ip_end) {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && read_length(&ip, ip_end, &lit))
+            return -1;
+        if (lit > (size_t)(ip_end - ip) || lit > (size_t)(op_end - op))
+            return -1;
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == ip_end)
+            break; // Última sequência: só literais
+
+        if (ip_end - ip < 2)
+            return -1;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15 && read_length(&ip, ip_end, &len))
+            return -1;
+        len += MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - dst) || len > (size_t)(op_end - op))
+            return -1;
+        const uint8_t *ref = op - offset;
+        while (len--)
+            *op++ = *ref++; // Byte a byte: o match pode se sobrepor à saída
+    }
+    return (int32_t)(op - dst);
+}
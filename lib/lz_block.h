@@ -0,0 +1,31 @@
+#ifndef LZ_BLOCK_H
+#define LZ_BLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Compressor LZ de bloco no formato de bloco do LZ4 (sequências token /
+// literais / offset de 16 bits / extensão do comprimento), decodificável por
+// qualquer implementação do LZ4 block format.
+//
+// Uma única tabela hash de 4 bytes, sem cadeias: cada posição da entrada é
+// visitada uma vez, então o tempo é O(n) e limitado mesmo para dados
+// incompressíveis. Blocos de até 64 KB (posições de 16 bits na tabela).
+//
+// Código portátil (sem dependências do SDK): também compila no host.
+
+#define LZ_BLOCK_MAX_INPUT 65535u
+#define LZ_BLOCK_HASH_LOG 12
+#define LZ_BLOCK_HASH_SIZE (1u << LZ_BLOCK_HASH_LOG) // Entradas (uint16_t)
+
+// Comprime src[0..n) em dst. Retorna o tamanho comprimido, ou 0 se o
+// resultado não couber em dst_cap (o chamador grava o bloco sem compressão).
+// hash_table: área de trabalho com LZ_BLOCK_HASH_SIZE entradas.
+size_t lz_block_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t dst_cap,
+                         uint16_t *hash_table);
+
+// Descomprime; retorna o tamanho gerado ou -1 se os dados forem inválidos ou
+// não couberem em dst_cap
+int32_t lz_block_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t dst_cap);
+
+#endif
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem_pool.h"
+
+static mem_pool_t *pool_list = NULL;
+
+// Encadeia todos os blocos na lista livre (o próprio bloco guarda o ponteiro)
+static void mem_pool_setup(mem_pool_t *pool) {
+    pool->free_list = NULL;
+    for (int i = pool->block_count - 1; i >= 0; --i) {
+        void **block = (void **)(pool->storage + (size_t)i * pool->block_size);
+        *block = pool->free_list;
+        pool->free_list = block;
+    }
+    pool->next = pool_list;
+    pool_list = pool;
+    pool->ready = true;
+}
+
+static bool mem_pool_owns(const mem_pool_t *pool, const void *ptr) {
+    const uint8_t *p = ptr;
+    return p >= pool->storage &&
+           p < pool->storage + (size_t)pool->block_count * pool->block_size;
+}
+
+static void *mem_pool_fallback(mem_pool_t *pool, size_t size) {
+    if (pool->fallback != MEM_POOL_FALLBACK_HEAP)
+        return NULL;
+    void *ptr = malloc(size);
+    if (ptr)
+        pool->heap_fallbacks++;
+    return ptr;
+}
+
+void *mem_pool_alloc(mem_pool_t *pool, size_t size) {
+    if (!pool->ready)
+        mem_pool_setup(pool);
+
+    if (size > pool->block_size) {
+        pool->oversize++;
+        return mem_pool_fallback(pool, size);
+    }
+    if (!pool->free_list) {
+        pool->exhausted++;
+        return mem_pool_fallback(pool, size);
+    }
+
+    void **block = pool->free_list;
+    pool->free_list = *block;
+    pool->allocs++;
+    if (++pool->in_use > pool->peak)
+        pool->peak = pool->in_use;
+    return block;
+}
+
+void *mem_pool_calloc(mem_pool_t *pool, size_t size) {
+    void *ptr = mem_pool_alloc(pool, size);
+    if (ptr)
+        memset(ptr, 0, size);
+    return ptr;
+}
+
+void mem_pool_free(mem_pool_t *pool, void *ptr) {
+    if (!ptr)
+        return;
+    if (!mem_pool_owns(pool, ptr)) {
+        free(ptr); // Veio do heap pela política de fallback
+        return;
+    }
+    void **block = ptr;
+    *block = pool->free_list;
+    pool->free_list = block;
+    pool->in_use--;
+}
+
+void mem_pool_report_all(void) {
+    for (mem_pool_t *pool = pool_list; pool; pool = pool->next) {
+        printf("[pool %s] bloco %u B x %u: em uso %u, pico %u, alocacoes %lu, "
+               "esgotado %lu, grande demais %lu, heap %lu\n",
+               pool->name, (unsigned)pool->block_size, pool->block_count,
+               pool->in_use, pool->peak, (unsigned long)pool->allocs,
+               (unsigned long)pool->exhausted, (unsigned long)pool->oversize,
+               (unsigned long)pool->heap_fallbacks);
+    }
+}
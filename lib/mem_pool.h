@@ -0,0 +1,61 @@
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Alocador de blocos de tamanho fixo com memória estática (.bss), dimensionado
+// em tempo de compilação. Substitui malloc/calloc nos pontos que alocam durante
+// a operação (FF_FILE do ff_stdio, buffers LFN do FatFs, framebuffer do OLED),
+// evitando fragmentação e latência imprevisível do heap.
+//
+// Não é reentrante: usar apenas a partir do laço principal (core 0).
+
+// O que fazer quando o pool não atende o pedido (esgotado ou bloco pequeno)
+typedef enum {
+    MEM_POOL_FALLBACK_NONE, // Retorna NULL
+    MEM_POOL_FALLBACK_HEAP  // Recorre ao malloc (contabilizado em heap_fallbacks)
+} mem_pool_fallback_t;
+
+typedef struct mem_pool {
+    const char *name;
+    uint8_t *storage;
+    size_t block_size;
+    uint16_t block_count;
+    mem_pool_fallback_t fallback;
+
+    // Estado (montado na primeira alocação)
+    bool ready;
+    void *free_list;
+    struct mem_pool *next; // Lista de pools para o relatório
+
+    // Contadores
+    uint16_t in_use;
+    uint16_t peak;
+    uint32_t allocs;
+    uint32_t exhausted;      // Pedidos com o pool vazio
+    uint32_t oversize;       // Pedidos maiores que o bloco
+    uint32_t heap_fallbacks; // Pedidos atendidos pelo heap
+} mem_pool_t;
+
+#define MEM_POOL_WORDS(size) (((size) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+// Define um pool estático (visível só no arquivo):
+//   MEM_POOL_DEFINE(meu_pool, "nome", 512, 4, MEM_POOL_FALLBACK_HEAP);
+#define MEM_POOL_DEFINE(var, pool_name, blk_size, blk_count, policy)                   \
+    static uint32_t var##_storage[(blk_count) * MEM_POOL_WORDS(blk_size)];             \
+    static mem_pool_t var = {.name = (pool_name),                                      \
+                             .storage = (uint8_t *)var##_storage,                      \
+                             .block_size = MEM_POOL_WORDS(blk_size) * sizeof(uint32_t), \
+                             .block_count = (blk_count),                               \
+                             .fallback = (policy)}
+
+void *mem_pool_alloc(mem_pool_t *pool, size_t size);
+void *mem_pool_calloc(mem_pool_t *pool, size_t size);
+void mem_pool_free(mem_pool_t *pool, void *ptr);
+
+// Imprime os contadores de todos os pools já usados
+void mem_pool_report_all(void);
+
+#endif
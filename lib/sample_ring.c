@@ -0,0 +1,37 @@
+#include <stddef.h>
+
+#include "sample_ring.h"
+
+static void acc_reset(sample_ring_t *ring) {
+    ring->acc_samples = 0;
+    for (int c = 0; c < SAMPLE_RING_CHANNELS; c++) {
+        ring->acc.min[c] = INT16_MAX;
+        ring->acc.max[c] = INT16_MIN;
+    }
+}
+
+void sample_ring_init(sample_ring_t *ring, uint16_t decimation) {
+    ring->count = 0;
+    ring->decimation = decimation ? decimation : 1;
+    acc_reset(ring);
+}
+
+void sample_ring_push(sample_ring_t *ring, const int16_t values[SAMPLE_RING_CHANNELS]) {
+    for (int c = 0; c < SAMPLE_RING_CHANNELS; c++) {
+        if (values[c] < ring->acc.min[c])
+            ring->acc.min[c] = values[c];
+        if (values[c] > ring->acc.max[c])
+            ring->acc.max[c] = values[c];
+    }
+    if (++ring->acc_samples < ring->decimation)
+        return;
+    ring->entries[ring->count & (SAMPLE_RING_SIZE - 1)] = ring->acc;
+    ring->count++;
+    acc_reset(ring);
+}
+
+const sample_ring_entry_t *sample_ring_get(const sample_ring_t *ring, uint32_t seq) {
+    if (seq >= ring->count || seq < sample_ring_oldest(ring))
+        return NULL;
+    return &ring->entries[seq & (SAMPLE_RING_SIZE - 1)];
+}
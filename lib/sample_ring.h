@@ -0,0 +1,46 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Anel das últimas amostras da aquisição, dizimadas, para o gráfico do OLED.
+// Portátil (sem SDK).
+//
+// Cada entrada agrega `decimation` amostras seguidas: mínimo e máximo de cada
+// canal, para uma vibração mais rápida que a coluna do gráfico aparecer como
+// faixa em vez de sumir. A amostra só atualiza o agregado corrente; quando
+// ele fecha, vira a entrada de número `count` (0, 1, 2...). Quem lê guarda o
+// número da próxima entrada que quer e pede as que faltam.
+
+#define SAMPLE_RING_CHANNELS 6 // Ax, Ay, Az, Gx, Gy, Gz
+#ifndef SAMPLE_RING_SIZE
+#define SAMPLE_RING_SIZE 128 // Potência de 2, pelo menos a largura do gráfico
+#endif
+
+typedef struct {
+    int16_t min[SAMPLE_RING_CHANNELS];
+    int16_t max[SAMPLE_RING_CHANNELS];
+} sample_ring_entry_t;
+
+typedef struct {
+    sample_ring_entry_t entries[SAMPLE_RING_SIZE];
+    uint32_t count; // Entradas fechadas desde o início
+    sample_ring_entry_t acc; // Agregado em andamento
+    uint16_t acc_samples;
+    uint16_t decimation;
+} sample_ring_t;
+
+void sample_ring_init(sample_ring_t *ring, uint16_t decimation);
+
+void sample_ring_push(sample_ring_t *ring, const int16_t values[SAMPLE_RING_CHANNELS]);
+
+// Entrada de número seq, ou NULL se ainda não fechou ou já foi sobrescrita
+const sample_ring_entry_t *sample_ring_get(const sample_ring_t *ring, uint32_t seq);
+
+// Número da entrada mais antiga ainda no anel
+static inline uint32_t sample_ring_oldest(const sample_ring_t *ring) {
+    return ring->count > SAMPLE_RING_SIZE ? ring->count - SAMPLE_RING_SIZE : 0;
+}
+
+#endif
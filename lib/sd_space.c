@@ -0,0 +1,65 @@
+#include "sd_space.h"
+
+#include "pico/time.h"
+
+static FATFS *space_fs = NULL;
+static uint64_t session_bytes = 0;
+static absolute_time_t session_start;
+
+// Tamanho do setor do volume, como SS() no ff.c
+#if FF_MAX_SS == FF_MIN_SS
+#define SECTOR_SIZE(fs) ((uint32_t)FF_MAX_SS)
+#else
+#define SECTOR_SIZE(fs) ((uint32_t)(fs)->ssize)
+#endif
+
+FRESULT sd_space_init(FATFS *fs) {
+    space_fs = fs;
+    if (fs->free_clst <= fs->n_fatent - 2)
+        return FR_OK; // Contagem já veio do FSINFO
+
+    DWORD nclst;
+    FATFS *pfs;
+    return f_getfree("0:", &nclst, &pfs); // Varre a FAT uma vez e valida free_clst
+}
+
+bool sd_space_known(void) {
+    return space_fs && space_fs->free_clst <= space_fs->n_fatent - 2;
+}
+
+uint64_t sd_space_free_bytes(void) {
+    if (!sd_space_known())
+        return 0;
+    return (uint64_t)space_fs->free_clst * space_fs->csize * SECTOR_SIZE(space_fs);
+}
+
+bool sd_space_low(void) {
+    return sd_space_known() && sd_space_free_bytes() <= SD_SPACE_RESERVE_BYTES;
+}
+
+void sd_space_session_start(void) {
+    session_bytes = 0;
+    session_start = get_absolute_time();
+}
+
+void sd_space_session_bytes(uint64_t bytes) {
+    session_bytes = bytes;
+}
+
+uint32_t sd_space_rate_bps(void) {
+    int64_t elapsed_ms = absolute_time_diff_us(session_start, get_absolute_time()) / 1000;
+    if (elapsed_ms < 1000) // Pouco tempo para uma estimativa estável
+        return 0;
+    return (uint32_t)(session_bytes * 1000 / elapsed_ms);
+}
+
+int32_t sd_space_remaining_s(void) {
+    uint32_t rate = sd_space_rate_bps();
+    uint64_t free_bytes = sd_space_free_bytes();
+    if (rate == 0 || !sd_space_known())
+        return -1;
+    if (free_bytes <= SD_SPACE_RESERVE_BYTES)
+        return 0;
+    uint64_t s = (free_bytes - SD_SPACE_RESERVE_BYTES) / rate;
+    return s > INT32_MAX ? INT32_MAX : (int32_t)s;
+}
@@ -0,0 +1,44 @@
+#ifndef SD_SPACE_H
+#define SD_SPACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+
+// Contabilidade de espaço livre no cartão SD sem varrer a FAT.
+//
+// O FatFs já mantém fs->free_clst atualizado a cada alocação/liberação de
+// cluster (e o lê do FSINFO no FAT32). Basta garantir que ele seja válido uma
+// vez após a montagem (sd_space_init) e depois ler o campo direto: O(1).
+
+// Espaço mantido livre no cartão: a gravação é encerrada antes de chegar nele
+#ifndef SD_SPACE_RESERVE_BYTES
+#define SD_SPACE_RESERVE_BYTES (1024u * 1024u) // 1 MiB
+#endif
+
+// Chamar logo após o f_mount. Se o FSINFO não trouxe a contagem (FAT12/16 ou
+// FSINFO inválido), faz um único f_getfree, que varre a FAT. Se ele falhar, a
+// contagem fica desconhecida até a próxima montagem.
+FRESULT sd_space_init(FATFS *fs);
+
+// true se há uma contagem de clusters livres válida
+bool sd_space_known(void);
+
+// Bytes livres no volume (O(1); 0 se a contagem é desconhecida)
+uint64_t sd_space_free_bytes(void);
+
+// true se o espaço livre chegou à reserva. Com a contagem desconhecida
+// retorna false: a gravação segue e um cartão cheio aparece no f_write.
+bool sd_space_low(void);
+
+// Taxa de gravação da sessão atual: bytes entregues ao log desde o início
+// da sessão (log_writer.total), atualizados onde o total cresce
+void sd_space_session_start(void);
+void sd_space_session_bytes(uint64_t bytes);
+uint32_t sd_space_rate_bps(void);
+
+// Tempo de gravação restante na taxa atual, em segundos (-1 se desconhecido)
+int32_t sd_space_remaining_s(void);
+
+#endif
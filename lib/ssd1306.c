@@ -1,5 +1,39 @@
+#include <string.h>
+
 #include "ssd1306.h"
+#include "hardware/dma.h"
 #include "font.h"
+#include "mem_pool.h"
+
+// Framebuffer em pool estático: um display de WIDTH x HEIGHT (+1 byte de
+// controle), mais a cópia do que o controlador tem, usada no envio parcial
+#ifndef SSD1306_MAX_DISPLAYS
+#define SSD1306_MAX_DISPLAYS 1
+#endif
+MEM_POOL_DEFINE(ssd1306_fb_pool, "ssd1306 fb", WIDTH * HEIGHT / 8 + 1, 2 * SSD1306_MAX_DISPLAYS,
+                MEM_POOL_FALLBACK_HEAP);
+
+// Custo aproximado em bytes na I2C de abrir uma janela: a lista de seis
+// comandos (endereço, byte de controle e comandos) mais endereço e byte de
+// controle dos dados
+#define WINDOW_OVERHEAD (2 + 6 + 2)
+
+// Maior lista aceita por ssd1306_command_list()
+#define MAX_COMMANDS 32
+
+// Fila do envio por DMA: uma palavra de 16 bits por byte na I2C. É o segundo
+// buffer do quadro: o desenho do próximo quadro pode alterar o framebuffer
+// enquanto esta cópia sai. No pior caso leva o quadro inteiro (byte de
+// controle + dados), a lista de comandos da janela e a de dois NOPs (cada
+// uma com o seu byte de controle).
+#ifndef SSD1306_DMA
+#define SSD1306_DMA 1
+#endif
+#define SSD1306_DMA_WORDS (WIDTH * HEIGHT / 8 + 1 + (1 + 6) + (1 + 2))
+#if SSD1306_DMA
+MEM_POOL_DEFINE(ssd1306_dma_pool, "ssd1306 dma", SSD1306_DMA_WORDS * sizeof(uint16_t),
+                SSD1306_MAX_DISPLAYS, MEM_POOL_FALLBACK_NONE);
+#endif
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -8,40 +42,54 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->ram_buffer = mem_pool_calloc(&ssd1306_fb_pool, ssd->bufsize);
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->shadow = mem_pool_calloc(&ssd1306_fb_pool, ssd->bufsize);
+  ssd->tx_buffer[0] = 0x40;
+  ssd->bytes_sent = 0;
+  ssd->send_errors = 0;
+  ssd->dma_channel = -1;
+  ssd->dma_words = NULL;
+  ssd->dma_active = false;
+  ssd->resync = false;
+  memset(ssd->text, ' ', sizeof(ssd->text));
+  ssd1306_invalidate(ssd);
+}
+
+void ssd1306_invalidate(ssd1306_t *ssd) {
+  ssd->shadow_valid = false;
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    ssd->dirty_x0[page] = 0;
+    ssd->dirty_x1[page] = ssd->width - 1;
+  }
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  static const uint8_t commands[] = {
+    SET_DISP | 0x00,
+    SET_MEM_ADDR, 0x01,
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, HEIGHT - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, 0x12,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, 0x14,
+    SET_DISP | 0x01,
+  };
+  ssd1306_command_list(ssd, commands, sizeof(commands));
+  ssd1306_invalidate(ssd);
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_send_wait(ssd);
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -50,71 +98,339 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
     2,
     false
   );
+  ssd->bytes_sent += 3;
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count) {
+  uint8_t buf[1 + MAX_COMMANDS];
+  ssd1306_send_wait(ssd);
+  while (count > 0) {
+    size_t n = count < MAX_COMMANDS ? count : MAX_COMMANDS;
+    buf[0] = 0x00; // Co = 0, D/C = 0: o resto da transação são comandos
+    memcpy(buf + 1, commands, n);
+    i2c_write_blocking(ssd->i2c_port, ssd->address, buf, n + 1, false);
+    ssd->bytes_sent += n + 2;
+    commands += n;
+    count -= n;
+  }
 }
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
-  uint8_t pixel = (y & 0b111);
-  if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
-  else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+// Destino de um envio: a I2C direto (words == NULL) ou a fila de palavras do
+// DMA, em que cada palavra é um byte para IC_DATA_CMD e o último byte de cada
+// transação leva o bit de STOP
+typedef struct {
+  ssd1306_t *ssd;
+  uint16_t *words;
+  size_t count;
+} tx_t;
+
+// Uma transação com a lista de comandos
+static void tx_commands(tx_t *tx, const uint8_t *commands, size_t count) {
+  if (!tx->words) {
+    ssd1306_command_list(tx->ssd, commands, count);
+    return;
+  }
+  uint16_t *dst = tx->words + tx->count;
+  *dst++ = 0x00;
+  for (size_t i = 0; i < count; ++i)
+    *dst++ = commands[i];
+  dst[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  tx->count = dst - tx->words;
+  tx->ssd->bytes_sent += count + 2;
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+static void tx_set_window(tx_t *tx, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1) {
+  const uint8_t commands[] = {SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, page0, page1};
+  tx_commands(tx, commands, sizeof(commands));
+}
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
+// Janela x0..x1 nas páginas page0..page1: no modo vertical o controlador
+// recebe coluna por coluna, page0..page1 de cada uma. Os bytes enviados são
+// copiados para a sombra (o que o controlador passa a ter).
+static void tx_window(tx_t *tx, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1) {
+  ssd1306_t *ssd = tx->ssd;
+  size_t len = 0;
+  tx_set_window(tx, x0, x1, page0, page1);
+  if (tx->words) {
+    uint16_t *dst = tx->words + tx->count;
+    *dst++ = 0x40;
+    for (uint8_t x = x0; x <= x1; ++x) {
+      for (uint8_t page = page0; page <= page1; ++page, ++len) {
+        size_t i = 1 + x * ssd->pages + page;
+        *dst++ = ssd->shadow[i] = ssd->ram_buffer[i];
+      }
     }
+    dst[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    tx->count = dst - tx->words;
+  } else {
+    uint8_t *dst = ssd->tx_buffer + 1;
+    for (uint8_t x = x0; x <= x1; ++x) {
+      for (uint8_t page = page0; page <= page1; ++page, ++len) {
+        size_t i = 1 + x * ssd->pages + page;
+        *dst++ = ssd->shadow[i] = ssd->ram_buffer[i];
+      }
+    }
+    i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->tx_buffer, len + 1, false);
+  }
+  ssd->bytes_sent += len + 2;
 }
 
+static void tx_full(tx_t *tx) {
+  ssd1306_t *ssd = tx->ssd;
+  if (tx->words) {
+    tx_window(tx, 0, ssd->width - 1, 0, ssd->pages - 1);
+  } else {
+    tx_set_window(tx, 0, ssd->width - 1, 0, ssd->pages - 1);
+    i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize, false);
+    ssd->bytes_sent += ssd->bufsize + 1;
+    if (ssd->shadow)
+      memcpy(ssd->shadow, ssd->ram_buffer, ssd->bufsize);
+  }
+  ssd->shadow_valid = ssd->shadow != NULL;
+}
 
+// Envia o que mudou desde o último envio, por tx
+static void send_changes(tx_t *tx) {
+  ssd1306_t *ssd = tx->ssd;
+  uint8_t pages = ssd->pages;
+  uint8_t *x0 = ssd->dirty_x0, *x1 = ssd->dirty_x1;
+  size_t total = 0;
 
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
+  if (ssd->resync) {
+    // Um envio cortado no meio de SET_COL_ADDR/SET_PAGE_ADDR deixa o
+    // controlador esperando até dois argumentos: dois NOPs completam o comando
+    // pendente (a janela seguinte redefine tudo)
+    static const uint8_t nops[] = {SET_NOP, SET_NOP};
+    tx_commands(tx, nops, sizeof(nops));
+    ssd->resync = false;
   }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
+
+  if (ssd->shadow_valid) {
+    // Estreita as faixas sujas até os bytes que diferem do controlador (o
+    // quadro costuma ser apagado e redesenhado quase igual)
+    for (uint8_t page = 0; page < pages; ++page) {
+      const uint8_t *fb = ssd->ram_buffer + 1 + page, *sh = ssd->shadow + 1 + page;
+      while (x0[page] <= x1[page] && fb[x0[page] * pages] == sh[x0[page] * pages])
+        ++x0[page];
+      while (x0[page] <= x1[page] && fb[x1[page] * pages] == sh[x1[page] * pages])
+        --x1[page];
+      if (x0[page] <= x1[page])
+        total += x1[page] - x0[page] + 1 + WINDOW_OVERHEAD;
+    }
   }
 
-  if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
+  if (!ssd->shadow_valid || total >= ssd->bufsize) {
+    tx_full(tx);
+  } else {
+    // Junta páginas vizinhas numa janela só quando isso custa menos que
+    // abrir outra janela e cabe em tx_buffer
+    for (uint8_t page = 0; page < pages; ++page) {
+      if (x0[page] > x1[page])
+        continue;
+      uint8_t first = page, a = x0[page], b = x1[page];
+      size_t separate = b - a + 1 + WINDOW_OVERHEAD;
+      while (page + 1 < pages && x0[page + 1] <= x1[page + 1]) {
+        uint8_t na = a < x0[page + 1] ? a : x0[page + 1];
+        uint8_t nb = b > x1[page + 1] ? b : x1[page + 1];
+        size_t merged = (size_t)(nb - na + 1) * (page + 2 - first);
+        size_t alone = separate + x1[page + 1] - x0[page + 1] + 1 + WINDOW_OVERHEAD;
+        if (merged > WIDTH || merged + WINDOW_OVERHEAD > alone)
+          break;
+        a = na;
+        b = nb;
+        separate = merged + WINDOW_OVERHEAD;
+        ++page;
       }
+      tx_window(tx, a, b, first, page);
     }
   }
+
+  for (uint8_t page = 0; page < pages; ++page) {
+    x0[page] = ssd->width;
+    x1[page] = 0;
+  }
+}
+
+void ssd1306_send_data(ssd1306_t *ssd) {
+  ssd1306_send_wait(ssd);
+  tx_t tx = {ssd, NULL, 0};
+  send_changes(&tx);
+}
+
+// --- Envio por DMA ---
+
+bool ssd1306_dma_init(ssd1306_t *ssd) {
+#if !SSD1306_DMA
+  (void)ssd;
+  return false;
+#else
+  if (ssd->dma_channel >= 0)
+    return true;
+  if (!ssd->shadow)
+    return false;
+  ssd->dma_words = mem_pool_alloc(&ssd1306_dma_pool, SSD1306_DMA_WORDS * sizeof(uint16_t));
+  int channel = ssd->dma_words ? dma_claim_unused_channel(false) : -1;
+  if (channel < 0) {
+    mem_pool_free(&ssd1306_dma_pool, ssd->dma_words);
+    ssd->dma_words = NULL;
+    return false;
+  }
+  dma_channel_config c = dma_channel_get_default_config(channel);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(ssd->i2c_port, true)); // Ritmo da FIFO de TX
+  dma_channel_configure(channel, &c, &i2c_get_hw(ssd->i2c_port)->data_cmd, NULL, 0, false);
+  ssd->dma_channel = channel;
+  return true;
+#endif
+}
+
+bool ssd1306_send_data_async(ssd1306_t *ssd) {
+  if (ssd->dma_channel < 0) {
+    ssd1306_send_data(ssd);
+    return true;
+  }
+  if (ssd1306_send_busy(ssd))
+    return false; // O que mudou continua marcado e vai no próximo envio
+  tx_t tx = {ssd, ssd->dma_words, 0};
+  send_changes(&tx);
+  if (tx.count == 0)
+    return true;
+  // Mesmo preparo do i2c_write_blocking: endereço do escravo com o bloco
+  // desligado; cada STOP da fila fecha uma transação e a próxima palavra abre
+  // outra com START
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+  ssd->dma_active = true;
+  dma_channel_transfer_from_buffer_now(ssd->dma_channel, ssd->dma_words, tx.count);
+  return true;
+}
+
+bool ssd1306_send_busy(ssd1306_t *ssd) {
+  if (!ssd->dma_active)
+    return false;
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    // NACK ou perda de barramento: o bloco descarta a FIFO. Não dá para saber
+    // o que chegou ao controlador, então o próximo envio manda tudo
+    dma_channel_abort(ssd->dma_channel);
+    (void)hw->clr_tx_abrt;
+    ssd->dma_active = false;
+    ssd->send_errors++;
+    ssd->resync = true;
+    ssd1306_invalidate(ssd);
+    return false;
+  }
+  // O DMA termina quando as últimas palavras entram na FIFO; o envio, quando
+  // a FIFO esvazia e o último STOP sai
+  if (dma_channel_is_busy(ssd->dma_channel) || !(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+      (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS))
+    return true;
+  ssd->dma_active = false;
+  return false;
+}
+
+void ssd1306_send_wait(ssd1306_t *ssd) {
+  while (ssd1306_send_busy(ssd))
+    tight_loop_contents();
+}
+
+// Framebuffer no modo de endereçamento vertical (SET_MEM_ADDR 0x01): a coluna
+// x ocupa ssd->pages bytes seguidos, um por página de 8 linhas, com o bit 0 na
+// linha de cima. O desenho trabalha em bytes inteiros sempre que pode.
+static inline uint8_t *fb_byte(ssd1306_t *ssd, uint8_t x, uint8_t page) {
+  return &ssd->ram_buffer[1 + x * ssd->pages + page];
+}
+
+static inline void mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page) {
+  if (x0 < ssd->dirty_x0[page])
+    ssd->dirty_x0[page] = x0;
+  if (x1 > ssd->dirty_x1[page])
+    ssd->dirty_x1[page] = x1;
+}
+
+// Aplica mask (bits de uma página) nas colunas x0..x1
+static void fill_columns(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page, uint8_t mask, bool value) {
+  mark_dirty(ssd, x0, x1, page);
+  uint8_t *p = fb_byte(ssd, x0, page);
+  for (uint8_t x = x0; x <= x1; ++x, p += ssd->pages) {
+    if (value)
+      *p |= mask;
+    else
+      *p &= ~mask;
+  }
+}
+
+// Preenche o retângulo x0..x1, y0..y1 (inclusivos), recortado no display
+static void fill_span(ssd1306_t *ssd, int x0, int x1, int y0, int y1, bool value) {
+  if (x0 < 0)
+    x0 = 0;
+  if (y0 < 0)
+    y0 = 0;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
+  uint8_t first = y0 >> 3, last = y1 >> 3;
+  for (uint8_t page = first; page <= last; ++page) {
+    uint8_t mask = 0xFF;
+    if (page == first)
+      mask &= 0xFF << (y0 & 7);
+    if (page == last)
+      mask &= 0xFF >> (7 - (y1 & 7));
+    fill_columns(ssd, x0, x1, page, mask, value);
+  }
+}
+
+void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  mark_dirty(ssd, x, x, y >> 3);
+  uint8_t *p = fb_byte(ssd, x, y >> 3);
+  uint8_t bit = 1 << (y & 7);
+  if (value)
+    *p |= bit;
+  else
+    *p &= ~bit;
+}
+
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, ssd->bufsize - 1);
+  memset(ssd->text, value ? 0 : ' ', sizeof(ssd->text)); // Espaço é a célula apagada
+  for (uint8_t page = 0; page < ssd->pages; ++page)
+    mark_dirty(ssd, 0, ssd->width - 1, page);
+}
+
+void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+  if (width == 0 || height == 0)
+    return;
+  int right = left + width - 1, bottom = top + height - 1;
+  if (fill) {
+    fill_span(ssd, left, right, top, bottom, value);
+    return;
+  }
+  fill_span(ssd, left, right, top, top, value);
+  fill_span(ssd, left, right, bottom, bottom, value);
+  fill_span(ssd, left, left, top, bottom, value);
+  fill_span(ssd, right, right, top, bottom, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
+    // Horizontais e verticais saem em bytes inteiros
+    if (y0 == y1) {
+        ssd1306_hline(ssd, x0 < x1 ? x0 : x1, x0 < x1 ? x1 : x0, y0, value);
+        return;
+    }
+    if (x0 == x1) {
+        ssd1306_vline(ssd, x0, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, value);
+        return;
+    }
+
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
 
@@ -144,39 +460,59 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  fill_span(ssd, x0, x1, y, y, value);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  fill_span(ssd, x, x, y0, y1, value);
+}
+
+void ssd1306_scroll_left(ssd1306_t *ssd, uint8_t page0, uint8_t page1, uint8_t n) {
+  if (page1 >= ssd->pages)
+    page1 = ssd->pages - 1;
+  if (page0 > page1 || n == 0)
+    return;
+  // Cada coluna tem as suas páginas seguidas: com todas as páginas é um
+  // memmove só; senão, um pedaço de coluna por vez
+  uint8_t span = page1 - page0 + 1;
+  if (n < ssd->width) {
+    if (span == ssd->pages) {
+      memmove(fb_byte(ssd, 0, 0), fb_byte(ssd, n, 0), (size_t)(ssd->width - n) * ssd->pages);
+    } else {
+      for (uint8_t x = 0; x + n < ssd->width; ++x)
+        memcpy(fb_byte(ssd, x, page0), fb_byte(ssd, x + n, page0), span);
+    }
+  }
+  for (uint8_t page = page0; page <= page1; ++page)
+    mark_dirty(ssd, 0, ssd->width - 1, page);
+  fill_span(ssd, n < ssd->width ? ssd->width - n : 0, ssd->width - 1, page0 * 8, page1 * 8 + 7, false);
 }
 
 // Função para desenhar um caractere
+// Cada byte da fonte é uma coluna do caractere (bit 0 em cima), o mesmo
+// formato do framebuffer: com y múltiplo de 8 o caractere é copiado byte a
+// byte; senão cada coluna é deslocada e dividida entre duas páginas.
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
-
-  // Verifica o caractere e calcula o índice correspondente na fonte
-  if (c >= ' ' && c <= '~') // Verifica se o caractere está na faixa ASCII válida
-  {
-    index = (c - ' ') * 8; // Calcula o índice baseado na posição do caractere na tabela ASCII
-  }
-  else
-  {
-    // Caractere inválido, desenha um espaço (ou pode ser tratado de outra forma)
-    index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
-  }
+  // Fora da faixa ASCII imprimível desenha um espaço
+  const uint8_t *glyph = &font[(c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0];
+  uint8_t page = y >> 3, shift = y & 7;
+  if (page >= ssd->pages)
+    return;
+  bool has_lower = shift && page + 1 < ssd->pages;
+  uint8_t last = x + 7 < ssd->width ? x + 7 : ssd->width - 1;
+  if (x >= ssd->width)
+    return;
+  mark_dirty(ssd, x, last, page);
+  if (has_lower)
+    mark_dirty(ssd, x, last, page + 1);
 
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
+  for (uint8_t i = 0; i < 8 && x + i < ssd->width; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
-    }
+    uint8_t *p = fb_byte(ssd, x + i, page);
+    p[0] = (p[0] & ~(0xFF << shift)) | (uint8_t)(glyph[i] << shift);
+    if (has_lower)
+      p[1] = (p[1] & ~(0xFF >> (8 - shift))) | (glyph[i] >> (8 - shift));
   }
 }
 
@@ -197,4 +533,33 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
       break;
     }
   }
-}
\ No newline at end of file
+}
+
+// Desenha c na célula (col, row) se ela ainda não tem esse caractere
+static void text_cell(ssd1306_t *ssd, uint8_t col, uint8_t row, char c) {
+  if (c < ' ' || c > '~')
+    c = ' '; // Como em ssd1306_draw_char()
+  if (ssd->text[row][col] == c)
+    return;
+  ssd->text[row][col] = c;
+  ssd1306_draw_char(ssd, c, col * 8, row * 8);
+}
+
+void ssd1306_text(ssd1306_t *ssd, uint8_t col, uint8_t row, const char *str) {
+  if (row >= ssd->pages)
+    return;
+  for (uint8_t cols = ssd->width / 8; col < cols && *str; ++col)
+    text_cell(ssd, col, row, *str++);
+}
+
+void ssd1306_text_line(ssd1306_t *ssd, uint8_t row, const char *str) {
+  if (row >= ssd->pages)
+    return;
+  for (uint8_t col = 0, cols = ssd->width / 8; col < cols; ++col)
+    text_cell(ssd, col, row, *str ? *str++ : ' ');
+}
+
+void ssd1306_text_forget(ssd1306_t *ssd, uint8_t row) {
+  if (row < ssd->pages)
+    memset(ssd->text[row], 0, sizeof(ssd->text[row]));
+}
@@ -1,9 +1,14 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_MAX_PAGES (HEIGHT / 8)
+#define SSD1306_TEXT_COLS (WIDTH / 8)
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -22,7 +27,8 @@ typedef enum {
   SET_DISP_CLK_DIV = 0xD5,
   SET_PRECHARGE = 0xD9,
   SET_VCOM_DESEL = 0xDB,
-  SET_CHARGE_PUMP = 0x8D
+  SET_CHARGE_PUMP = 0x8D,
+  SET_NOP = 0xE3
 } ssd1306_command_t;
 
 typedef struct {
@@ -32,18 +38,73 @@ typedef struct {
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  // Atualização parcial: colunas alteradas em cada página desde o último envio
+  // (dirty_x0 > dirty_x1: página limpa) e cópia do que o controlador já tem
+  uint8_t dirty_x0[SSD1306_MAX_PAGES], dirty_x1[SSD1306_MAX_PAGES];
+  uint8_t *shadow;
+  bool shadow_valid; // false: manda o quadro inteiro no próximo envio
+  uint8_t tx_buffer[WIDTH + 1]; // Byte de controle + dados de uma janela
+  uint32_t bytes_sent; // Bytes enviados pela I2C (comandos e dados)
+  // Envio por DMA (ssd1306_dma_init): canal (-1 sem DMA) e fila de palavras
+  // para IC_DATA_CMD
+  int dma_channel;
+  uint16_t *dma_words;
+  bool dma_active;
+  bool resync; // Envio abortado: o controlador pode estar esperando argumentos
+  uint32_t send_errors; // Envios por DMA abortados (NACK/barramento)
+  // Camada de texto: caractere em cada célula de 8x8 (linha = página); 0 se
+  // a célula não corresponde a nenhum caractere e precisa ser redesenhada
+  char text[SSD1306_MAX_PAGES][SSD1306_TEXT_COLS];
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+// Envia os comandos (e seus argumentos) numa transação só, com um único byte
+// de controle 0x00, em vez de uma transação por byte
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count);
+// Envia só as janelas (colunas x páginas) que mudaram desde o último envio
 void ssd1306_send_data(ssd1306_t *ssd);
+// Esquece o que o controlador tem: o próximo envio manda o quadro inteiro
+void ssd1306_invalidate(ssd1306_t *ssd);
+
+// Envio sem bloquear: o DMA alimenta a FIFO de TX da I2C no ritmo do DREQ.
+// ssd1306_dma_init() pega um canal livre (false: sem DMA, os envios continuam
+// bloqueantes). ssd1306_send_data_async() copia as janelas alteradas para a
+// fila e retorna; o framebuffer pode ser redesenhado logo em seguida. Com um
+// envio ainda em andamento retorna false e as mudanças ficam para o próximo.
+// ssd1306_send_busy() diz se o envio terminou (inclusive o último STOP);
+// ssd1306_send_wait() espera. Comandos e envios bloqueantes esperam sozinhos.
+bool ssd1306_dma_init(ssd1306_t *ssd);
+bool ssd1306_send_data_async(ssd1306_t *ssd);
+bool ssd1306_send_busy(ssd1306_t *ssd);
+void ssd1306_send_wait(ssd1306_t *ssd);
 
+// Desenho no framebuffer (recortado nas bordas do display); só vai para o
+// display com ssd1306_send_data()
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
+// Desloca as páginas page0..page1 n colunas para a esquerda e apaga as n
+// colunas que sobram à direita: um gráfico rolando só desenha a coluna nova
+void ssd1306_scroll_left(ssd1306_t *ssd, uint8_t page0, uint8_t page1, uint8_t n);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+
+// Camada de texto: grade de células de 8x8 (coluna 0..15, linha = página
+// 0..7) que lembra o que já foi desenhado e só redesenha os caracteres que
+// mudaram; uma tela que só troca um contador manda só esses bytes.
+// ssd1306_fill() limpa a grade junto com o framebuffer. Desenhar outra coisa
+// por cima de uma linha de texto exige ssd1306_text_forget() nela.
+// ssd1306_text() escreve str a partir da célula (col, row), cortada no fim da
+// linha; ssd1306_text_line() escreve a linha inteira, com espaços depois de str.
+// Os dois descartam em silêncio o que passar de SSD1306_TEXT_COLS colunas:
+// quem monta a linha tem que garantir que ela cabe.
+void ssd1306_text(ssd1306_t *ssd, uint8_t col, uint8_t row, const char *str);
+void ssd1306_text_line(ssd1306_t *ssd, uint8_t row, const char *str);
+void ssd1306_text_forget(ssd1306_t *ssd, uint8_t row);
+
+#endif
@@ -0,0 +1,101 @@
+#include <stdio.h>
+
+#include "task_sched.h"
+
+void task_sched_init(task_sched_t *sched, uint64_t (*clock)(void)) {
+    sched->tasks = NULL;
+    sched->clock = clock;
+    sched->stats_since_us = clock();
+}
+
+void task_add(task_sched_t *sched, task_t *task) {
+    task->enabled = false;
+    task->runs = task->missed = task->max_us = task->max_late_us = 0;
+    task->busy_us = 0;
+    task_t **p = &sched->tasks;
+    while (*p && (*p)->priority <= task->priority)
+        p = &(*p)->next;
+    task->next = *p;
+    *p = task;
+}
+
+void task_start(task_sched_t *sched, task_t *task, uint32_t delay_us) {
+    task->due_us = sched->clock() + delay_us;
+    task->enabled = true;
+}
+
+void task_stop(task_t *task) {
+    task->enabled = false;
+}
+
+bool task_sched_run_once(task_sched_t *sched) {
+    uint64_t now = sched->clock();
+    task_t *best = NULL;
+    // A lista está em ordem de prioridade: a primeira vencida só perde para
+    // outra da mesma prioridade com prazo mais antigo
+    for (task_t *t = sched->tasks; t; t = t->next) {
+        if (best && t->priority != best->priority)
+            break;
+        if (t->enabled && t->due_us <= now && (!best || t->due_us < best->due_us))
+            best = t;
+    }
+    if (!best)
+        return false;
+
+    uint64_t late = now - best->due_us;
+    if (late > best->max_late_us)
+        best->max_late_us = (uint32_t)late;
+    if (best->period_us) {
+        best->due_us += best->period_us;
+        if (best->due_us <= now) { // Perdeu prazos inteiros: retoma no próximo
+            uint64_t skipped = (now - best->due_us) / best->period_us + 1;
+            best->missed += (uint32_t)skipped;
+            best->due_us += skipped * best->period_us;
+        }
+    } else {
+        best->enabled = false;
+    }
+
+    best->run(best);
+    uint64_t spent = sched->clock() - now;
+    best->runs++;
+    best->busy_us += spent;
+    if (spent > best->max_us)
+        best->max_us = (uint32_t)spent;
+    return true;
+}
+
+uint64_t task_sched_next_due(const task_sched_t *sched) {
+    uint64_t due = UINT64_MAX;
+    for (const task_t *t = sched->tasks; t; t = t->next) {
+        if (t->enabled && t->due_us < due)
+            due = t->due_us;
+    }
+    return due;
+}
+
+void task_sched_reset_stats(task_sched_t *sched) {
+    for (task_t *t = sched->tasks; t; t = t->next) {
+        t->runs = t->missed = t->max_us = t->max_late_us = 0;
+        t->busy_us = 0;
+    }
+    sched->stats_since_us = sched->clock();
+}
+
+void task_sched_report(const task_sched_t *sched) {
+    uint64_t elapsed = sched->clock() - sched->stats_since_us;
+    uint64_t busy = 0;
+    for (const task_t *t = sched->tasks; t; t = t->next) {
+        // CPU em décimos de %
+        uint32_t permille = elapsed ? (uint32_t)(t->busy_us * 1000 / elapsed) : 0;
+        printf("[tarefas] %-10s p%u: %lu execucoes, CPU %lu.%lu%%, pior %lu us, "
+               "atraso maximo %lu us, prazos perdidos %lu\n",
+               t->name, t->priority, (unsigned long)t->runs, (unsigned long)(permille / 10),
+               (unsigned long)(permille % 10), (unsigned long)t->max_us, (unsigned long)t->max_late_us,
+               (unsigned long)t->missed);
+        busy += t->busy_us;
+    }
+    uint32_t idle_permille = elapsed ? (uint32_t)((elapsed - busy) * 1000 / elapsed) : 0;
+    printf("[tarefas] ocioso %lu.%lu%% de %lu ms\n", (unsigned long)(idle_permille / 10),
+           (unsigned long)(idle_permille % 10), (unsigned long)(elapsed / 1000));
+}
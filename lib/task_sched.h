@@ -0,0 +1,63 @@
+#ifndef TASK_SCHED_H
+#define TASK_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Escalonador cooperativo do laço principal. Portátil: o relógio vem de fora
+// (time_us_64 no firmware, tempo simulado em tools/schedsim.c).
+//
+// Cada tarefa roda até o fim (sem preempção) quando chega o seu prazo. Entre
+// as tarefas vencidas roda a de maior prioridade (menor número) e, empatadas,
+// a de prazo mais antigo. Tarefas periódicas têm o próximo prazo somado ao
+// anterior, sem acumular atraso; se uma execução atrasar mais que um período
+// inteiro, os prazos perdidos são contados e pulados. Sem nada vencido o
+// chamador pode dormir até task_sched_next_due().
+
+typedef struct task task_t;
+typedef void (*task_fn_t)(task_t *task);
+
+struct task {
+    const char *name;
+    task_fn_t run;
+    uint8_t priority;   // 0 = mais urgente
+    uint32_t period_us; // 0: roda uma vez a cada task_start()
+    // Estado
+    bool enabled;
+    uint64_t due_us;
+    task_t *next;
+    // Contabilidade (task_sched_reset_stats)
+    uint32_t runs;
+    uint32_t missed;      // Prazos pulados por atraso maior que o período
+    uint64_t busy_us;     // Tempo total rodando
+    uint32_t max_us;      // Execução mais longa
+    uint32_t max_late_us; // Maior atraso entre o prazo e o início
+};
+
+typedef struct {
+    task_t *tasks; // Em ordem de prioridade
+    uint64_t (*clock)(void);
+    uint64_t stats_since_us;
+} task_sched_t;
+
+void task_sched_init(task_sched_t *sched, uint64_t (*clock)(void));
+
+// Registra a tarefa (desligada; ver task_start)
+void task_add(task_sched_t *sched, task_t *task);
+
+// Liga a tarefa com o primeiro prazo daqui a delay_us
+void task_start(task_sched_t *sched, task_t *task, uint32_t delay_us);
+void task_stop(task_t *task);
+
+// Roda uma tarefa vencida; false se nenhuma venceu
+bool task_sched_run_once(task_sched_t *sched);
+
+// Menor prazo entre as tarefas ligadas (UINT64_MAX se nenhuma)
+uint64_t task_sched_next_due(const task_sched_t *sched);
+
+void task_sched_reset_stats(task_sched_t *sched);
+
+// Uma linha por tarefa: execuções, uso de CPU, pior execução e atraso
+void task_sched_report(const task_sched_t *sched);
+
+#endif
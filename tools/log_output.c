@@ -0,0 +1,179 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "csv_format.h"
+#include "log_output.h"
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "As saidas .npy sao gravadas na ordem de bytes do host (little-endian)"
+#endif
+
+#define NPY_HEADER_SIZE 128 // Fixo: o número de linhas é reescrito no fim
+
+static const char *const column_names[LOG_OUTPUT_COLUMNS] = {
+    "Sample", "AccelX", "AccelY", "AccelZ", "GyroX", "GyroY", "GyroZ"};
+
+static const char csv_columns[] = "Sample,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ\n";
+
+int log_output_parse_format(const char *name) {
+    static const char *const names[] = {"csv", "npy", "cols", "null"};
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(name, names[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static void write_bytes(log_output_t *out, FILE *f, const void *data, size_t len) {
+    if (fwrite(data, 1, len, f) != len && !out->error)
+        out->error = errno ? errno : EIO;
+    out->bytes_out += len;
+}
+
+// Cabeçalho .npy versão 1.0 com tamanho fixo (preenchido com espaços)
+static void write_npy_header(log_output_t *out, FILE *f, const char *descr, uint64_t rows,
+                             int cols) {
+    char header[NPY_HEADER_SIZE];
+    char shape[48];
+    if (cols > 1)
+        snprintf(shape, sizeof(shape), "(%llu, %d)", (unsigned long long)rows, cols);
+    else
+        snprintf(shape, sizeof(shape), "(%llu,)", (unsigned long long)rows);
+    memset(header, ' ', sizeof(header));
+    memcpy(header, "\x93NUMPY\x01\x00", 8);
+    header[8] = (char)(NPY_HEADER_SIZE - 10);
+    header[9] = 0;
+    int n = snprintf(header + 10, sizeof(header) - 10,
+                     "{'descr': '%s', 'fortran_order': False, 'shape': %s, }", descr, shape);
+    header[10 + n] = ' '; // Tira o '\0' do snprintf
+    header[NPY_HEADER_SIZE - 1] = '\n';
+    write_bytes(out, f, header, sizeof(header));
+}
+
+static FILE *open_file(log_output_t *out, const char *suffix) {
+    size_t len = strlen(out->base) + strlen(suffix) + 2;
+    char *name = malloc(len);
+    if (!name)
+        return NULL;
+    snprintf(name, len, "%s.%s", out->base, suffix);
+    FILE *f = fopen(name, "wb");
+    free(name);
+    if (f)
+        setvbuf(f, NULL, _IOFBF, LOG_OUTPUT_BUFFER);
+    else if (!out->error)
+        out->error = errno;
+    return f;
+}
+
+int log_output_open(log_output_t *out, log_output_format_t format, const char *base) {
+    memset(out, 0, sizeof(*out));
+    out->format = format;
+    out->base = base;
+    switch (format) {
+    case LOG_OUTPUT_CSV:
+        out->files[0] = open_file(out, "csv");
+        if (out->files[0])
+            write_bytes(out, out->files[0], csv_columns, sizeof(csv_columns) - 1);
+        break;
+    case LOG_OUTPUT_NPY:
+        out->files[0] = open_file(out, "npy");
+        if (out->files[0])
+            write_npy_header(out, out->files[0], "<i4", 0, LOG_OUTPUT_COLUMNS);
+        break;
+    case LOG_OUTPUT_COLS:
+        for (int c = 0; c < LOG_OUTPUT_COLUMNS && !out->error; c++) {
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), "%s.npy", column_names[c]);
+            out->files[c] = open_file(out, suffix);
+            if (out->files[c])
+                write_npy_header(out, out->files[c], c ? "<i2" : "<u4", 0, 1);
+        }
+        break;
+    case LOG_OUTPUT_NULL:
+        break;
+    }
+    if (out->error) {
+        log_output_close(out);
+        return out->error;
+    }
+    return 0;
+}
+
+void log_output_text(void *ctx, const char *text, size_t len) {
+    log_output_t *out = ctx;
+    if (out->format == LOG_OUTPUT_CSV) {
+        write_bytes(out, out->files[0], text, len);
+    } else if (out->format != LOG_OUTPUT_NULL) {
+        if (!out->meta)
+            out->meta = open_file(out, "meta.txt");
+        if (out->meta)
+            write_bytes(out, out->meta, text, len);
+    }
+}
+
+void log_output_batch(void *ctx, const log_batch_t *batch) {
+    log_output_t *out = ctx;
+    size_t n = batch->count;
+    out->rows += n;
+
+    switch (out->format) {
+    case LOG_OUTPUT_CSV: {
+        char text[LOG_READER_BATCH * CSV_FORMAT_MAX_RECORD];
+        size_t len = 0;
+        for (size_t i = 0; i < n; i++)
+            len += csv_format_record(text + len, batch->sample[i], batch->values[i]);
+        write_bytes(out, out->files[0], text, len);
+        break;
+    }
+    case LOG_OUTPUT_NPY: {
+        int32_t rows[LOG_READER_BATCH][LOG_OUTPUT_COLUMNS];
+        for (size_t i = 0; i < n; i++) {
+            rows[i][0] = (int32_t)batch->sample[i];
+            for (int c = 0; c < LOG_READER_CHANNELS; c++)
+                rows[i][1 + c] = batch->values[i][c];
+        }
+        write_bytes(out, out->files[0], rows, n * sizeof(rows[0]));
+        break;
+    }
+    case LOG_OUTPUT_COLS: {
+        int16_t column[LOG_READER_BATCH];
+        write_bytes(out, out->files[0], batch->sample, n * sizeof(batch->sample[0]));
+        for (int c = 0; c < LOG_READER_CHANNELS; c++) {
+            for (size_t i = 0; i < n; i++)
+                column[i] = batch->values[i][c];
+            write_bytes(out, out->files[1 + c], column, n * sizeof(column[0]));
+        }
+        break;
+    }
+    case LOG_OUTPUT_NULL:
+        break;
+    }
+}
+
+int log_output_close(log_output_t *out) {
+    for (int c = 0; c < LOG_OUTPUT_COLUMNS; c++) {
+        FILE *f = out->files[c];
+        if (!f)
+            continue;
+        if (out->format == LOG_OUTPUT_NPY || out->format == LOG_OUTPUT_COLS) {
+            // Reescreve o cabeçalho com o número final de linhas
+            uint64_t bytes = out->bytes_out;
+            rewind(f);
+            if (out->format == LOG_OUTPUT_NPY)
+                write_npy_header(out, f, "<i4", out->rows, LOG_OUTPUT_COLUMNS);
+            else
+                write_npy_header(out, f, c ? "<i2" : "<u4", out->rows, 1);
+            out->bytes_out = bytes;
+        }
+        if (fclose(f) != 0 && !out->error)
+            out->error = errno;
+        out->files[c] = NULL;
+    }
+    if (out->meta) {
+        if (fclose(out->meta) != 0 && !out->error)
+            out->error = errno;
+        out->meta = NULL;
+    }
+    return out->error;
+}
@@ -0,0 +1,48 @@
+#ifndef LOG_OUTPUT_H
+#define LOG_OUTPUT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "log_reader.h"
+
+// Saídas do conversor, todas gravadas em fluxo (nada do arquivo fica na RAM):
+//   csv   <base>.csv: mesmo texto do CSV do firmware, com os metadados '#'
+//   npy   <base>.npy: matriz int32 N x 7 (Sample, AccelX..Z, GyroX..Z)
+//   cols  <base>.<coluna>.npy: um vetor por coluna (uint32 / int16)
+//   null  só decodifica (medição de desempenho)
+// Em npy e cols os metadados vão para <base>.meta.txt.
+
+typedef enum {
+    LOG_OUTPUT_CSV,
+    LOG_OUTPUT_NPY,
+    LOG_OUTPUT_COLS,
+    LOG_OUTPUT_NULL
+} log_output_format_t;
+
+#define LOG_OUTPUT_COLUMNS (1 + LOG_READER_CHANNELS)
+#define LOG_OUTPUT_BUFFER (256 * 1024) // Buffer de escrita por arquivo
+
+typedef struct {
+    log_output_format_t format;
+    FILE *files[LOG_OUTPUT_COLUMNS]; // csv/npy: só files[0]
+    FILE *meta;
+    const char *base;
+    uint64_t rows;
+    uint64_t bytes_out;
+    int error; // errno da primeira falha de escrita
+} log_output_t;
+
+// Nome do formato ("csv", "npy", "cols", "null") para o enum; -1 se inválido
+int log_output_parse_format(const char *name);
+
+int log_output_open(log_output_t *out, log_output_format_t format, const char *base);
+
+// Callbacks para o log_reader_sink_t (ctx = log_output_t *)
+void log_output_text(void *ctx, const char *text, size_t len);
+void log_output_batch(void *ctx, const log_batch_t *batch);
+
+// Completa os cabeçalhos .npy com o número de linhas e fecha. Retorna 0 ou errno.
+int log_output_close(log_output_t *out);
+
+#endif
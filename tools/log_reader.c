@@ -0,0 +1,443 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "block_frame.h"
+#include "column_block.h"
+#include "crc32.h"
+#include "lz_block.h"
+#include "log_reader.h"
+
+// Buffer de leitura do .lzb: um pedaço novo + o maior bloco
+#define BLOCK_BUF_SIZE (LOG_READER_CHUNK + BLOCK_FRAME_MAX_HEADER_SIZE + BLOCK_FRAME_MAX_RAW)
+
+// Bytes pendentes entre pedaços: um pedaço novo + o maior texto de metadados
+#define CARRY_SIZE (2 * LOG_READER_CHUNK + IMU_CODEC_HEADER_SIZE + 65535)
+
+typedef enum { CONTENT_UNKNOWN, CONTENT_CSV, CONTENT_IMU, CONTENT_COLUMNS } content_t;
+typedef enum { STATE_HEADER, STATE_RECORDS, STATE_TRAILER, STATE_DONE } state_t;
+
+// (amostra, ms) do cabeçalho de um bloco versão 2
+typedef struct {
+    uint32_t sample;
+    uint32_t ms;
+} anchor_t;
+
+// Decodificador do conteúdo (.csv ou .imu), alimentado em pedaços
+typedef struct {
+    content_t content;
+    state_t state;
+    imu_decoder_t dec;
+    const log_reader_sink_t *sink;
+    log_reader_stats_t *stats;
+    log_batch_t batch;
+    uint32_t next_sample; // Esperada depois da última entregue
+    bool lost;            // Dados perdidos desde a última amostra entregue
+    bool has_time;        // Já houve um bloco versão 2
+    anchor_t prev, cur;   // Dois últimos blocos versão 2 válidos
+    size_t len;
+    uint8_t buf[CARRY_SIZE];
+} parser_t;
+
+static void flush_batch(parser_t *p) {
+    if (p->batch.count) {
+        p->stats->samples += p->batch.count;
+        p->sink->on_batch(p->sink->ctx, &p->batch);
+        p->batch.count = 0;
+    }
+}
+
+// Instante da amostra s pelos dois últimos cabeçalhos versão 2 (interpolado
+// entre eles ou extrapolado depois do último)
+static bool sample_ms(const parser_t *p, uint32_t s, uint32_t *ms) {
+    if (!p->has_time)
+        return false;
+    if (s == p->cur.sample) {
+        *ms = p->cur.ms;
+        return true;
+    }
+    if (p->cur.sample <= p->prev.sample)
+        return false;
+    int64_t ds = (int64_t)s - p->prev.sample;
+    int64_t t = p->prev.ms + ds * ((int64_t)p->cur.ms - p->prev.ms) /
+                                 ((int64_t)p->cur.sample - p->prev.sample);
+    *ms = t < 0 ? 0 : (uint32_t)t;
+    return true;
+}
+
+// Fecha o trecho perdido em end (primeira amostra depois dele)
+static void report_lost(parser_t *p, uint32_t end) {
+    p->lost = false;
+    if (end <= p->next_sample)
+        return; // Só metadados se perderam
+    log_lost_t lost = {.first_sample = p->next_sample, .end_sample = end};
+    lost.has_time = sample_ms(p, lost.first_sample, &lost.first_ms) &&
+                    (end == LOG_READER_TO_END || sample_ms(p, end, &lost.end_ms));
+    p->stats->lost_ranges++;
+    if (p->sink->on_lost) {
+        flush_batch(p);
+        p->sink->on_lost(p->sink->ctx, &lost);
+    }
+}
+
+static inline void emit_sample(parser_t *p, uint32_t sample, const int16_t *values) {
+    if (p->lost)
+        report_lost(p, sample);
+    p->next_sample = sample + 1;
+    size_t i = p->batch.count++;
+    p->batch.sample[i] = sample;
+    memcpy(p->batch.values[i], values, sizeof(p->batch.values[i]));
+    if (p->batch.count == LOG_READER_BATCH)
+        flush_batch(p);
+}
+
+static void emit_text(parser_t *p, const uint8_t *text, size_t len) {
+    if (len && p->sink->on_text) {
+        flush_batch(p); // Mantém a ordem texto/amostras do arquivo
+        p->sink->on_text(p->sink->ctx, (const char *)text, len);
+    }
+}
+
+// CSV ou .imu pelos primeiros bytes. Sem o início do arquivo (primeiro bloco
+// do .lzb perdido), decide pelo conteúdo: o CSV é só texto.
+static content_t detect_content(const uint8_t *data, size_t len, bool at_start) {
+    if (len >= 4 && memcmp(data, IMU_CODEC_MAGIC, 4) == 0)
+        return CONTENT_IMU;
+    if (at_start)
+        return CONTENT_CSV;
+    for (size_t i = 0; i < len && i < 64; i++) {
+        uint8_t c = data[i];
+        if (c != '\n' && c != '\r' && (c < ' ' || c > '~'))
+            return CONTENT_IMU;
+    }
+    return CONTENT_CSV;
+}
+
+// "sample,v0,...,v5" sem sscanf. Retorna false se a linha não é uma amostra.
+static bool parse_csv_line(const char *s, const char *end, uint32_t *sample, int16_t values[]) {
+    int32_t field[1 + LOG_READER_CHANNELS];
+    for (int f = 0; f <= LOG_READER_CHANNELS; f++) {
+        bool neg = s < end && *s == '-';
+        s += neg;
+        if (s >= end || (unsigned)(*s - '0') > 9)
+            return false;
+        uint32_t v = 0;
+        while (s < end && (unsigned)(*s - '0') <= 9)
+            v = v * 10 + (uint32_t)(*s++ - '0');
+        field[f] = neg ? -(int32_t)v : (int32_t)v;
+        if (f == 0)
+            *sample = v;
+        if (f < LOG_READER_CHANNELS) {
+            if (s >= end || *s != ',')
+                return false;
+            s++;
+        }
+    }
+    while (s < end && *s == '\r')
+        s++;
+    if (s != end)
+        return false;
+    for (int c = 0; c < LOG_READER_CHANNELS; c++)
+        values[c] = (int16_t)field[1 + c];
+    return true;
+}
+
+static size_t parse_csv(parser_t *p, bool eof) {
+    const uint8_t *data = p->buf, *end = p->buf + p->len, *pos = data;
+    while (pos < end) {
+        const uint8_t *nl = memchr(pos, '\n', (size_t)(end - pos));
+        if (!nl && !eof)
+            break;
+        const uint8_t *line_end = nl ? nl : end;
+        if (*pos == '#') {
+            emit_text(p, pos, (size_t)(line_end - pos) + (nl != NULL));
+        } else if (*pos != 'S' && line_end > pos) { // 'S': linha de colunas
+            uint32_t sample = 0;
+            int16_t values[LOG_READER_CHANNELS];
+            if (parse_csv_line((const char *)pos, (const char *)line_end, &sample, values))
+                emit_sample(p, sample, values);
+            else
+                p->stats->bad_records++;
+        }
+        pos = nl ? nl + 1 : end;
+    }
+    return (size_t)(pos - data);
+}
+
+// Retorna os bytes consumidos, ou (size_t)-1 se o cabeçalho é inválido
+static size_t parse_imu(parser_t *p) {
+    const uint8_t *data = p->buf;
+    size_t pos = 0, used;
+    for (;;) {
+        size_t avail = p->len - pos;
+        switch (p->state) {
+        case STATE_HEADER: {
+            const char *text;
+            uint16_t text_len;
+            int32_t n = imu_codec_read_header(data + pos, avail, NULL, &text, &text_len);
+            if (n < 0)
+                return (size_t)-1;
+            if (n == 0)
+                return pos;
+            emit_text(p, (const uint8_t *)text, text_len);
+            pos += (size_t)n;
+            p->state = STATE_RECORDS;
+            break;
+        }
+        case STATE_RECORDS:
+            switch (imu_decoder_decode(&p->dec, data + pos, avail, &used)) {
+            case IMU_DECODE_SAMPLE:
+                emit_sample(p, p->dec.sample, p->dec.values);
+                pos += used;
+                break;
+            case IMU_DECODE_END:
+                pos += used;
+                p->state = STATE_TRAILER;
+                break;
+            case IMU_DECODE_NEED_MORE:
+                return pos;
+            case IMU_DECODE_ERROR:
+                // Sem keyframe não há como continuar: espera o próximo bloco
+                p->stats->bad_records++;
+                imu_decoder_init(&p->dec);
+                return p->len;
+            }
+            break;
+        case STATE_TRAILER: {
+            if (avail < 2)
+                return pos;
+            size_t text_len = data[pos] | (size_t)data[pos + 1] << 8;
+            if (avail < 2 + text_len)
+                return pos;
+            emit_text(p, data + pos + 2, text_len);
+            pos += 2 + text_len;
+            p->state = STATE_DONE;
+            break;
+        }
+        case STATE_DONE:
+            return p->len;
+        }
+    }
+}
+
+// Processa o que está em buf e guarda o resto para o próximo pedaço.
+// Retorna false se o conteúdo não é um log válido.
+static bool parser_run(parser_t *p, bool eof) {
+    size_t used;
+    if (p->content == CONTENT_CSV)
+        used = parse_csv(p, eof);
+    else
+        used = parse_imu(p);
+    if (used == (size_t)-1)
+        return false;
+    memmove(p->buf, p->buf + used, p->len - used);
+    p->len -= used;
+    return true;
+}
+
+static bool parser_feed(parser_t *p, const uint8_t *data, size_t n, bool at_start) {
+    if (p->content == CONTENT_UNKNOWN) {
+        p->content = detect_content(data, n, at_start);
+        p->state = p->content == CONTENT_IMU && at_start ? STATE_HEADER : STATE_RECORDS;
+    }
+    while (n) {
+        size_t room = sizeof(p->buf) - p->len;
+        if (room == 0) {
+            // Linha ou registro maior que o buffer: não é um log válido
+            p->stats->bad_records++;
+            p->len = 0;
+            room = sizeof(p->buf);
+        }
+        size_t take = n < room ? n : room;
+        memcpy(p->buf + p->len, data, take);
+        p->len += take;
+        data += take;
+        n -= take;
+        if (!parser_run(p, false))
+            return false;
+    }
+    return true;
+}
+
+// Dados perdidos (bloco ilegível): descarta o pedaço pendente e, no .imu,
+// volta a esperar um keyframe (cada bloco começa com um). O trecho perdido é
+// informado quando a próxima amostra (ou o próximo cabeçalho) diz onde acaba.
+static void parser_resync(parser_t *p) {
+    p->lost = true;
+    p->len = 0;
+    imu_decoder_init(&p->dec);
+    if (p->state == STATE_HEADER)
+        p->state = STATE_RECORDS;
+}
+
+// Fim do arquivo: processa a última linha sem '\n'. Retorna false se sobrou
+// um registro incompleto.
+static bool parser_finish(parser_t *p) {
+    if (p->content == CONTENT_CSV)
+        parser_run(p, true);
+    bool complete = p->len == 0;
+    if (p->lost)
+        report_lost(p, LOG_READER_TO_END);
+    flush_batch(p);
+    return complete;
+}
+
+static int read_stream(FILE *f, parser_t *p, uint8_t *chunk, char *err, size_t err_len) {
+    bool at_start = true;
+    size_t n;
+    while ((n = fread(chunk, 1, LOG_READER_CHUNK, f)) > 0) {
+        p->stats->bytes_in += n;
+        if (!parser_feed(p, chunk, n, at_start)) {
+            snprintf(err, err_len, "cabecalho .imu invalido");
+            return -1;
+        }
+        at_start = false;
+    }
+    if (!parser_finish(p)) {
+        snprintf(err, err_len, "registro incompleto no fim do arquivo");
+        return 1;
+    }
+    return 0;
+}
+
+// Bloco colunar (lib/column_block.h): as amostras saem direto dos vetores,
+// sem passar pelo parser de fluxo; o texto vem depois delas
+static void parse_columns(parser_t *p, const uint8_t *data, const block_frame_t *frame) {
+    p->content = CONTENT_COLUMNS;
+    for (uint32_t i = 0; i < frame->count; i++) {
+        int16_t values[LOG_READER_CHANNELS];
+        column_block_get(data, frame->count, i, values);
+        emit_sample(p, frame->first_sample + i, values);
+    }
+    size_t cols = (size_t)frame->count * COLUMN_BLOCK_ROW_SIZE;
+    emit_text(p, data + cols, frame->raw_len - cols);
+}
+
+static int read_blocks(FILE *f, parser_t *p, uint8_t *buf, uint8_t *raw, char *err,
+                       size_t err_len) {
+    uint64_t base = 0; // Offset no arquivo de buf[0]
+    size_t len = 0, pos = 0;
+    bool eof = false, in_garbage = false;
+    int result = 0;
+
+    for (;;) {
+        // Sempre um bloco inteiro à frente, enquanto houver arquivo
+        if (!eof && len - pos < BLOCK_FRAME_MAX_HEADER_SIZE + BLOCK_FRAME_MAX_RAW) {
+            memmove(buf, buf + pos, len - pos);
+            base += pos;
+            len -= pos;
+            pos = 0;
+            size_t want = BLOCK_BUF_SIZE - len;
+            size_t n = fread(buf + len, 1, want, f);
+            p->stats->bytes_in += n;
+            len += n;
+            eof = n < want;
+        }
+        if (pos == len)
+            break;
+
+        block_frame_t frame;
+        uint64_t offset = base + pos;
+        int header = block_frame_parse_header(buf + pos, len - pos, &frame);
+        if (header < 0) {
+            // Lixo: procura a próxima palavra de sincronismo com cabeçalho válido
+            if (!in_garbage) {
+                p->stats->bad_blocks++;
+                snprintf(err, err_len, "trecho ilegivel no byte %llu", (unsigned long long)offset);
+            }
+            in_garbage = true;
+            parser_resync(p);
+            result = 1;
+            pos = block_frame_find_sync(buf, len, pos + 1);
+            continue;
+        }
+        in_garbage = false;
+        if (header == 0 || len - pos < (size_t)header + frame.comp_len) {
+            // Só acontece no fim do arquivo: último bloco cortado
+            snprintf(err, err_len, "bloco truncado no byte %llu", (unsigned long long)offset);
+            p->stats->bad_blocks++;
+            parser_resync(p);
+            result = 1;
+            break;
+        }
+        const uint8_t *comp = buf + pos + header;
+        pos += (size_t)header + frame.comp_len;
+        p->stats->blocks++;
+
+        const uint8_t *data = comp;
+        int32_t raw_len = (int32_t)frame.raw_len;
+        if (frame.comp_len != frame.raw_len) {
+            raw_len = lz_block_decompress(comp, frame.comp_len, raw, BLOCK_FRAME_MAX_RAW);
+            data = raw;
+        }
+        if (raw_len != (int32_t)frame.raw_len || crc32_update(0, data, frame.raw_len) != frame.crc) {
+            // Com o cabeçalho v2 íntegro o próximo bloco está no lugar certo;
+            // no v1 um tamanho errado cai no lixo e é ressincronizado
+            p->stats->bad_blocks++;
+            parser_resync(p);
+            result = 1;
+            snprintf(err, err_len, "bloco ilegivel no byte %llu", (unsigned long long)offset);
+            continue;
+        }
+        if (frame.version == 2) {
+            p->prev = p->has_time ? p->cur : (anchor_t){0, 0};
+            p->cur = (anchor_t){frame.first_sample, frame.first_ms};
+            p->has_time = true;
+            if (p->lost)
+                report_lost(p, frame.first_sample);
+        }
+        if (frame.columns) {
+            parse_columns(p, data, &frame);
+            continue;
+        }
+        if (!parser_feed(p, data, frame.raw_len, offset == 0)) {
+            snprintf(err, err_len, "cabecalho .imu invalido");
+            return -1;
+        }
+    }
+    if (!parser_finish(p) && result == 0) {
+        snprintf(err, err_len, "registro incompleto no fim do arquivo");
+        result = 1;
+    }
+    return result;
+}
+
+int log_reader_run(const char *path, const log_reader_sink_t *sink,
+                   log_reader_stats_t *stats, char *err, size_t err_len) {
+    memset(stats, 0, sizeof(*stats));
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        snprintf(err, err_len, "nao foi possivel abrir");
+        return -1;
+    }
+
+    parser_t *p = calloc(1, sizeof(*p));
+    uint8_t *chunk = malloc(BLOCK_BUF_SIZE + BLOCK_FRAME_MAX_RAW);
+    if (!p || !chunk) {
+        snprintf(err, err_len, "sem memoria");
+        free(p);
+        free(chunk);
+        fclose(f);
+        return -1;
+    }
+    p->sink = sink;
+    p->stats = stats;
+
+    // .lzb pelo magic do primeiro bloco (versão 1 ou 2); o resto é lido como fluxo
+    uint8_t magic[4] = {0};
+    size_t n = fread(magic, 1, sizeof(magic), f);
+    rewind(f);
+    int result;
+    if (n == sizeof(magic) && (memcmp(magic, BLOCK_FRAME_MAGIC, 4) == 0 ||
+                               memcmp(magic, BLOCK_FRAME_MAGIC_COLUMNS, 4) == 0 ||
+                               memcmp(magic, BLOCK_FRAME_MAGIC_V1, 4) == 0))
+        result = read_blocks(f, p, chunk, chunk + BLOCK_BUF_SIZE, err, err_len);
+    else
+        result = read_stream(f, p, chunk, err, err_len);
+
+    free(chunk);
+    free(p);
+    fclose(f);
+    return result;
+}
@@ -0,0 +1,68 @@
+#ifndef LOG_READER_H
+#define LOG_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "imu_codec.h"
+
+// Leitura em fluxo dos logs do datalogger (.csv, .imu e .lzb), com memória
+// limitada: o arquivo é lido em pedaços de LOG_READER_CHUNK bytes e as
+// amostras saem em lotes de até LOG_READER_BATCH para o consumidor.
+//
+// Formatos: lib/imu_codec.h (.imu), lib/block_log.h (.lzb, que contém um .csv,
+// um .imu ou blocos colunares de lib/column_block.h), lib/block_frame.h
+// (cabeçalho dos blocos) e lib/log_meta.h (texto "# chave=valor" do cabeçalho
+// e trailer).
+
+#define LOG_READER_CHUNK (64 * 1024)
+#define LOG_READER_BATCH 1024
+#define LOG_READER_CHANNELS IMU_CODEC_CHANNELS
+
+typedef struct {
+    uint32_t sample[LOG_READER_BATCH];
+    int16_t values[LOG_READER_BATCH][LOG_READER_CHANNELS];
+    size_t count;
+} log_batch_t;
+
+// Trecho perdido (bloco .lzb ilegível ou fim truncado): amostras
+// [first_sample, end_sample). end_sample = LOG_READER_TO_END quando a perda vai
+// até o fim do arquivo. Os tempos vêm dos cabeçalhos dos blocos (versão 2),
+// interpolados entre os blocos válidos vizinhos; sem eles has_time é false.
+#define LOG_READER_TO_END UINT32_MAX
+
+typedef struct {
+    uint32_t first_sample;
+    uint32_t end_sample;
+    uint32_t first_ms;
+    uint32_t end_ms;
+    bool has_time;
+} log_lost_t;
+
+typedef struct {
+    // Texto de metadados, na ordem do arquivo (cabeçalho antes das amostras,
+    // trailer depois). Linhas "# chave=valor\n".
+    void (*on_text)(void *ctx, const char *text, size_t len);
+    void (*on_batch)(void *ctx, const log_batch_t *batch);
+    void (*on_lost)(void *ctx, const log_lost_t *lost); // Opcional
+    void *ctx;
+} log_reader_sink_t;
+
+typedef struct {
+    uint64_t bytes_in;
+    uint64_t samples;
+    uint32_t blocks;     // Blocos .lzb lidos
+    uint32_t bad_blocks; // Blocos ou trechos ilegíveis (pulados)
+    uint32_t lost_ranges; // Trechos de amostras perdidas (ver log_lost_t)
+    uint32_t bad_records; // Registros ou linhas que não decodificaram
+} log_reader_stats_t;
+
+// Lê o arquivo inteiro, entregando as amostras ao sink. Retorna 0 se tudo foi
+// lido, 1 se parte do arquivo foi perdida (bloco ilegível, fim truncado) e -1
+// se o arquivo não pôde ser aberto ou não é um log; nos dois últimos casos a
+// mensagem vai em err.
+int log_reader_run(const char *path, const log_reader_sink_t *sink,
+                   log_reader_stats_t *stats, char *err, size_t err_len);
+
+#endif
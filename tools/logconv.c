@@ -0,0 +1,312 @@
+// Conversor dos logs do datalogger (.csv, .imu, .lzb) para CSV ou NumPy.
+//
+//   logconv [-f csv|npy|cols|null] [-j threads] [-o pasta] [-q] arquivo|pasta...
+//
+// Pastas são varridas (sem recursão) atrás de .csv/.imu/.lzb. Cada arquivo é
+// decodificado em fluxo por uma thread; os arquivos são divididos entre os
+// núcleos. Ao final mostra a vazão total (MB/s de entrada e amostras/s).
+// Trechos perdidos de um .lzb (blocos ilegíveis) são listados em amostras e,
+// com cabeçalhos de bloco versão 2, em segundos.
+
+#include <dirent.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "log_output.h"
+#include "log_reader.h"
+#include "work_pool.h"
+
+typedef struct {
+    char *path;
+    char *base; // Caminho de saída sem extensão
+    uint64_t size;
+} job_t;
+
+typedef struct {
+    job_t *jobs;
+    size_t count;
+    size_t cap;
+    log_output_format_t format;
+    const char *out_dir;
+    bool quiet;
+
+    pthread_mutex_t lock; // Protege os totais e a saída no terminal
+    uint64_t bytes_in, bytes_out, samples;
+    unsigned failed;
+} conv_t;
+
+static bool is_log_file(const char *name) {
+    const char *dot = strrchr(name, '.');
+    return dot && (strcmp(dot, ".csv") == 0 || strcmp(dot, ".imu") == 0 ||
+                   strcmp(dot, ".lzb") == 0);
+}
+
+static char *join_path(const char *dir, const char *name) {
+    size_t len = strlen(dir) + strlen(name) + 2;
+    char *path = malloc(len);
+    if (path)
+        snprintf(path, len, "%s/%s", dir, name);
+    return path;
+}
+
+static int add_job(conv_t *conv, const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (conv->count == conv->cap) {
+        size_t cap = conv->cap ? conv->cap * 2 : 64;
+        job_t *jobs = realloc(conv->jobs, cap * sizeof(*jobs));
+        if (!jobs)
+            return -1;
+        conv->jobs = jobs;
+        conv->cap = cap;
+    }
+
+    // Saída: mesma pasta da entrada (ou -o), mesmo nome sem a extensão
+    const char *slash = strrchr(path, '/');
+    const char *name = slash ? slash + 1 : path;
+    const char *dot = strrchr(name, '.');
+    size_t stem = dot ? (size_t)(dot - name) : strlen(name);
+    char *dir = conv->out_dir ? strdup(conv->out_dir)
+                              : (slash ? strndup(path, (size_t)(slash - path)) : strdup("."));
+    char *file = strndup(name, stem);
+    job_t *job = &conv->jobs[conv->count];
+    job->path = strdup(path);
+    job->base = dir && file ? join_path(dir, file) : NULL;
+    job->size = (uint64_t)st.st_size;
+    free(dir);
+    free(file);
+    if (!job->path || !job->base)
+        return -1;
+    conv->count++;
+    return 0;
+}
+
+static int add_input(conv_t *conv, const char *path) {
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(path);
+        if (!dir) {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            return -1;
+        }
+        struct dirent *entry;
+        int rc = 0;
+        while ((entry = readdir(dir)) != NULL) {
+            if (!is_log_file(entry->d_name))
+                continue;
+            char *file = join_path(path, entry->d_name);
+            if (!file || add_job(conv, file) != 0)
+                rc = -1;
+            free(file);
+        }
+        closedir(dir);
+        return rc;
+    }
+    return add_job(conv, path);
+}
+
+static int by_base(const void *a, const void *b) {
+    return strcmp(((const job_t *)a)->base, ((const job_t *)b)->base);
+}
+
+// Duas entradas com o mesmo nome (log_000.imu e log_000.lzb, ou pastas
+// diferentes com -o) gravariam na mesma saída
+static bool has_duplicate_outputs(conv_t *conv) {
+    bool dup = false;
+    qsort(conv->jobs, conv->count, sizeof(conv->jobs[0]), by_base);
+    for (size_t i = 1; i < conv->count; i++) {
+        if (strcmp(conv->jobs[i - 1].base, conv->jobs[i].base) == 0) {
+            fprintf(stderr, "%s e %s gravariam na mesma saida %s\n", conv->jobs[i - 1].path,
+                    conv->jobs[i].path, conv->jobs[i].base);
+            dup = true;
+        }
+    }
+    return dup;
+}
+
+// Maiores primeiro: o último arquivo a começar é pequeno e as threads
+// terminam juntas
+static int by_size_desc(const void *a, const void *b) {
+    const job_t *ja = a, *jb = b;
+    return ja->size < jb->size ? 1 : ja->size > jb->size ? -1 : 0;
+}
+
+// Saída de um arquivo: o log_output_t e onde informar os trechos perdidos
+typedef struct {
+    log_output_t out;
+    conv_t *conv;
+    const job_t *job;
+} job_out_t;
+
+static void job_text(void *ctx, const char *text, size_t len) {
+    log_output_text(&((job_out_t *)ctx)->out, text, len);
+}
+
+static void job_batch(void *ctx, const log_batch_t *batch) {
+    log_output_batch(&((job_out_t *)ctx)->out, batch);
+}
+
+static void job_lost(void *ctx, const log_lost_t *lost) {
+    job_out_t *jo = ctx;
+    char range[96];
+    if (lost->end_sample == LOG_READER_TO_END)
+        snprintf(range, sizeof(range), "amostras %lu ate o fim", (unsigned long)lost->first_sample);
+    else
+        snprintf(range, sizeof(range), "amostras %lu a %lu", (unsigned long)lost->first_sample,
+                 (unsigned long)lost->end_sample - 1);
+    pthread_mutex_lock(&jo->conv->lock);
+    printf("%s: perdidas %s", jo->job->path, range);
+    if (lost->has_time && lost->end_sample == LOG_READER_TO_END)
+        printf(" (de %.3f s ate o fim)", lost->first_ms / 1000.0);
+    else if (lost->has_time)
+        printf(" (%.3f s a %.3f s)", lost->first_ms / 1000.0, lost->end_ms / 1000.0);
+    printf("\n");
+    pthread_mutex_unlock(&jo->conv->lock);
+}
+
+static void convert_one(size_t item, void *ctx) {
+    conv_t *conv = ctx;
+    const job_t *job = &conv->jobs[item];
+    log_reader_stats_t stats = {0};
+    job_out_t jo = {.conv = conv, .job = job};
+    log_output_t *out = &jo.out;
+    uint64_t bytes_out = 0;
+    char err[128] = "";
+    int rc;
+
+    // Não sobrescreve o próprio CSV de entrada
+    size_t base_len = strlen(job->base);
+    if (conv->format == LOG_OUTPUT_CSV && strncmp(job->path, job->base, base_len) == 0 &&
+        strcmp(job->path + base_len, ".csv") == 0) {
+        snprintf(err, sizeof(err), "saida igual a entrada (use -o)");
+        rc = -1;
+    } else if ((rc = log_output_open(out, conv->format, job->base)) != 0) {
+        snprintf(err, sizeof(err), "saida: %s", strerror(rc));
+        rc = -1;
+    } else {
+        log_reader_sink_t sink = {job_text, job_batch, job_lost, &jo};
+        rc = log_reader_run(job->path, &sink, &stats, err, sizeof(err));
+        int out_err = log_output_close(out);
+        bytes_out = out->bytes_out;
+        if (out_err) {
+            snprintf(err, sizeof(err), "saida: %s", strerror(out_err));
+            rc = -1;
+        }
+    }
+
+    pthread_mutex_lock(&conv->lock);
+    conv->bytes_in += stats.bytes_in;
+    conv->samples += stats.samples;
+    conv->bytes_out += bytes_out;
+    if (rc != 0)
+        conv->failed++;
+    if (!conv->quiet || rc != 0) {
+        printf("%s: %llu amostras", job->path, (unsigned long long)stats.samples);
+        if (stats.blocks)
+            printf(", %u blocos (%u ilegiveis)", stats.blocks, stats.bad_blocks);
+        if (stats.bad_records)
+            printf(", %u registros invalidos", stats.bad_records);
+        if (rc != 0)
+            printf(" - %s: %s", rc < 0 ? "ERRO" : "aviso", err);
+        printf("\n");
+    }
+    pthread_mutex_unlock(&conv->lock);
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "uso: logconv [-f csv|npy|cols|null] [-j threads] [-o pasta] [-q] arquivo|pasta...\n"
+            "  -f  formato de saida (padrao csv; null so decodifica)\n"
+            "  -j  threads (padrao: numero de nucleos)\n"
+            "  -o  pasta de saida (padrao: a do arquivo de entrada)\n"
+            "  -q  mostra so os arquivos com erro\n");
+}
+
+int main(int argc, char **argv) {
+    conv_t conv = {.format = LOG_OUTPUT_CSV};
+    unsigned threads = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:j:o:qh")) != -1) {
+        switch (opt) {
+        case 'f': {
+            int format = log_output_parse_format(optarg);
+            if (format < 0) {
+                fprintf(stderr, "formato invalido: %s\n", optarg);
+                return 2;
+            }
+            conv.format = (log_output_format_t)format;
+            break;
+        }
+        case 'j':
+            threads = (unsigned)atoi(optarg);
+            break;
+        case 'o':
+            conv.out_dir = optarg;
+            break;
+        case 'q':
+            conv.quiet = true;
+            break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        usage();
+        return 2;
+    }
+    if (conv.out_dir)
+        mkdir(conv.out_dir, 0777);
+
+    for (int i = optind; i < argc; i++) {
+        if (add_input(&conv, argv[i]) != 0)
+            conv.failed++;
+    }
+    if (conv.count == 0) {
+        fprintf(stderr, "nenhum log encontrado\n");
+        return 1;
+    }
+    if (has_duplicate_outputs(&conv))
+        return 1;
+    qsort(conv.jobs, conv.count, sizeof(conv.jobs[0]), by_size_desc);
+
+    if (threads == 0)
+        threads = work_pool_cpu_count();
+    pthread_mutex_init(&conv.lock, NULL);
+    double t0 = now_s();
+    work_pool_run(conv.count, threads, convert_one, &conv);
+    double elapsed = now_s() - t0;
+    pthread_mutex_destroy(&conv.lock);
+
+    double mb_in = conv.bytes_in / 1e6, mb_out = conv.bytes_out / 1e6;
+    printf("%zu arquivos, %u threads: %.1f MB lidos, %.1f MB gravados, %llu amostras em %.2f s\n",
+           conv.count, threads < conv.count ? threads : (unsigned)conv.count, mb_in, mb_out,
+           (unsigned long long)conv.samples, elapsed);
+    if (elapsed > 0)
+        printf("vazao: %.1f MB/s de entrada, %.1f M amostras/s\n", mb_in / elapsed,
+               conv.samples / elapsed / 1e6);
+
+    for (size_t i = 0; i < conv.count; i++) {
+        free(conv.jobs[i].path);
+        free(conv.jobs[i].base);
+    }
+    free(conv.jobs);
+    return conv.failed ? 1 : 0;
+}
@@ -0,0 +1,273 @@
+// Gerador de logs sintéticos para medir o conversor (logconv) com volumes
+// maiores que os de uma sessão real.
+//
+//   loggen [-f csv|delta|columns] [-c] [-n arquivos] [-s MB por arquivo] [-j threads] pasta
+//
+// Usa os mesmos codificadores do firmware (lib/): cabeçalho e trailer de
+// lib/log_meta.c, registros de lib/csv_format.c ou lib/imu_codec.c e, com -c,
+// blocos comprimidos como os de lib/block_log.c. "columns" grava sempre em
+// blocos colunares (lib/column_block.h), comprimidos só com -c. O sinal imita o MPU6050 em
+// repouso com movimentos lentos e ruído, para a compressão ser realista.
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "block_frame.h"
+#include "column_block.h"
+#include "crc32.h"
+#include "csv_format.h"
+#include "imu_codec.h"
+#include "log_meta.h"
+#include "lz_block.h"
+#include "work_pool.h"
+
+#define BLOCK_SIZE 4096 // BLOCK_LOG_BLOCK_SIZE
+#define BLOCK_HEADER_SIZE BLOCK_FRAME_HEADER_SIZE
+#define PERIOD_MS 100
+
+typedef struct {
+    bool delta;
+    bool columns;
+    bool compress;
+    uint64_t bytes_per_file;
+    const char *dir;
+    unsigned failed;
+} gen_t;
+
+// Estado de um arquivo sendo gerado
+typedef struct {
+    FILE *f;
+    bool blocks;   // .lzb
+    bool compress; // Blocos comprimidos
+    bool columns;  // Blocos colunares: raw tem linhas de seis int16 ou texto
+    uint32_t rows;
+    uint64_t total;
+    uint8_t raw[BLOCK_SIZE] __attribute__((aligned(4)));
+    uint32_t raw_len;
+    uint32_t seq;
+    uint32_t first_sample; // Primeira amostra do bloco em raw
+    uint32_t sample;       // Próxima amostra a gerar
+    uint8_t columns_buf[BLOCK_SIZE]; // Bloco colunar transposto
+    uint8_t block[BLOCK_FRAME_MAX_HEADER_SIZE + BLOCK_SIZE];
+    uint16_t hash[LZ_BLOCK_HASH_SIZE];
+    imu_encoder_t enc;
+    uint32_t rng;
+} writer_t;
+
+static void seal_block(writer_t *w) {
+    if (w->raw_len == 0)
+        return;
+    block_frame_t frame = {
+        .seq = w->seq++, .first_sample = w->first_sample,
+        .first_ms = w->first_sample * PERIOD_MS, .raw_len = w->raw_len,
+        .columns = w->columns, .count = (uint16_t)w->rows,
+    };
+    const uint8_t *src = w->raw;
+    if (w->columns) {
+        column_block_pack((const int16_t (*)[COLUMN_BLOCK_CHANNELS])w->raw, w->rows, w->columns_buf,
+                          frame.min, frame.max);
+        if (w->rows)
+            src = w->columns_buf;
+    }
+    size_t header = w->columns ? BLOCK_FRAME_HEADER_SIZE_COLUMNS : BLOCK_FRAME_HEADER_SIZE;
+    size_t comp = 0;
+    if (w->compress)
+        comp = lz_block_compress(src, w->raw_len, w->block + header, w->raw_len - 1, w->hash);
+    if (comp == 0) { // Não comprimiu: grava bruto
+        memcpy(w->block + header, src, w->raw_len);
+        comp = w->raw_len;
+    }
+    frame.comp_len = (uint32_t)comp;
+    frame.crc = crc32_update(0, src, w->raw_len);
+    block_frame_write_header(w->block, &frame);
+    w->first_sample = w->sample;
+    fwrite(w->block, 1, header + comp, w->f);
+    w->total += header + comp;
+    w->raw_len = 0;
+    w->rows = 0;
+}
+
+// Espaço para um registro de até n bytes (como log_reserve no firmware). No
+// colunar, row diz se é uma amostra: texto e amostras ficam em blocos separados.
+static uint8_t *reserve(writer_t *w, uint32_t n, bool row) {
+    bool mixed = w->columns && w->raw_len && row != (w->rows > 0);
+    if (w->raw_len + n > BLOCK_SIZE || mixed) {
+        if (w->blocks) {
+            seal_block(w);
+            imu_encoder_force_keyframe(&w->enc); // Cada bloco decodifica sozinho
+        } else {
+            fwrite(w->raw, 1, w->raw_len, w->f);
+            w->total += w->raw_len;
+            w->raw_len = 0;
+        }
+    }
+    return w->raw + w->raw_len;
+}
+
+static uint32_t next_random(writer_t *w) {
+    w->rng = w->rng * 1664525u + 1013904223u;
+    return w->rng >> 8;
+}
+
+// Ruído de ±amp com distribuição aproximadamente triangular
+static int32_t noise(writer_t *w, int32_t amp) {
+    int32_t a = (int32_t)(next_random(w) % (2 * amp + 1)) - amp;
+    int32_t b = (int32_t)(next_random(w) % (2 * amp + 1)) - amp;
+    return (a + b) / 2;
+}
+
+static void generate_file(size_t item, void *ctx) {
+    gen_t *gen = ctx;
+    char name[32], path[512];
+    snprintf(name, sizeof(name), "log_%03zu.%s", item,
+             gen->compress || gen->columns ? "lzb" : gen->delta ? "imu" : "csv");
+    snprintf(path, sizeof(path), "%s/%s", gen->dir, name);
+
+    writer_t *w = calloc(1, sizeof(*w));
+    if (!w || !(w->f = fopen(path, "wb"))) {
+        fprintf(stderr, "%s: nao foi possivel criar\n", path);
+        __atomic_fetch_add(&gen->failed, 1, __ATOMIC_RELAXED);
+        free(w);
+        return;
+    }
+    setvbuf(w->f, NULL, _IOFBF, 256 * 1024);
+    w->compress = gen->compress;
+    w->columns = gen->columns;
+    w->blocks = gen->compress || gen->columns;
+    w->rng = 12345u + (uint32_t)item * 7919u;
+    imu_encoder_init(&w->enc, IMU_CODEC_KEYFRAME);
+
+    char meta[LOG_META_MAX_SIZE];
+    const log_meta_header_t header = {
+        .firmware = "loggen", .profile = "full", .format = gen->columns ? "columns" : gen->delta ? "delta" : "csv",
+        .file = name, .compressed = gen->compress, .period_ms = PERIOD_MS,
+        .accel_fs_g = 2, .gyro_fs_dps = 250, .temp_raw = -1500, .uptime_ms = 5000,
+    };
+    size_t meta_len = log_meta_format_header(meta, &header);
+    if (gen->columns) {
+        memcpy(reserve(w, (uint32_t)meta_len, false), meta, meta_len);
+        w->raw_len += meta_len;
+    } else if (gen->delta) {
+        uint8_t *dst = reserve(w, IMU_CODEC_HEADER_SIZE + (uint32_t)meta_len, false);
+        w->raw_len += imu_codec_write_header(&w->enc, dst, meta, (uint16_t)meta_len);
+    } else {
+        static const char columns[] = "Sample,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ\n";
+        uint8_t *dst = reserve(w, sizeof(columns) - 1 + (uint32_t)meta_len, false);
+        memcpy(dst, columns, sizeof(columns) - 1);
+        memcpy(dst + sizeof(columns) - 1, meta, meta_len);
+        w->raw_len += sizeof(columns) - 1 + meta_len;
+    }
+
+    // Acelerômetro perto de (0, 0, 1 g) e giroscópio perto de zero, com
+    // derivas lentas e ruído
+    int32_t level[IMU_CODEC_CHANNELS] = {0, 0, 16384, 0, 0, 0};
+    int32_t drift[IMU_CODEC_CHANNELS] = {0};
+    while (w->total + w->raw_len < gen->bytes_per_file) {
+        int16_t values[IMU_CODEC_CHANNELS];
+        for (int c = 0; c < IMU_CODEC_CHANNELS; c++) {
+            if (next_random(w) % 64 == 0)
+                drift[c] = noise(w, c < 3 ? 40 : 20);
+            level[c] += drift[c];
+            if (level[c] > 30000 || level[c] < -30000)
+                drift[c] = -drift[c];
+            int32_t v = level[c] + noise(w, c < 3 ? 60 : 25);
+            values[c] = (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+        }
+        if (gen->columns) {
+            memcpy(reserve(w, COLUMN_BLOCK_ROW_SIZE, true), values, COLUMN_BLOCK_ROW_SIZE);
+            w->raw_len += COLUMN_BLOCK_ROW_SIZE;
+            w->rows++;
+        } else if (gen->delta) {
+            uint8_t *dst = reserve(w, IMU_CODEC_MAX_RECORD, false);
+            w->raw_len += imu_encoder_encode(&w->enc, w->sample, values, dst);
+        } else {
+            uint8_t *dst = reserve(w, CSV_FORMAT_MAX_RECORD, false);
+            w->raw_len += csv_format_record((char *)dst, w->sample, values);
+        }
+        w->sample++;
+    }
+
+    const log_meta_trailer_t trailer = {
+        .samples = w->sample, .duration_ms = w->sample * PERIOD_MS, .temp_raw = -1400,
+        .encode_ns_per_sample = 0, .stop = "botao",
+    };
+    meta_len = log_meta_format_trailer(meta, &trailer);
+    if (gen->delta && !gen->columns) {
+        uint8_t *dst = reserve(w, IMU_CODEC_TRAILER_SIZE + (uint32_t)meta_len, false);
+        w->raw_len += imu_codec_write_trailer(dst, meta, (uint16_t)meta_len);
+    } else {
+        memcpy(reserve(w, (uint32_t)meta_len, false), meta, meta_len);
+        w->raw_len += meta_len;
+    }
+    if (w->blocks) {
+        seal_block(w);
+    } else {
+        fwrite(w->raw, 1, w->raw_len, w->f);
+        w->total += w->raw_len;
+    }
+    if (fclose(w->f) != 0) {
+        fprintf(stderr, "%s: erro de escrita\n", path);
+        __atomic_fetch_add(&gen->failed, 1, __ATOMIC_RELAXED);
+    }
+    free(w);
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "uso: loggen [-f csv|delta|columns] [-c] [-n arquivos] [-s MB] [-j threads] pasta\n"
+            "  -f  formato (padrao delta; columns grava sempre em blocos .lzb)\n"
+            "  -c  comprime em blocos (.lzb)\n"
+            "  -n  numero de arquivos (padrao 8)\n"
+            "  -s  tamanho aproximado de cada arquivo em MB (padrao 64)\n"
+            "  -j  threads (padrao: numero de nucleos)\n");
+}
+
+int main(int argc, char **argv) {
+    gen_t gen = {.delta = true, .bytes_per_file = 64ull << 20};
+    size_t files = 8;
+    unsigned threads = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:cn:s:j:h")) != -1) {
+        switch (opt) {
+        case 'f':
+            if (strcmp(optarg, "csv") != 0 && strcmp(optarg, "delta") != 0 &&
+                strcmp(optarg, "columns") != 0) {
+                usage();
+                return 2;
+            }
+            gen.delta = strcmp(optarg, "delta") == 0;
+            gen.columns = strcmp(optarg, "columns") == 0;
+            break;
+        case 'c':
+            gen.compress = true;
+            break;
+        case 'n':
+            files = (size_t)atol(optarg);
+            break;
+        case 's':
+            gen.bytes_per_file = (uint64_t)(atof(optarg) * (1 << 20));
+            break;
+        case 'j':
+            threads = (unsigned)atoi(optarg);
+            break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+    if (optind != argc - 1 || files == 0) {
+        usage();
+        return 2;
+    }
+    gen.dir = argv[optind];
+    mkdir(gen.dir, 0777);
+
+    work_pool_run(files, threads, generate_file, &gen);
+    printf("%zu arquivos de ~%.0f MB em %s\n", files, gen.bytes_per_file / 1048576.0, gen.dir);
+    return gen.failed ? 1 : 0;
+}
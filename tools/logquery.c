@@ -0,0 +1,547 @@
+// Busca nos logs colunares do datalogger (formato "columns", ver
+// lib/column_block.h) pelos trechos em que uma condição sobre os canais vale.
+//
+//   logquery -w condição [-w condição...] [-r] [-x] [-j threads] arquivo|pasta...
+//
+// Condição: canal op valor, por exemplo '|accel|>1.5', 'gz<-200' ou '|ax|>0.8'.
+//   canal  ax ay az gx gy gz; |ax| ... para o valor absoluto; |accel| e
+//          |gyro| para o módulo do vetor
+//   op     > ou <
+//   valor  em g e °/s, pelo fundo de escala gravado no log, ou em unidades
+//          brutas do MPU6050 com -r
+// Com várias condições basta uma valer.
+//
+// Sem -x só os cabeçalhos dos blocos são lidos (60 bytes a cada ~4 KB). O
+// mínimo e o máximo de cada canal dizem se o bloco pode ter uma amostra que
+// satisfaz a condição, e os trechos saem com a resolução de um bloco. Para um
+// canal com > ou < e para |canal| > valor a resposta é exata, porque o mínimo
+// e o máximo são valores de amostras. Para |canal| < valor e para o módulo o
+// cabeçalho só diz que o bloco pode ter a amostra; esses trechos saem
+// marcados com '?'. Com -x só os blocos candidatos são lidos e descomprimidos,
+// e os trechos saem amostra a amostra.
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "block_frame.h"
+#include "column_block.h"
+#include "crc32.h"
+#include "lz_block.h"
+#include "work_pool.h"
+
+#define MAX_CONDS 16
+#define NORM_ACCEL 6 // Canais "virtuais": módulo do vetor
+#define NORM_GYRO 7
+#define SYNC_WINDOW (64 * 1024)
+
+typedef struct {
+    int channel;  // 0..5 (AccelX..GyroZ), NORM_ACCEL ou NORM_GYRO
+    bool abs;     // |canal|
+    bool greater; // '>' (senão '<')
+    double value; // Nas unidades da linha de comando
+} cond_t;
+
+typedef enum { MATCH_NO, MATCH_MAYBE, MATCH_YES } match_t;
+
+typedef struct {
+    char *path;
+    uint64_t size;
+    char *out; // Resultado, impresso na ordem dos arquivos
+    size_t out_len;
+} job_t;
+
+typedef struct {
+    job_t *jobs;
+    size_t count;
+    size_t cap;
+    cond_t conds[MAX_CONDS];
+    int n_conds;
+    bool raw_units;
+    bool exact;
+
+    pthread_mutex_t lock; // Protege os totais
+    uint64_t bytes_total, bytes_read;
+    uint64_t blocks, candidates, ranges;
+    unsigned failed;
+} query_t;
+
+// Trechos encontrados em um arquivo, já unidos
+typedef struct {
+    bool open;
+    bool maybe;
+    uint32_t first, end; // Amostras [first, end)
+    uint32_t first_ms, end_ms;
+} range_t;
+
+// Estado da busca em um arquivo
+typedef struct {
+    const query_t *q;
+    int fd;
+    FILE *out;
+    double threshold[MAX_CONDS]; // Valores das condições em unidades brutas
+    bool have_scale;
+    uint32_t period_ms;
+    range_t range;
+    uint64_t bytes_read;
+    uint32_t blocks, candidates, ranges, bad;
+    uint8_t payload[BLOCK_FRAME_MAX_RAW];
+    uint8_t raw[BLOCK_FRAME_MAX_RAW];
+} scan_t;
+
+static const char *const channel_names[] = {"ax", "ay", "az", "gx", "gy", "gz", "accel", "gyro"};
+
+// "|accel|>1.5", "gz<-200"... Retorna false se a condição é inválida.
+static bool parse_cond(const char *s, cond_t *cond) {
+    bool abs = *s == '|';
+    s += abs;
+    size_t len = strcspn(s, "|<>");
+    cond->channel = -1;
+    for (int c = 0; c < 8; c++) {
+        if (strlen(channel_names[c]) == len && strncmp(s, channel_names[c], len) == 0)
+            cond->channel = c;
+    }
+    s += len;
+    if (cond->channel < 0 || abs != (*s == '|'))
+        return false;
+    if (cond->channel >= NORM_ACCEL && !abs)
+        return false; // O módulo só se escreve |accel| e |gyro|
+    s += abs;
+    if (*s != '<' && *s != '>')
+        return false;
+    cond->abs = abs;
+    cond->greater = *s++ == '>';
+    char *end;
+    cond->value = strtod(s, &end);
+    return end != s && *end == '\0';
+}
+
+static bool is_accel(int channel) {
+    return channel < 3 || channel == NORM_ACCEL;
+}
+
+// Menor e maior |v| possíveis com v em [lo, hi]; exact diz se o menor é o
+// valor de uma amostra (o intervalo não passa pelo zero)
+static void abs_bounds(int16_t lo, int16_t hi, double *min_abs, double *max_abs, bool *exact) {
+    double a = fabs((double)lo), b = fabs((double)hi);
+    *max_abs = a > b ? a : b;
+    *exact = lo > 0 || hi < 0;
+    *min_abs = *exact ? (a < b ? a : b) : 0.0;
+}
+
+// A condição pode valer em algum ponto do bloco, pelo mínimo e máximo do
+// cabeçalho?
+static match_t match_header(const cond_t *c, double t, const block_frame_t *frame) {
+    if (c->channel < NORM_ACCEL) {
+        double lo = frame->min[c->channel], hi = frame->max[c->channel];
+        if (!c->abs)
+            return (c->greater ? hi > t : lo < t) ? MATCH_YES : MATCH_NO;
+        double min_abs, max_abs;
+        bool exact;
+        abs_bounds(frame->min[c->channel], frame->max[c->channel], &min_abs, &max_abs, &exact);
+        if (c->greater)
+            return max_abs > t ? MATCH_YES : MATCH_NO;
+        return min_abs < t ? (exact ? MATCH_YES : MATCH_MAYBE) : MATCH_NO;
+    }
+    // Módulo: limites pelos limites de cada eixo
+    int base = c->channel == NORM_ACCEL ? 0 : 3;
+    double lo2 = 0, hi2 = 0;
+    for (int i = base; i < base + 3; i++) {
+        double min_abs, max_abs;
+        bool exact;
+        abs_bounds(frame->min[i], frame->max[i], &min_abs, &max_abs, &exact);
+        lo2 += min_abs * min_abs;
+        hi2 += max_abs * max_abs;
+    }
+    bool possible = c->greater ? hi2 > t * t || t < 0 : lo2 < t * t && t > 0;
+    return possible ? MATCH_MAYBE : MATCH_NO;
+}
+
+static bool match_sample(const cond_t *c, double t, const int16_t values[]) {
+    double v;
+    if (c->channel < NORM_ACCEL) {
+        v = c->abs ? fabs((double)values[c->channel]) : values[c->channel];
+    } else {
+        int base = c->channel == NORM_ACCEL ? 0 : 3;
+        v = sqrt((double)values[base] * values[base] + (double)values[base + 1] * values[base + 1] +
+                 (double)values[base + 2] * values[base + 2]);
+    }
+    return c->greater ? v > t : v < t;
+}
+
+// Valor inteiro de "# chave=valor" no texto de metadados
+static bool meta_value(const char *text, size_t len, const char *key, double *value) {
+    char pattern[48];
+    snprintf(pattern, sizeof(pattern), "# %s=", key);
+    size_t plen = strlen(pattern);
+    for (size_t i = 0; i + plen <= len; i++) {
+        if ((i == 0 || text[i - 1] == '\n') && memcmp(text + i, pattern, plen) == 0) {
+            char num[32];
+            size_t n = 0;
+            for (i += plen; i < len && text[i] != '\n' && n < sizeof(num) - 1; i++)
+                num[n++] = text[i];
+            num[n] = '\0';
+            *value = atof(num);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void read_meta(scan_t *s, const char *text, size_t len) {
+    double accel_lsb, gyro_lsb, period;
+    if (meta_value(text, len, "period_ms", &period))
+        s->period_ms = (uint32_t)period;
+    if (s->have_scale || !meta_value(text, len, "accel_lsb_per_g", &accel_lsb) ||
+        !meta_value(text, len, "gyro_lsb_per_dps", &gyro_lsb))
+        return;
+    for (int i = 0; i < s->q->n_conds; i++) {
+        const cond_t *c = &s->q->conds[i];
+        s->threshold[i] = c->value * (is_accel(c->channel) ? accel_lsb : gyro_lsb);
+    }
+    s->have_scale = true;
+}
+
+static double sample_s(const scan_t *s, const block_frame_t *frame, uint32_t sample) {
+    return (frame->first_ms + (double)(sample - frame->first_sample) * s->period_ms) / 1000.0;
+}
+
+static void flush_range(scan_t *s) {
+    range_t *r = &s->range;
+    if (!r->open)
+        return;
+    fprintf(s->out, "  %10.3f s a %10.3f s  (amostras %u a %u)%s\n", r->first_ms / 1000.0,
+            r->end_ms / 1000.0, r->first, r->end - 1, r->maybe ? " ?" : "");
+    s->ranges++;
+    r->open = false;
+}
+
+// Acrescenta as amostras [first, end) aos trechos, unindo com o anterior se
+// forem contíguas
+static void add_range(scan_t *s, const block_frame_t *frame, uint32_t first, uint32_t end,
+                      bool maybe) {
+    range_t *r = &s->range;
+    uint32_t first_ms = (uint32_t)(sample_s(s, frame, first) * 1000.0 + 0.5);
+    uint32_t end_ms = (uint32_t)(sample_s(s, frame, end) * 1000.0 + 0.5);
+    if (r->open && first == r->end) {
+        r->end = end;
+        r->end_ms = end_ms;
+        r->maybe |= maybe;
+        return;
+    }
+    flush_range(s);
+    *r = (range_t){true, maybe, first, end, first_ms, end_ms};
+}
+
+// Lê e valida os dados do bloco; retorna os dados brutos ou NULL
+static const uint8_t *read_payload(scan_t *s, uint64_t pos, int header, const block_frame_t *frame) {
+    ssize_t n = pread(s->fd, s->payload, frame->comp_len, (off_t)(pos + (uint64_t)header));
+    if (n != (ssize_t)frame->comp_len)
+        return NULL;
+    s->bytes_read += (uint64_t)n;
+    const uint8_t *data = s->payload;
+    if (frame->comp_len != frame->raw_len) {
+        if (lz_block_decompress(s->payload, frame->comp_len, s->raw, sizeof(s->raw)) !=
+            (int32_t)frame->raw_len)
+            return NULL;
+        data = s->raw;
+    }
+    return crc32_update(0, data, frame->raw_len) == frame->crc ? data : NULL;
+}
+
+// Bloco com amostras: decide pelo cabeçalho ou, com -x, amostra a amostra
+static void scan_block(scan_t *s, uint64_t pos, int header, const block_frame_t *frame) {
+    const query_t *q = s->q;
+    match_t best = MATCH_NO;
+    for (int i = 0; i < q->n_conds && best != MATCH_YES; i++) {
+        match_t m = match_header(&q->conds[i], s->threshold[i], frame);
+        best = m > best ? m : best;
+    }
+    if (best == MATCH_NO)
+        return;
+    s->candidates++;
+    if (!q->exact) {
+        add_range(s, frame, frame->first_sample, frame->first_sample + frame->count,
+                  best == MATCH_MAYBE);
+        return;
+    }
+    const uint8_t *data = read_payload(s, pos, header, frame);
+    if (!data) {
+        s->bad++;
+        return;
+    }
+    for (uint32_t i = 0; i < frame->count; i++) {
+        int16_t values[COLUMN_BLOCK_CHANNELS];
+        column_block_get(data, frame->count, i, values);
+        for (int c = 0; c < q->n_conds; c++) {
+            if (match_sample(&q->conds[c], s->threshold[c], values)) {
+                add_range(s, frame, frame->first_sample + i, frame->first_sample + i + 1, false);
+                break;
+            }
+        }
+    }
+}
+
+// Próximo cabeçalho válido depois de pos (ou o fim do arquivo)
+static uint64_t resync(scan_t *s, uint64_t pos, uint64_t size) {
+    uint8_t *window = s->raw; // Livre aqui
+    for (pos++; pos < size;) {
+        ssize_t n = pread(s->fd, window, SYNC_WINDOW, (off_t)pos);
+        if (n <= 0)
+            break;
+        s->bytes_read += (uint64_t)n;
+        size_t at = block_frame_find_sync(window, (size_t)n, 0);
+        if (at < (size_t)n)
+            return pos + at;
+        pos += (uint64_t)n > BLOCK_FRAME_MAX_HEADER_SIZE ? (uint64_t)n - BLOCK_FRAME_MAX_HEADER_SIZE
+                                                         : (uint64_t)n;
+    }
+    return size;
+}
+
+static int scan_file(scan_t *s, const job_t *job) {
+    uint64_t pos = 0;
+    bool columns = false;
+    for (int i = 0; i < s->q->n_conds; i++)
+        s->threshold[i] = s->q->conds[i].value;
+    s->have_scale = s->q->raw_units;
+
+    while (pos < job->size) {
+        uint8_t head[BLOCK_FRAME_MAX_HEADER_SIZE];
+        ssize_t n = pread(s->fd, head, sizeof(head), (off_t)pos);
+        if (n <= 0)
+            break;
+        s->bytes_read += (uint64_t)n;
+        block_frame_t frame;
+        int header = block_frame_parse_header(head, (size_t)n, &frame);
+        if (header == 0)
+            break; // Cabeçalho cortado no fim
+        if (header < 0 && !columns) {
+            fprintf(s->out, "  nao e um log colunar (formato columns)\n");
+            return -1;
+        }
+        if (header < 0) {
+            s->bad++;
+            pos = resync(s, pos, job->size);
+            continue;
+        }
+        if (!frame.columns) {
+            if (!columns) {
+                fprintf(s->out, "  nao e um log colunar (formato columns)\n");
+                return -1;
+            }
+            s->bad++;
+        } else if (frame.count == 0) {
+            // Texto: o cabeçalho da sessão traz o fundo de escala
+            columns = true;
+            const uint8_t *text = read_payload(s, pos, header, &frame);
+            if (text)
+                read_meta(s, (const char *)text, frame.raw_len);
+        } else {
+            columns = true;
+            if (!s->have_scale) {
+                fprintf(s->out, "  sem fundo de escala no cabecalho (use -r)\n");
+                return -1;
+            }
+            s->blocks++;
+            scan_block(s, pos, header, &frame);
+        }
+        pos += (uint64_t)header + frame.comp_len;
+    }
+    flush_range(s);
+    return 0;
+}
+
+static void query_one(size_t item, void *ctx) {
+    query_t *q = ctx;
+    job_t *job = &q->jobs[item];
+    scan_t *s = calloc(1, sizeof(*s));
+    FILE *out = open_memstream(&job->out, &job->out_len);
+    int rc = -1;
+    if (s && out) {
+        s->q = q;
+        s->out = out;
+        s->fd = open(job->path, O_RDONLY);
+        if (s->fd < 0) {
+            fprintf(out, "  %s\n", strerror(errno));
+        } else {
+            rc = scan_file(s, job);
+            close(s->fd);
+        }
+        if (s->bad)
+            fprintf(out, "  %u blocos ilegiveis pulados\n", s->bad);
+    }
+    if (out)
+        fclose(out);
+
+    pthread_mutex_lock(&q->lock);
+    q->bytes_total += job->size;
+    if (s) {
+        q->bytes_read += s->bytes_read;
+        q->blocks += s->blocks;
+        q->candidates += s->candidates;
+        q->ranges += s->ranges;
+    }
+    if (rc != 0)
+        q->failed++;
+    pthread_mutex_unlock(&q->lock);
+    free(s);
+}
+
+static char *join_path(const char *dir, const char *name) {
+    size_t len = strlen(dir) + strlen(name) + 2;
+    char *path = malloc(len);
+    if (path)
+        snprintf(path, len, "%s/%s", dir, name);
+    return path;
+}
+
+static int add_job(query_t *q, const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (q->count == q->cap) {
+        size_t cap = q->cap ? q->cap * 2 : 64;
+        job_t *jobs = realloc(q->jobs, cap * sizeof(*jobs));
+        if (!jobs)
+            return -1;
+        q->jobs = jobs;
+        q->cap = cap;
+    }
+    job_t *job = &q->jobs[q->count];
+    *job = (job_t){.path = strdup(path), .size = (uint64_t)st.st_size};
+    if (!job->path)
+        return -1;
+    q->count++;
+    return 0;
+}
+
+// Pastas: os .lzb dela (sem recursão)
+static int add_input(query_t *q, const char *path) {
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(path);
+        if (!dir) {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            return -1;
+        }
+        struct dirent *entry;
+        int rc = 0;
+        while ((entry = readdir(dir)) != NULL) {
+            const char *dot = strrchr(entry->d_name, '.');
+            if (!dot || strcmp(dot, ".lzb") != 0)
+                continue;
+            char *file = join_path(path, entry->d_name);
+            if (!file || add_job(q, file) != 0)
+                rc = -1;
+            free(file);
+        }
+        closedir(dir);
+        return rc;
+    }
+    return add_job(q, path);
+}
+
+static int by_path(const void *a, const void *b) {
+    return strcmp(((const job_t *)a)->path, ((const job_t *)b)->path);
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "uso: logquery -w condicao [-w condicao...] [-r] [-x] [-j threads] arquivo|pasta...\n"
+            "  -w  condicao canal op valor, ex. '|accel|>1.5', 'gz<-200', '|ax|>0.8'\n"
+            "      canal: ax ay az gx gy gz, |canal| (absoluto), |accel| |gyro| (modulo)\n"
+            "      valor em g e graus/s (ou unidades brutas com -r); basta uma condicao valer\n"
+            "  -r  valores em unidades brutas do MPU6050\n"
+            "  -x  le os blocos candidatos e da os trechos exatos, amostra a amostra\n"
+            "  -j  threads (padrao: numero de nucleos)\n");
+}
+
+int main(int argc, char **argv) {
+    query_t q = {0};
+    unsigned threads = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:rxj:h")) != -1) {
+        switch (opt) {
+        case 'w':
+            if (q.n_conds == MAX_CONDS || !parse_cond(optarg, &q.conds[q.n_conds])) {
+                fprintf(stderr, "condicao invalida: %s\n", optarg);
+                return 2;
+            }
+            q.n_conds++;
+            break;
+        case 'r':
+            q.raw_units = true;
+            break;
+        case 'x':
+            q.exact = true;
+            break;
+        case 'j':
+            threads = (unsigned)atoi(optarg);
+            break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+    if (optind >= argc || q.n_conds == 0) {
+        usage();
+        return 2;
+    }
+    for (int i = optind; i < argc; i++) {
+        if (add_input(&q, argv[i]) != 0)
+            q.failed++;
+    }
+    if (q.count == 0) {
+        fprintf(stderr, "nenhum log encontrado\n");
+        return 1;
+    }
+    qsort(q.jobs, q.count, sizeof(q.jobs[0]), by_path);
+
+    if (threads == 0)
+        threads = work_pool_cpu_count();
+    pthread_mutex_init(&q.lock, NULL);
+    double t0 = now_s();
+    work_pool_run(q.count, threads, query_one, &q);
+    double elapsed = now_s() - t0;
+    pthread_mutex_destroy(&q.lock);
+
+    bool maybe = false;
+    for (size_t i = 0; i < q.count; i++) {
+        job_t *job = &q.jobs[i];
+        if (job->out && job->out_len) {
+            printf("%s:\n%s", job->path, job->out);
+            maybe |= strstr(job->out, " ?\n") != NULL;
+        }
+        free(job->out);
+        free(job->path);
+    }
+    free(q.jobs);
+
+    printf("%zu arquivos, %llu blocos, %llu candidatos, %llu trechos; lidos %.2f de %.1f MB "
+           "em %.3f s\n",
+           q.count, (unsigned long long)q.blocks, (unsigned long long)q.candidates,
+           (unsigned long long)q.ranges, q.bytes_read / 1e6, q.bytes_total / 1e6, elapsed);
+    if (maybe)
+        printf("? = so pelos cabecalhos nao da para confirmar; -x confirma amostra a amostra\n");
+    return q.failed ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+#include <string.h>
+
+#include "oled_panel.h"
+
+void oled_panel_init(oled_panel_t *panel) {
+    memset(panel, 0, sizeof(*panel));
+    panel->mode = 2; // Padrão do controlador após o reset
+    panel->col1 = OLED_PANEL_WIDTH - 1;
+    panel->page1 = OLED_PANEL_PAGES - 1;
+}
+
+// Argumentos de cada comando do SSD1306 que o driver pode mandar
+static uint8_t command_args(uint8_t c) {
+    switch (c) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+static bool command_known(uint8_t c) {
+    return command_args(c) > 0 || (c >= 0x40 && c <= 0x7F) || (c & 0xFE) == 0xA0 ||
+           (c & 0xFE) == 0xA4 || (c & 0xFE) == 0xA6 || (c & 0xFE) == 0xAE || (c & 0xF7) == 0xC0 ||
+           (c >= 0xB0 && c <= 0xB7) || c < 0x20 || c == 0xE3;
+}
+
+static void command_byte(oled_panel_t *panel, uint8_t b) {
+    if (panel->args_needed) {
+        panel->args[panel->args_seen++] = b;
+        if (panel->args_seen < panel->args_needed)
+            return;
+        panel->args_needed = 0;
+        switch (panel->command) {
+        case 0x20:
+            panel->mode = panel->args[0] & 3;
+            break;
+        case 0x21:
+            panel->col0 = panel->col = panel->args[0] & 0x7F;
+            panel->col1 = panel->args[1] & 0x7F;
+            break;
+        case 0x22:
+            panel->page0 = panel->page = panel->args[0] & 7;
+            panel->page1 = panel->args[1] & 7;
+            break;
+        }
+        return;
+    }
+    panel->command = b;
+    panel->args_seen = 0;
+    panel->args_needed = command_args(b);
+    if (!command_known(b))
+        panel->unknown++;
+    if (b >= 0xB0 && b <= 0xB7) // Página no modo de página
+        panel->page = b & 7;
+}
+
+static void data_byte(oled_panel_t *panel, uint8_t b) {
+    panel->gram[panel->page][panel->col] = b;
+    if (panel->mode == 1) { // Vertical: desce as páginas, depois a coluna
+        if (panel->page++ >= panel->page1) {
+            panel->page = panel->page0;
+            panel->col = panel->col >= panel->col1 ? panel->col0 : panel->col + 1;
+        }
+    } else if (panel->mode == 0) { // Horizontal
+        if (panel->col++ >= panel->col1) {
+            panel->col = panel->col0;
+            panel->page = panel->page >= panel->page1 ? panel->page0 : panel->page + 1;
+        }
+    } else if (panel->col < OLED_PANEL_WIDTH - 1) { // Página: só a coluna anda
+        panel->col++;
+    }
+}
+
+void oled_panel_write(oled_panel_t *panel, const uint8_t *src, size_t len) {
+    panel->bytes += (uint32_t)len + 1;
+    panel->transactions++;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t control = src[i++];
+        bool data = control & 0x40;
+        if (control & 0x80) { // Co = 1: um byte e outro byte de controle
+            if (i < len) {
+                if (data)
+                    data_byte(panel, src[i]);
+                else
+                    command_byte(panel, src[i]);
+                i++;
+            }
+            continue;
+        }
+        for (; i < len; i++) { // Co = 0: o resto da transação
+            if (data)
+                data_byte(panel, src[i]);
+            else
+                command_byte(panel, src[i]);
+        }
+    }
+}
+
+bool oled_panel_write_pbm(const oled_panel_t *panel, FILE *f) {
+    fprintf(f, "P4\n%d %d\n", OLED_PANEL_WIDTH, OLED_PANEL_PAGES * 8);
+    for (int y = 0; y < OLED_PANEL_PAGES * 8; y++) {
+        uint8_t row[OLED_PANEL_WIDTH / 8] = {0};
+        for (int x = 0; x < OLED_PANEL_WIDTH; x++) {
+            if (oled_panel_pixel(panel, x, y))
+                row[x >> 3] |= 0x80 >> (x & 7);
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    return !ferror(f);
+}
@@ -0,0 +1,39 @@
+#ifndef OLED_PANEL_H
+#define OLED_PANEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Controlador SSD1306 simulado: interpreta as transações I2C que o driver
+// manda (byte de controle, comandos com argumentos, dados) e monta a GDDRAM
+// de 128x64, nos três modos de endereçamento. Conta bytes e transações como
+// a I2C: cada transação custa o byte de endereço mais os dados.
+
+#define OLED_PANEL_WIDTH 128
+#define OLED_PANEL_PAGES 8
+
+typedef struct {
+    uint8_t gram[OLED_PANEL_PAGES][OLED_PANEL_WIDTH];
+    uint8_t mode; // SET_MEM_ADDR: 0 horizontal, 1 vertical, 2 página
+    uint8_t col0, col1, page0, page1, col, page;
+    uint8_t command, args[2], args_needed, args_seen;
+    uint32_t bytes;        // Na I2C, com o byte de endereço
+    uint32_t transactions;
+    uint32_t unknown;      // Comandos fora da tabela (argumentos podem ter sido mal lidos)
+} oled_panel_t;
+
+void oled_panel_init(oled_panel_t *panel);
+
+// Uma transação (sem o byte de endereço)
+void oled_panel_write(oled_panel_t *panel, const uint8_t *src, size_t len);
+
+static inline bool oled_panel_pixel(const oled_panel_t *panel, int x, int y) {
+    return (panel->gram[y >> 3][x] >> (y & 7)) & 1;
+}
+
+// Imagem PBM binária (P4), pixel aceso em preto
+bool oled_panel_write_pbm(const oled_panel_t *panel, FILE *f);
+
+#endif
@@ -0,0 +1,334 @@
+// Simulador do OLED no PC: lib/ssd1306.c e as páginas do firmware
+// (lib/display_pages.c) compilados contra uma I2C falsa (tools/sdk_stub) que
+// entrega as transações a um SSD1306 simulado (tools/oled_panel.c).
+//
+//   oledsim [-o pasta] [-c pasta] [-b bytes] [-n quadros]
+//
+// Cada cena (uma página em um estado do sistema) é desenhada e enviada como
+// no firmware: o primeiro quadro, que limpa a tela, e depois -n quadros em
+// regime, com contadores, leituras do IMU e o gráfico avançando. Depois de
+// cada envio a GDDRAM simulada tem de ser igual ao framebuffer. Sai uma
+// tabela com bytes e transações na I2C por quadro.
+//   -o  grava a tela final de cada cena em pasta/<cena>.pbm
+//   -c  compara a tela final com pasta/<cena>.pbm (imagens de referência
+//       gravadas antes com -o)
+//   -b  falha se o regime de alguma cena passar de bytes por quadro
+// Retorna 1 se alguma verificação falhar.
+//
+// Compilado com SSD1306_DMA=1 (alvo oledsim_dma), os quadros saem pela fila do
+// DMA: o canal simulado abaixo entrega as palavras ao painel, fechando uma
+// transação a cada bit de STOP, como a FIFO da I2C.
+
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "display_pages.h"
+#include "oled_panel.h"
+#include "sample_ring.h"
+#include "ssd1306.h"
+
+typedef struct {
+    const char *name;
+    uint8_t page;
+    SystemState state;
+    bool space_low;
+    uint32_t samples0; // Contagem de amostras no quadro 0 da cena
+} scene_t;
+
+static const scene_t scenes[] = {
+    {"inicializando", 0, SYS_INITIALIZING, false, 0},
+    {"sd_ausente", 0, SYS_SD_NOT_DETECTED, false, 0},
+    {"pronto", 0, SYS_READY, false, 0},
+    {"pronto_cheio", 0, SYS_READY, true, 0},
+    {"gravando", 0, SYS_RECORDING, false, 0},
+    // Contagem passando de 999999 para 1000k no meio do regime (o quadro 0 é
+    // n = WIDTH + 20)
+    {"gravando_longo", 0, SYS_RECORDING, false, 1000000 - (WIDTH + 20) - 25},
+    {"salvo", 0, SYS_DATA_SAVED, false, 0},
+    // Maior que 16 colunas sem a escala (10 dígitos)
+    {"salvo_longo", 0, SYS_DATA_SAVED, false, 4000000000u},
+    {"salvo_cheio", 0, SYS_DATA_SAVED, true, 0},
+    {"erro", 0, SYS_ERROR, false, 0},
+    {"imu", 1, SYS_READY, false, 0},
+    {"grafico", 2, SYS_RECORDING, false, 0},
+};
+#define SCENE_COUNT (sizeof(scenes) / sizeof(scenes[0]))
+
+static oled_panel_t panel;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c;
+    (void)addr;
+    (void)nostop;
+    oled_panel_write(&panel, src, len);
+    return (int)len;
+}
+
+// Amostra sintética n: vibração de ~2 Hz a 10 Hz de amostragem, mais ruído
+static void synthetic_sample(uint32_t n, int16_t accel[3], int16_t gyro[3], int16_t *temp) {
+    uint32_t noise = n * 2654435761u;
+    double s = sin(n * 1.3);
+    accel[0] = (int16_t)(2000 * s + (int)(noise >> 24) - 128);
+    accel[1] = (int16_t)(-300 + (int)((noise >> 16) & 63));
+    accel[2] = (int16_t)(16384 + 500 * cos(n * 0.4));
+    gyro[0] = (int16_t)(150 * s);
+    gyro[1] = (int16_t)(-40 + (int)((noise >> 8) & 15));
+    gyro[2] = (int16_t)(n % 7);
+    *temp = (int16_t)((25.0 - 36.53) * 340);
+}
+
+#if SSD1306_DMA
+// DMA simulado (SDK_STUB_DMA): um canal só. A transferência fica pendente
+// até o driver perguntar se ela terminou; nessa consulta as palavras chegam
+// ao painel e o canal ainda aparece ocupado, livre só na seguinte.
+static const volatile uint16_t *dma_words;
+static uint32_t dma_count, dma_transfers, dma_unterminated;
+
+int dma_claim_unused_channel(bool required) {
+    (void)required;
+    return 0;
+}
+
+void dma_channel_transfer_from_buffer_now(unsigned channel, const volatile void *read_addr, uint32_t count) {
+    (void)channel;
+    dma_words = read_addr;
+    dma_count = count;
+    dma_transfers++;
+}
+
+bool dma_channel_is_busy(unsigned channel) {
+    (void)channel;
+    if (!dma_count)
+        return false;
+    uint8_t tr[OLED_PANEL_PAGES * OLED_PANEL_WIDTH + 1];
+    size_t len = 0;
+    for (uint32_t i = 0; i < dma_count; i++) {
+        if (len == sizeof(tr)) { // Transação maior que um quadro: falta um STOP
+            dma_unterminated++;
+            len = 0;
+        }
+        tr[len++] = (uint8_t)dma_words[i];
+        if (dma_words[i] & I2C_IC_DATA_CMD_STOP_BITS) {
+            oled_panel_write(&panel, tr, len);
+            len = 0;
+        }
+    }
+    if (len) // A fila acabou sem STOP: o barramento ficaria preso
+        dma_unterminated++;
+    dma_count = 0;
+    return true;
+}
+#endif
+
+// Envio de um quadro como no firmware: pela fila do DMA quando compilado com
+// ela, esperando o fim para comparar a GDDRAM
+static void send_frame(ssd1306_t *ssd) {
+#if SSD1306_DMA
+    ssd1306_send_data_async(ssd);
+    ssd1306_send_wait(ssd);
+#else
+    ssd1306_send_data(ssd);
+#endif
+}
+
+static bool panel_matches(const ssd1306_t *ssd) {
+    for (int x = 0; x < ssd->width; x++) {
+        for (int page = 0; page < ssd->pages; page++) {
+            if (panel.gram[page][x] != ssd->ram_buffer[1 + x * ssd->pages + page])
+                return false;
+        }
+    }
+    return true;
+}
+
+// Compara com a imagem de referência; false se faltar ou for diferente
+static bool compare_pbm(const char *path, int *diff_pixels) {
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    char magic[3] = {0};
+    int w = 0, h = 0;
+    bool ok = fscanf(f, "%2s %d %d", magic, &w, &h) == 3 && strcmp(magic, "P4") == 0 &&
+              w == OLED_PANEL_WIDTH && h == OLED_PANEL_PAGES * 8 && fgetc(f) != EOF;
+    *diff_pixels = 0;
+    for (int y = 0; ok && y < h; y++) {
+        uint8_t row[OLED_PANEL_WIDTH / 8];
+        if (fread(row, 1, sizeof(row), f) != sizeof(row)) {
+            ok = false;
+            break;
+        }
+        for (int x = 0; x < w; x++) {
+            bool ref = (row[x >> 3] >> (7 - (x & 7))) & 1;
+            if (ref != oled_panel_pixel(&panel, x, y))
+                (*diff_pixels)++;
+        }
+    }
+    fclose(f);
+    return ok && *diff_pixels == 0;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "uso: oledsim [-o pasta] [-c pasta] [-b bytes] [-n quadros]\n"
+            "  -o  grava a tela final de cada cena em pasta/<cena>.pbm\n"
+            "  -c  compara a tela final com pasta/<cena>.pbm\n"
+            "  -b  falha se o regime de uma cena passar de bytes por quadro na I2C\n"
+            "  -n  quadros em regime por cena (padrao 50)\n");
+}
+
+int main(int argc, char **argv) {
+    const char *out_dir = NULL, *ref_dir = NULL;
+    long budget = -1;
+    int steady_frames = 50;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:c:b:n:h")) != -1) {
+        switch (opt) {
+        case 'o':
+            out_dir = optarg;
+            break;
+        case 'c':
+            ref_dir = optarg;
+            break;
+        case 'b':
+            budget = atol(optarg);
+            break;
+        case 'n':
+            steady_frames = atoi(optarg);
+            break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+    if (optind != argc || steady_frames < 0) {
+        usage();
+        return 2;
+    }
+
+    if (out_dir)
+        mkdir(out_dir, 0777); // Se já existe, o fopen abaixo diz se dá para gravar
+
+    ssd1306_t ssd;
+    static sample_ring_t ring;
+    oled_panel_init(&panel);
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, NULL);
+    ssd1306_config(&ssd);
+    ssd1306_send_data(&ssd);
+    printf("configuracao e primeiro quadro: %lu B em %lu transacoes\n",
+           (unsigned long)panel.bytes, (unsigned long)panel.transactions);
+
+    int failures = 0;
+#if SSD1306_DMA
+    if (!ssd1306_dma_init(&ssd)) { // Como no firmware, depois do primeiro quadro
+        printf("sem canal de DMA\n");
+        failures++;
+    }
+#endif
+    printf("%-14s %16s %22s\n", "cena", "quadro 1 (B/tr)", "regime (B/tr, maximo)");
+    for (size_t i = 0; i < SCENE_COUNT; i++) {
+        const scene_t *sc = &scenes[i];
+        // Mesmo ponto de partida em toda execução: anel com uma tela de amostras
+        sample_ring_init(&ring, 1);
+        uint32_t n = 0;
+        display_view_t view = {
+            .page = sc->page,
+            .state = sc->state,
+            .free_mb = 1843,
+            .space_low = sc->space_low,
+            .ring = &ring,
+        };
+        for (; n < WIDTH + 20; n++) {
+            int16_t accel[3], gyro[3], temp;
+            synthetic_sample(n, accel, gyro, &temp);
+            const int16_t values[SAMPLE_RING_CHANNELS] = {accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]};
+            sample_ring_push(&ring, values);
+        }
+
+        uint32_t first_bytes = 0, first_tr = 0, steady_bytes = 0, steady_tr = 0, steady_max = 0;
+        bool consistent = true;
+        for (int frame = 0; frame <= steady_frames; frame++, n++) {
+            if (frame == 0 || sc->state == SYS_RECORDING) {
+                view.samples = sc->samples0 + n;
+                view.elapsed_s = n / 10;
+                view.remaining_s = 4 * 3600 - (int32_t)view.elapsed_s;
+            }
+            synthetic_sample(n, view.accel, view.gyro, &view.temp);
+            if (frame > 0) {
+                const int16_t values[SAMPLE_RING_CHANNELS] = {view.accel[0], view.accel[1], view.accel[2],
+                                                              view.gyro[0], view.gyro[1], view.gyro[2]};
+                sample_ring_push(&ring, values);
+            }
+
+            uint32_t bytes = panel.bytes, tr = panel.transactions;
+            display_pages_draw(&ssd, &view);
+            send_frame(&ssd);
+            bytes = panel.bytes - bytes;
+            tr = panel.transactions - tr;
+            if (!panel_matches(&ssd))
+                consistent = false;
+            if (frame == 0) {
+                first_bytes = bytes;
+                first_tr = tr;
+            } else {
+                steady_bytes += bytes;
+                steady_tr += tr;
+                if (bytes > steady_max)
+                    steady_max = bytes;
+            }
+        }
+
+        double avg_bytes = steady_frames ? (double)steady_bytes / steady_frames : 0;
+        double avg_tr = steady_frames ? (double)steady_tr / steady_frames : 0;
+        printf("%-14s %10lu / %-4lu %9.1f / %-4.1f %6lu", sc->name, (unsigned long)first_bytes,
+               (unsigned long)first_tr, avg_bytes, avg_tr, (unsigned long)steady_max);
+        if (!consistent) {
+            printf("  GDDRAM != framebuffer");
+            failures++;
+        }
+        if (budget >= 0 && avg_bytes > budget) {
+            printf("  acima de %ld B/quadro", budget);
+            failures++;
+        }
+
+        char path[1024];
+        if (out_dir) {
+            snprintf(path, sizeof(path), "%s/%s.pbm", out_dir, sc->name);
+            FILE *f = fopen(path, "wb");
+            if (!f || !oled_panel_write_pbm(&panel, f)) {
+                printf("  erro gravando %s", path);
+                failures++;
+            }
+            if (f)
+                fclose(f);
+        }
+        if (ref_dir) {
+            int diff_pixels = 0;
+            snprintf(path, sizeof(path), "%s/%s.pbm", ref_dir, sc->name);
+            if (!compare_pbm(path, &diff_pixels)) {
+                if (diff_pixels)
+                    printf("  %d pixels diferentes de %s", diff_pixels, path);
+                else
+                    printf("  sem referencia em %s", path);
+                failures++;
+            }
+        }
+        printf("\n");
+    }
+#if SSD1306_DMA
+    printf("%lu envios por DMA\n", (unsigned long)dma_transfers);
+    if (dma_transfers == 0 || dma_unterminated) {
+        printf("%lu filas sem STOP no fim\n", (unsigned long)dma_unterminated);
+        failures++;
+    }
+#endif
+    if (panel.unknown) {
+        printf("%lu comandos desconhecidos na I2C\n", (unsigned long)panel.unknown);
+        failures++;
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Relatorio de uso de memoria por modulo a partir do .map do linker.
+
+Executado automaticamente apos o link do firmware (ver CMakeLists.txt), mas
+tambem pode ser chamado a mao:
+
+    python3 tools/ram_report.py build/DataloggerIMU.elf.map
+
+Para cada arquivo objeto (ou biblioteca .a) soma o que ele ocupa nas secoes de
+RAM (.data, .bss, ...) e de flash, e ao final mostra quanto da RAM sobra para
+heap e para os buffers de captura. O uso de heap em tempo de execucao e
+impresso pelo proprio firmware pela USB (ver print_memory_usage()).
+"""
+
+import argparse
+import os
+import re
+import sys
+from collections import defaultdict
+
+# Secoes de saida do linker script do RP2040 (memmap_default.ld)
+RAM_SECTIONS = {'.ram_vector_table', '.data', '.uninitialized_data', '.bss',
+                '.scratch_x', '.scratch_y', '.tdata', '.tbss'}
+FLASH_SECTIONS = {'.boot2', '.text', '.rodata', '.ARM.extab', '.ARM.exidx',
+                  '.binary_info'}
+
+RAM_SIZE = 256 * 1024          # Banco principal (striped) do RP2040
+SCRATCH_SIZE = 4 * 1024        # SCRATCH_X / SCRATCH_Y
+
+_IN_SECTION = re.compile(r'^ (\.[^\s]+|COMMON)\s*$|^ (\.[^\s]+|COMMON)\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*)$')
+_CONT_LINE = re.compile(r'^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*)$')
+_SYMBOL = re.compile(r'^\s+(0x[0-9a-fA-F]+)\s+(__\w+)\s*=')
+
+
+def module_name(path):
+    """Reduz o caminho do objeto a um nome de modulo legivel."""
+    path = path.strip()
+    m = re.match(r'(.*\.a)\((.*)\)$', path)
+    if m:
+        return os.path.basename(m.group(1))
+    name = os.path.basename(path)
+    for suffix in ('.obj', '.o'):
+        if name.endswith(suffix):
+            name = name[:-len(suffix)]
+    return name
+
+
+def parse_map(map_path):
+    ram = defaultdict(lambda: defaultdict(int))
+    flash = defaultdict(int)
+    symbols = {}
+    out_section = None
+    pending_in = False      # Nome da secao de entrada longo demais: dados na linha seguinte
+    in_memory_map = False
+
+    with open(map_path, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if not in_memory_map:
+                in_memory_map = line.startswith('Linker script and memory map')
+                continue
+
+            if line.startswith('.'):
+                out_section = line.split()[0]
+                pending_in = False
+                continue
+
+            m = _SYMBOL.match(line)
+            if m:
+                symbols[m.group(2)] = int(m.group(1), 16)
+                continue
+
+            if pending_in:
+                pending_in = False
+                m = _CONT_LINE.match(line)
+                if m:
+                    _account(ram, flash, out_section, int(m.group(2), 16), m.group(3))
+                    continue
+
+            m = _IN_SECTION.match(line)
+            if m:
+                if m.group(1):
+                    pending_in = True
+                else:
+                    _account(ram, flash, out_section, int(m.group(4), 16), m.group(5))
+    return ram, flash, symbols
+
+
+def _account(ram, flash, out_section, size, obj):
+    if size == 0 or out_section is None or obj.startswith('*'):
+        return
+    mod = module_name(obj)
+    if out_section in RAM_SECTIONS:
+        ram[mod][out_section] += size
+        if out_section == '.data':
+            flash[mod] += size       # Valor inicial de .data tambem vai na flash
+    elif out_section in FLASH_SECTIONS:
+        flash[mod] += size
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Uso de RAM por modulo (a partir do .map)')
+    parser.add_argument('map_file', help='Arquivo .map gerado pelo linker (ex: DataloggerIMU.elf.map)')
+    parser.add_argument('--profile', default='?', help='Nome do perfil de memoria (apenas para exibir)')
+    parser.add_argument('--top', type=int, default=20, help='Quantidade de modulos listados')
+    args = parser.parse_args()
+
+    if not os.path.exists(args.map_file):
+        print(f'ram_report: arquivo {args.map_file} nao encontrado', file=sys.stderr)
+        return 0   # Nao falha o build por causa do relatorio
+
+    ram, flash, symbols = parse_map(args.map_file)
+    rows = []
+    for mod, sections in ram.items():
+        data = sections.get('.data', 0) + sections.get('.ram_vector_table', 0)
+        bss = sections.get('.bss', 0) + sections.get('.uninitialized_data', 0)
+        scratch = sections.get('.scratch_x', 0) + sections.get('.scratch_y', 0)
+        rows.append((data + bss + scratch, mod, data, bss, scratch, flash.get(mod, 0)))
+    rows.sort(reverse=True)
+
+    print(f'=== Uso de memoria estatica por modulo (perfil: {args.profile}) ===')
+    print(f'{"modulo":<32}{".data":>8}{".bss":>8}{"scratch":>9}{"RAM":>8}{"flash":>9}')
+    for total, mod, data, bss, scratch, fl in rows[:args.top]:
+        print(f'{mod:<32}{data:>8}{bss:>8}{scratch:>9}{total:>8}{fl:>9}')
+    if len(rows) > args.top:
+        rest = rows[args.top:]
+        print(f'{"(outros %d)" % len(rest):<32}{sum(r[2] for r in rest):>8}'
+              f'{sum(r[3] for r in rest):>8}{sum(r[4] for r in rest):>9}'
+              f'{sum(r[0] for r in rest):>8}{sum(r[5] for r in rest):>9}')
+
+    static_ram = sum(r[2] + r[3] for r in rows)
+    print(f'RAM estatica total (banco principal): {static_ram} bytes de {RAM_SIZE}')
+    heap_start = symbols.get('__end__')
+    heap_limit = symbols.get('__StackLimit')
+    if heap_start is not None and heap_limit is not None and heap_limit > heap_start:
+        free = heap_limit - heap_start
+    else:
+        free = RAM_SIZE - static_ram
+    print(f'RAM livre para heap e buffers de captura: {free} bytes ({free / 1024:.1f} KiB)')
+    print(f'Pilhas: SCRATCH_X/Y de {SCRATCH_SIZE} bytes cada (core 1 / core 0)')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
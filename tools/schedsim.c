@@ -0,0 +1,129 @@
+// Escalonador do firmware (lib/task_sched.c) em tempo simulado: as mesmas
+// tarefas do laço principal, com períodos e prioridades de DataloggerIMU.c e
+// custos de CPU estimados, sem a placa.
+//
+//   schedsim [-t segundos] [-s ms] [-d ms] [-b amostras]
+//
+//   -t  tempo simulado (padrão 600 s)
+//   -s  duração de uma escrita no cartão (padrão 15 ms; cartões lentos
+//       chegam a 100-250 ms)
+//   -d  custo de um quadro do display (padrão 3 ms)
+//   -b  amostras por escrita no cartão (padrão 40, ~4 KB de CSV)
+//
+// Cada tarefa avança o relógio simulado pelo seu custo; sem tarefa vencida o
+// relógio pula para o próximo prazo, como o sleep_until do firmware. Sai o
+// relatório do escalonador (task_sched_report) e o atraso da amostragem.
+// Retorna 1 se a aquisição perdeu algum prazo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "task_sched.h"
+
+static uint64_t now_us;
+static uint64_t sim_clock(void) {
+    return now_us;
+}
+
+static uint32_t write_us = 15000, frame_us = 3000, samples_per_write = 40;
+static uint32_t pending_samples;
+
+static void acquisition_run(task_t *task) {
+    (void)task;
+    now_us += 450 + 60; // Leitura do MPU6050 a 400 kHz + formatação
+    pending_samples++;
+}
+
+static void storage_run(task_t *task) {
+    (void)task;
+    now_us += 5;
+    if (pending_samples >= samples_per_write) {
+        now_us += write_us;
+        pending_samples = 0;
+    }
+}
+
+static void button_run(task_t *task) {
+    (void)task;
+    now_us += 3;
+}
+
+static void ui_run(task_t *task) {
+    (void)task;
+    now_us += 2;
+}
+
+static void display_run(task_t *task) {
+    (void)task;
+    now_us += frame_us;
+}
+
+static void card_run(task_t *task) {
+    (void)task;
+    now_us += 1;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "uso: schedsim [-t segundos] [-s ms] [-d ms] [-b amostras]\n"
+            "  -t  tempo simulado (padrao 600 s)\n"
+            "  -s  duracao de uma escrita no cartao (padrao 15 ms)\n"
+            "  -d  custo de um quadro do display (padrao 3 ms)\n"
+            "  -b  amostras por escrita no cartao (padrao 40)\n");
+}
+
+int main(int argc, char **argv) {
+    double seconds = 600;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:s:d:b:h")) != -1) {
+        switch (opt) {
+        case 't':
+            seconds = atof(optarg);
+            break;
+        case 's':
+            write_us = (uint32_t)(atof(optarg) * 1000);
+            break;
+        case 'd':
+            frame_us = (uint32_t)(atof(optarg) * 1000);
+            break;
+        case 'b':
+            samples_per_write = (uint32_t)atoi(optarg);
+            break;
+        default:
+            usage();
+            return 2;
+        }
+    }
+    if (optind != argc || seconds <= 0) {
+        usage();
+        return 2;
+    }
+
+    // Mesmos períodos e prioridades do firmware (DataloggerIMU.c)
+    task_t acquisition = {.name = "aquisicao", .run = acquisition_run, .priority = 0, .period_us = 100000};
+    task_t buttons = {.name = "botoes", .run = button_run, .priority = 1, .period_us = 10000};
+    task_t storage = {.name = "cartao", .run = storage_run, .priority = 2, .period_us = 20000};
+    task_t ui = {.name = "led", .run = ui_run, .priority = 3, .period_us = 50000};
+    task_t display = {.name = "display", .run = display_run, .priority = 4, .period_us = 100000};
+    task_t card = {.name = "deteccao", .run = card_run, .priority = 5, .period_us = 1000000};
+
+    task_sched_t sched;
+    task_sched_init(&sched, sim_clock);
+    task_t *tasks[] = {&acquisition, &buttons, &storage, &ui, &display, &card};
+    for (size_t i = 0; i < sizeof(tasks) / sizeof(tasks[0]); i++) {
+        task_add(&sched, tasks[i]);
+        task_start(&sched, tasks[i], 0);
+    }
+
+    uint64_t end_us = (uint64_t)(seconds * 1e6);
+    while (now_us < end_us) {
+        if (!task_sched_run_once(&sched))
+            now_us = task_sched_next_due(&sched);
+    }
+
+    printf("%.0f s simulados, escrita no cartao %.1f ms a cada %lu amostras, quadro %.1f ms\n", seconds,
+           write_us / 1000.0, (unsigned long)samples_per_write, frame_us / 1000.0);
+    task_sched_report(&sched);
+    return acquisition.missed ? 1 : 0;
+}
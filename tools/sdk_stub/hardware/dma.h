@@ -0,0 +1,53 @@
+// DMA do SDK no PC: nenhum canal livre, o driver do OLED fica no envio
+// bloqueante. Com SDK_STUB_DMA=1 a ferramenta define o canal, a transferência
+// e o fim dela (tools/oledsim.c entrega as palavras ao SSD1306 simulado).
+#ifndef SDK_STUB_HARDWARE_DMA_H
+#define SDK_STUB_HARDWARE_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+#define DMA_SIZE_16 1
+
+#if SDK_STUB_DMA
+int dma_claim_unused_channel(bool required);
+void dma_channel_transfer_from_buffer_now(unsigned channel, const volatile void *read_addr, uint32_t count);
+bool dma_channel_is_busy(unsigned channel);
+#else
+static inline int dma_claim_unused_channel(bool required) {
+    (void)required;
+    return -1;
+}
+
+static inline void dma_channel_transfer_from_buffer_now(unsigned channel, const volatile void *read_addr, uint32_t count) {
+    (void)channel; (void)read_addr; (void)count;
+}
+
+static inline bool dma_channel_is_busy(unsigned channel) {
+    (void)channel;
+    return false;
+}
+#endif
+
+static inline dma_channel_config dma_channel_get_default_config(unsigned channel) {
+    (void)channel;
+    return (dma_channel_config){0};
+}
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, int size) { (void)c; (void)size; }
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+static inline void channel_config_set_dreq(dma_channel_config *c, unsigned dreq) { (void)c; (void)dreq; }
+
+static inline void dma_channel_configure(unsigned channel, const dma_channel_config *config, volatile void *write_addr,
+                                         const volatile void *read_addr, unsigned count, bool trigger) {
+    (void)channel; (void)config; (void)write_addr; (void)read_addr; (void)count; (void)trigger;
+}
+
+static inline void dma_channel_abort(unsigned channel) { (void)channel; }
+
+#endif
@@ -0,0 +1,14 @@
+// GPIO do SDK no PC: só os tipos que as structs do driver do SD usam
+#ifndef SDK_STUB_HARDWARE_GPIO_H
+#define SDK_STUB_HARDWARE_GPIO_H
+
+#include "pico/types.h"
+
+enum gpio_drive_strength {
+    GPIO_DRIVE_STRENGTH_2MA = 0,
+    GPIO_DRIVE_STRENGTH_4MA = 1,
+    GPIO_DRIVE_STRENGTH_8MA = 2,
+    GPIO_DRIVE_STRENGTH_12MA = 3
+};
+
+#endif
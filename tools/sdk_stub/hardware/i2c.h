@@ -0,0 +1,37 @@
+// I2C do SDK no PC: i2c_write_blocking() é definida pela ferramenta, que
+// recebe as transações (tools/oled_panel.h). Os registradores são os do envio por
+// DMA: sempre ociosos e sem NACK, o fim do envio depende só do canal
+// (hardware/dma.h).
+#ifndef SDK_STUB_HARDWARE_I2C_H
+#define SDK_STUB_HARDWARE_I2C_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct i2c_inst i2c_inst_t;
+
+typedef struct {
+    volatile uint32_t tar, data_cmd, raw_intr_stat, clr_tx_abrt, enable, status;
+} i2c_hw_t;
+
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_STATUS_TFE_BITS 0x00000004u
+#define I2C_IC_STATUS_MST_ACTIVITY_BITS 0x00000020u
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+    (void)i2c;
+    static i2c_hw_t hw = {.status = I2C_IC_STATUS_TFE_BITS};
+    return &hw;
+}
+
+static inline unsigned i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) {
+    (void)i2c;
+    (void)is_tx;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef SDK_STUB_HARDWARE_IRQ_H
+#define SDK_STUB_HARDWARE_IRQ_H
+
+typedef void (*irq_handler_t)(void);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef SDK_STUB_HARDWARE_SPI_H
+#define SDK_STUB_HARDWARE_SPI_H
+
+typedef struct spi_inst spi_inst_t;
+
+#endif
@@ -0,0 +1,11 @@
+// Mutex do SDK no PC: os testes rodam numa thread só
+#ifndef SDK_STUB_PICO_MUTEX_H
+#define SDK_STUB_PICO_MUTEX_H
+
+#include "pico/types.h"
+
+typedef struct {
+    bool owned;
+} mutex_t;
+
+#endif
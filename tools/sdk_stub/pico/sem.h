@@ -0,0 +1,10 @@
+#ifndef SDK_STUB_PICO_SEM_H
+#define SDK_STUB_PICO_SEM_H
+
+#include "pico/types.h"
+
+typedef struct {
+    int permits;
+} semaphore_t;
+
+#endif
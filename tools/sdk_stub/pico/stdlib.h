@@ -0,0 +1,12 @@
+// Substituto mínimo do pico/stdlib.h para compilar lib/ssd1306.c no PC
+// (tools/oledsim.c); só o que o driver usa
+#ifndef SDK_STUB_PICO_STDLIB_H
+#define SDK_STUB_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static inline void tight_loop_contents(void) {}
+
+#endif
@@ -0,0 +1,13 @@
+// Tipos básicos do SDK no PC
+#ifndef SDK_STUB_PICO_TYPES_H
+#define SDK_STUB_PICO_TYPES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#define __not_in_flash_func(func) func
+
+#endif
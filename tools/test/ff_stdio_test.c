@@ -0,0 +1,225 @@
+// ff_stdio (lib/FatFs_SPI/src/ff_stdio.c) num disco em RAM.
+//
+//   ff_stdio_test [-n operacoes] [-s semente]   compara com o stdio da libc
+//   ff_stdio_test -b                            benchmark de fputc/fgets/fwrite
+//
+// Sem -b: sequência aleatória de fputc/fgetc/fwrite/fread/fgets/fseek/ftell no
+// mesmo arquivo com ff_stdio e com um tmpfile() da libc. Posições, retornos e
+// o conteúdo final têm que ser iguais; retorna 1 na primeira diferença.
+//
+// Com -b: vazão e chamadas ao disco de cada operação com o buffer do stream,
+// ao lado das funções do FatFs sem buffer (f_putc, f_gets, f_write).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ff_stdio.h"
+#include "ram_disk.h"
+
+static int fail(long op, const char *what) {
+    fprintf(stderr, "ff_stdio_test: operacao %ld: %s\n", op, what);
+    return 1;
+}
+
+static int compare_with_libc(long ops, unsigned seed) {
+    FF_FILE *f = ff_fopen("t.bin", "w+");
+    FILE *ref = tmpfile();
+    if (!f || !ref)
+        return fail(0, "falha ao abrir");
+    srand(seed);
+    static char a[4096], b[4096];
+    for (long op = 0; op < ops; op++) {
+        switch (rand() % 8) {
+        case 0: {
+            int c = rand() & 0xFF;
+            if (ff_fputc(c, f) != fputc(c, ref))
+                return fail(op, "fputc");
+            break;
+        }
+        case 1:
+            if (ff_fgetc(f) != fgetc(ref))
+                return fail(op, "fgetc");
+            clearerr(ref);
+            break;
+        case 2: {
+            // Pequenos (dentro do buffer) e maiores que o buffer
+            size_t n = rand() % 4 ? (size_t)(rand() % 64) + 1 : (size_t)rand() % sizeof(a) + 1;
+            for (size_t i = 0; i < n; i++)
+                a[i] = (char)(rand() % 5 ? 'a' + rand() % 26 : '\n');
+            if (ff_fwrite(a, 1, n, f) != fwrite(a, 1, n, ref))
+                return fail(op, "fwrite");
+            break;
+        }
+        case 3: {
+            size_t n = rand() % 4 ? (size_t)(rand() % 64) + 1 : (size_t)rand() % sizeof(a) + 1;
+            size_t got = ff_fread(a, 1, n, f);
+            if (got != fread(b, 1, n, ref) || memcmp(a, b, got) != 0)
+                return fail(op, "fread");
+            clearerr(ref);
+            break;
+        }
+        case 4: {
+            long size = (long)ff_filelength(f);
+            long off = size ? rand() % (size + 1) : 0;
+            if (ff_fseek(f, (int)off, FF_SEEK_SET) != fseek(ref, off, SEEK_SET))
+                return fail(op, "fseek SET");
+            break;
+        }
+        case 5: {
+            long back = -(rand() % 50);
+            if (ff_fseek(f, (int)back, FF_SEEK_CUR) != fseek(ref, back, SEEK_CUR))
+                return fail(op, "fseek CUR");
+            break;
+        }
+        case 6: {
+            int n = rand() % 100 + 2;
+            char *p1 = ff_fgets(a, (size_t)n, f);
+            char *p2 = fgets(b, n, ref);
+            if (!p1 != !p2 || (p1 && strcmp(a, b) != 0))
+                return fail(op, "fgets");
+            clearerr(ref);
+            break;
+        }
+        case 7:
+            if (rand() % 8 == 0 && ff_fflush(f) != 0)
+                return fail(op, "fflush");
+            break;
+        }
+        if (ff_ftell(f) != ftell(ref))
+            return fail(op, "ftell");
+    }
+
+    fseek(ref, 0, SEEK_END);
+    long size = ftell(ref);
+    if ((long)ff_filelength(f) != size)
+        return fail(ops, "tamanho do arquivo");
+    if (ff_fclose(f) != 0)
+        return fail(ops, "fclose");
+
+    // Conteúdo relido do disco, sem nada no buffer
+    f = ff_fopen("t.bin", "r");
+    rewind(ref);
+    for (long pos = 0;; pos++) {
+        int c1 = ff_fgetc(f), c2 = fgetc(ref);
+        if (c1 != c2)
+            return fail(ops, "conteudo");
+        if (c1 == FF_EOF)
+            break;
+    }
+    ff_fclose(f);
+    fclose(ref);
+    printf("ff_stdio: %ld operacoes iguais as da libc, arquivo de %ld bytes\n", ops, size);
+    return 0;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *what, long ops, long bytes, double t0, const ram_disk_stats_t *before) {
+    double dt = now_s() - t0;
+    printf("%-22s %8.2f MB/s %10.0f op/s  %6lu chamadas ao disco\n", what, bytes / dt / 1e6, ops / dt,
+           (unsigned long)(ram_disk_stats.reads - before->reads + ram_disk_stats.writes - before->writes));
+}
+
+#define BENCH_BYTES (4L << 20)
+#define BENCH_LINE 40 // Tamanho de uma linha do CSV do datalogger
+
+static int bench(void) {
+    static char line[BENCH_LINE + 1];
+    for (int i = 0; i < BENCH_LINE - 1; i++)
+        line[i] = (char)('0' + i % 10);
+    line[BENCH_LINE - 1] = '\n';
+    long lines = BENCH_BYTES / BENCH_LINE;
+    ram_disk_stats_t before;
+    double t0;
+
+    printf("buffer do stream %d B, %ld MB por teste\n", FF_STDIO_BUFFER_SIZE, BENCH_BYTES >> 20);
+
+    FF_FILE *f = ff_fopen("b.txt", "w");
+    before = ram_disk_stats;
+    t0 = now_s();
+    for (long i = 0; i < BENCH_BYTES; i++)
+        ff_fputc(line[i % BENCH_LINE], f);
+    ff_fclose(f);
+    report("ff_fputc", BENCH_BYTES, BENCH_BYTES, t0, &before);
+
+    FIL fil;
+    f_open(&fil, "c.txt", FA_WRITE | FA_CREATE_ALWAYS);
+    before = ram_disk_stats;
+    t0 = now_s();
+    for (long i = 0; i < BENCH_BYTES; i++)
+        f_putc(line[i % BENCH_LINE], &fil);
+    f_close(&fil);
+    report("f_putc (sem buffer)", BENCH_BYTES, BENCH_BYTES, t0, &before);
+
+    char buf[BENCH_LINE + 8];
+    f = ff_fopen("b.txt", "r");
+    before = ram_disk_stats;
+    t0 = now_s();
+    while (ff_fgets(buf, sizeof(buf), f))
+        ;
+    ff_fclose(f);
+    report("ff_fgets", lines, BENCH_BYTES, t0, &before);
+
+    f_open(&fil, "b.txt", FA_READ);
+    before = ram_disk_stats;
+    t0 = now_s();
+    while (f_gets(buf, sizeof(buf), &fil))
+        ;
+    f_close(&fil);
+    report("f_gets (sem buffer)", lines, BENCH_BYTES, t0, &before);
+
+    f = ff_fopen("d.txt", "w");
+    before = ram_disk_stats;
+    t0 = now_s();
+    for (long i = 0; i < lines; i++)
+        ff_fwrite(line, 1, BENCH_LINE, f);
+    ff_fclose(f);
+    report("ff_fwrite (40 B)", lines, BENCH_BYTES, t0, &before);
+
+    f_open(&fil, "e.txt", FA_WRITE | FA_CREATE_ALWAYS);
+    before = ram_disk_stats;
+    t0 = now_s();
+    UINT bw;
+    for (long i = 0; i < lines; i++)
+        f_write(&fil, line, BENCH_LINE, &bw);
+    f_close(&fil);
+    report("f_write (40 B)", lines, BENCH_BYTES, t0, &before);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long ops = 20000;
+    unsigned seed = 1;
+    int benchmark = 0, opt;
+    while ((opt = getopt(argc, argv, "n:s:b")) != -1) {
+        switch (opt) {
+        case 'n':
+            ops = atol(optarg);
+            break;
+        case 's':
+            seed = (unsigned)atoi(optarg);
+            break;
+        case 'b':
+            benchmark = 1;
+            break;
+        default:
+            fprintf(stderr, "uso: ff_stdio_test [-n operacoes] [-s semente] | -b\n");
+            return 2;
+        }
+    }
+
+    static FATFS fs;
+    FRESULT fr = ram_disk_mount(&fs);
+    if (fr != FR_OK) {
+        fprintf(stderr, "ff_stdio_test: disco em RAM: FRESULT %d\n", fr);
+        return 1;
+    }
+    return benchmark ? bench() : compare_with_libc(ops, seed);
+}
@@ -0,0 +1,146 @@
+// lib/log_writer.c num disco em RAM, com registros de tamanho variável como os
+// do CSV e do .imu.
+//
+//   log_writer_test [-n registros] [-s semente]
+//
+// Durante a sessão todo f_write tem que começar num limite de setor e ter
+// setores inteiros; só o log_writer_flush() do fechamento grava o setor
+// parcial. No fim, o arquivo tem que ser igual aos registros, e os setores
+// gravados e lidos no disco não podem passar muito dos do arquivo. O FatFs é
+// compilado com FF_FS_TINY=1, como no perfil lean-logger: ali um setor
+// parcial deixado por uma descarga é relido e regravado pela janela fs->win.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "log_writer.h"
+#include "ram_disk.h"
+
+static FIL file;
+static log_writer_t writer;
+static bool closing;
+static long misaligned;
+
+// Chamado antes de cada f_write: o arquivo tem que estar alinhado (com o
+// teste também no fechamento, cada escrita da sessão teve setores inteiros)
+static void check_write(void) {
+    if (!closing && f_tell(&file) % LOG_WRITER_SECTOR_SIZE)
+        misaligned++;
+}
+
+int main(int argc, char **argv) {
+    long records = 500000;
+    unsigned seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n':
+            records = atol(optarg);
+            break;
+        case 's':
+            seed = (unsigned)atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "uso: log_writer_test [-n registros] [-s semente]\n");
+            return 2;
+        }
+    }
+    srand(seed);
+
+    static FATFS fs;
+    if (ram_disk_mount(&fs) != FR_OK || f_open(&file, "log.csv", FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        fprintf(stderr, "log_writer_test: falha ao montar o disco ou abrir o arquivo\n");
+        return 1;
+    }
+    log_writer_init(&writer, &file);
+    writer.on_write = check_write;
+
+    // O que foi escrito, para comparar com o arquivo
+    size_t expected_size = (size_t)records * 64 + 1024;
+    uint8_t *expected = malloc(expected_size);
+    size_t pos = 0;
+    uint64_t sectors_before = ram_disk_stats.sectors_written, reads_before = ram_disk_stats.sectors_read;
+
+    for (long r = 0; r < records && pos + 64 <= expected_size; r++) {
+        uint32_t n = 20 + rand() % 44; // Como uma linha do CSV
+        uint8_t *dst = log_writer_reserve(&writer, 64);
+        if (!dst) {
+            fprintf(stderr, "log_writer_test: registro %ld: reserva falhou (%d)\n", r, writer.error);
+            return 1;
+        }
+        for (uint32_t i = 0; i < n; i++)
+            dst[i] = expected[pos + i] = (uint8_t)(r + i);
+        log_writer_commit(&writer, n);
+        pos += n;
+        // Descarga antecipada, como storage_run() com o buffer quase cheio
+        if (LOG_WRITER_BUFFER_SIZE - writer.len < 4 * 64 && log_writer_flush_sectors(&writer) != FR_OK)
+            break;
+        // Metadados maiores pelo caminho de cópia
+        if (rand() % 1000 == 0) {
+            uint8_t text[700];
+            uint32_t len = 1 + rand() % sizeof(text);
+            for (uint32_t i = 0; i < len; i++)
+                text[i] = expected[pos + i] = (uint8_t)('a' + i % 26);
+            if (log_writer_write(&writer, text, len) != FR_OK)
+                break;
+            pos += len;
+        }
+    }
+    if (writer.total != pos)
+        fprintf(stderr, "log_writer_test: total %llu, esperado %zu\n", (unsigned long long)writer.total, pos);
+    check_write();
+    closing = true;
+    FRESULT fr = log_writer_flush(&writer);
+    if (fr == FR_OK)
+        fr = f_close(&file);
+    uint64_t sectors = ram_disk_stats.sectors_written - sectors_before;
+    uint64_t reads = ram_disk_stats.sectors_read - reads_before;
+
+    int failures = writer.total != pos;
+    if (fr != FR_OK) {
+        fprintf(stderr, "log_writer_test: erro %d ao fechar\n", fr);
+        failures++;
+    }
+    if (misaligned) {
+        fprintf(stderr, "log_writer_test: %ld f_write fora do limite de setor ou com setor parcial\n", misaligned);
+        failures++;
+    }
+    // Além dos dados, só a FAT (lida e gravada pela janela ao alocar
+    // clusters) e a entrada do diretório. Um setor parcial por descarga
+    // custaria uma leitura e uma gravação a mais a cada ~4 KB de log.
+    uint64_t data_sectors = (pos + LOG_WRITER_SECTOR_SIZE - 1) / LOG_WRITER_SECTOR_SIZE;
+    if (sectors > data_sectors + data_sectors / 32 || reads > data_sectors / 32) {
+        fprintf(stderr, "log_writer_test: %llu setores gravados e %llu lidos para %llu de dados\n",
+                (unsigned long long)sectors, (unsigned long long)reads, (unsigned long long)data_sectors);
+        failures++;
+    }
+
+    // Conteúdo
+    FIL in;
+    static uint8_t buf[4096];
+    size_t off = 0;
+    UINT br;
+    if (f_open(&in, "log.csv", FA_READ) != FR_OK || f_size(&in) != pos) {
+        fprintf(stderr, "log_writer_test: arquivo com tamanho errado\n");
+        failures++;
+    } else {
+        while (f_read(&in, buf, sizeof(buf), &br) == FR_OK && br > 0) {
+            if (memcmp(buf, expected + off, br) != 0) {
+                fprintf(stderr, "log_writer_test: conteudo diferente perto do byte %zu\n", off);
+                failures++;
+                break;
+            }
+            off += br;
+        }
+        f_close(&in);
+    }
+    free(expected);
+    if (failures)
+        return 1;
+    printf("log_writer: %zu B em setores inteiros, %llu setores gravados e %llu lidos para %llu de dados\n",
+           pos, (unsigned long long)sectors, (unsigned long long)reads, (unsigned long long)data_sectors);
+    return 0;
+}
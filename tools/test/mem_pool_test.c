@@ -0,0 +1,174 @@
+// Pools de lib/mem_pool.c: alocações e liberações em ordem aleatória contra
+// um modelo dos contadores.
+//
+//   mem_pool_test [-n operacoes] [-s semente]
+//
+// Cada bloco recebe um padrão próprio em todos os bytes pedidos, conferido
+// ao liberar: dois blocos sobrepostos ou a lista livre escrita dentro de um
+// bloco em uso aparecem como padrão estragado. Os contadores (em uso, pico,
+// alocações, esgotado, grande demais, heap) têm que bater com o modelo a
+// cada passo. Retorna 1 na primeira diferença.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mem_pool.h"
+
+#define BLOCK_SIZE 48
+#define BLOCK_COUNT 8
+#define MAX_LIVE 24
+
+MEM_POOL_DEFINE(heap_pool, "heap", BLOCK_SIZE, BLOCK_COUNT, MEM_POOL_FALLBACK_HEAP);
+MEM_POOL_DEFINE(strict_pool, "estrito", BLOCK_SIZE, BLOCK_COUNT, MEM_POOL_FALLBACK_NONE);
+
+typedef struct {
+    uint8_t *ptr;
+    size_t size;
+    uint8_t fill;
+    bool from_pool;
+} live_t;
+
+typedef struct {
+    mem_pool_t *pool;
+    live_t live[MAX_LIVE];
+    int live_count;
+    // Modelo dos contadores
+    uint16_t in_use, peak;
+    uint32_t allocs, exhausted, oversize, heap_fallbacks;
+} pool_model_t;
+
+static long op;
+
+static int fail(const pool_model_t *m, const char *what) {
+    fprintf(stderr, "mem_pool_test: pool %s, operacao %ld: %s\n", m->pool->name, op, what);
+    return 1;
+}
+
+static bool owns(const mem_pool_t *pool, const void *ptr) {
+    const uint8_t *p = ptr;
+    return p >= pool->storage && p < pool->storage + (size_t)pool->block_count * pool->block_size;
+}
+
+static int check_counters(const pool_model_t *m) {
+    const mem_pool_t *p = m->pool;
+    if (p->in_use != m->in_use || p->peak != m->peak || p->allocs != m->allocs ||
+        p->exhausted != m->exhausted || p->oversize != m->oversize || p->heap_fallbacks != m->heap_fallbacks)
+        return fail(m, "contadores diferentes do modelo");
+    return 0;
+}
+
+static int do_alloc(pool_model_t *m, bool zeroed) {
+    // Quase sempre cabe no bloco; às vezes passa do tamanho
+    size_t size = rand() % 8 ? (size_t)(rand() % BLOCK_SIZE) + 1 : BLOCK_SIZE + 1 + (size_t)(rand() % 64);
+    uint8_t *ptr = zeroed ? mem_pool_calloc(m->pool, size) : mem_pool_alloc(m->pool, size);
+
+    bool heap = m->pool->fallback == MEM_POOL_FALLBACK_HEAP;
+    bool expect_pool = size <= m->pool->block_size && m->in_use < m->pool->block_count;
+    if (size > m->pool->block_size)
+        m->oversize++;
+    else if (!expect_pool)
+        m->exhausted++;
+    if (expect_pool) {
+        m->allocs++;
+        if (++m->in_use > m->peak)
+            m->peak = m->in_use;
+    } else if (heap) {
+        m->heap_fallbacks++;
+    }
+
+    if (expect_pool || heap) {
+        if (!ptr)
+            return fail(m, "alocacao deveria ter sido atendida");
+        if (owns(m->pool, ptr) != expect_pool)
+            return fail(m, expect_pool ? "bloco fora do pool" : "fallback devolveu bloco do pool");
+        if (expect_pool && ((size_t)(ptr - m->pool->storage) % m->pool->block_size != 0 ||
+                            (uintptr_t)ptr % sizeof(uint32_t) != 0))
+            return fail(m, "bloco desalinhado");
+        if (zeroed) {
+            for (size_t i = 0; i < size; i++)
+                if (ptr[i])
+                    return fail(m, "calloc sem zerar");
+        }
+    } else if (ptr) {
+        return fail(m, "pool sem fallback devolveu memoria");
+    }
+
+    if (ptr) {
+        live_t *l = &m->live[m->live_count++];
+        l->ptr = ptr;
+        l->size = size;
+        l->fill = (uint8_t)(rand() | 1);
+        l->from_pool = expect_pool;
+        memset(ptr, l->fill, size);
+    }
+    return check_counters(m);
+}
+
+static int do_free(pool_model_t *m) {
+    if (m->live_count == 0) {
+        mem_pool_free(m->pool, NULL); // Não conta nada
+        return check_counters(m);
+    }
+    int i = rand() % m->live_count;
+    live_t l = m->live[i];
+    m->live[i] = m->live[--m->live_count];
+    for (size_t k = 0; k < l.size; k++)
+        if (l.ptr[k] != l.fill)
+            return fail(m, "conteudo de um bloco em uso foi alterado");
+    mem_pool_free(m->pool, l.ptr);
+    if (l.from_pool)
+        m->in_use--;
+    return check_counters(m);
+}
+
+int main(int argc, char **argv) {
+    long ops = 200000;
+    unsigned seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n':
+            ops = atol(optarg);
+            break;
+        case 's':
+            seed = (unsigned)atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "uso: mem_pool_test [-n operacoes] [-s semente]\n");
+            return 2;
+        }
+    }
+    srand(seed);
+
+    pool_model_t models[2] = {{.pool = &heap_pool}, {.pool = &strict_pool}};
+    for (op = 0; op < ops; op++) {
+        pool_model_t *m = &models[rand() % 2];
+        // Fases que enchem e esvaziam o pool, para passar pelo esgotamento
+        bool filling = (op / 1000) % 2 == 0;
+        int r = rand() % 10;
+        int err;
+        if (m->live_count < MAX_LIVE && (filling ? r < 7 : r < 3))
+            err = do_alloc(m, r == 0);
+        else
+            err = do_free(m);
+        if (err)
+            return 1;
+    }
+    for (int i = 0; i < 2; i++) {
+        while (models[i].live_count)
+            if (do_free(&models[i]))
+                return 1;
+        if (models[i].pool->in_use != 0)
+            return fail(&models[i], "blocos em uso depois de liberar tudo");
+        if (models[i].exhausted == 0 || models[i].oversize == 0)
+            return fail(&models[i], "esgotamento ou bloco grande demais nao foram exercitados");
+    }
+    if (models[0].heap_fallbacks == 0)
+        return fail(&models[0], "fallback para o heap nao foi exercitado");
+
+    mem_pool_report_all();
+    printf("mem_pool: %ld operacoes de acordo com o modelo\n", ops);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ram_disk.h"
+#include "diskio.h"
+#include "my_debug.h"
+
+ram_disk_stats_t ram_disk_stats;
+static BYTE *disk;
+
+DSTATUS disk_status(BYTE pdrv) {
+    return pdrv == 0 && disk ? 0 : STA_NOINIT;
+}
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    if (pdrv != 0)
+        return STA_NOINIT;
+    if (!disk)
+        disk = calloc(RAM_DISK_SECTORS, FF_MIN_SS);
+    return disk ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0 || sector + count > RAM_DISK_SECTORS)
+        return RES_PARERR;
+    ram_disk_stats.reads++;
+    ram_disk_stats.sectors_read += count;
+    memcpy(buff, disk + (size_t)sector * FF_MIN_SS, (size_t)count * FF_MIN_SS);
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0 || sector + count > RAM_DISK_SECTORS)
+        return RES_PARERR;
+    ram_disk_stats.writes++;
+    ram_disk_stats.sectors_written += count;
+    memcpy(disk + (size_t)sector * FF_MIN_SS, buff, (size_t)count * FF_MIN_SS);
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    if (pdrv != 0)
+        return RES_PARERR;
+    switch (cmd) {
+    case CTRL_SYNC:
+    case CTRL_TRIM:
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        *(LBA_t *)buff = RAM_DISK_SECTORS;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = FF_MIN_SS;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = 1;
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void) {
+    return (DWORD)(2024 - 1980) << 25 | 1 << 21 | 1 << 16;
+}
+
+// my_debug.c do FatFs_SPI para ARM (usa cpsid/bkpt)
+void my_printf(const char *pcFormat, ...) {
+    va_list args;
+    va_start(args, pcFormat);
+    vprintf(pcFormat, args);
+    va_end(args);
+}
+
+void my_assert_func(const char *file, int line, const char *func, const char *pred) {
+    fprintf(stderr, "assertion \"%s\" failed: %s:%d, %s\n", pred, file, line, func);
+    abort();
+}
+
+FRESULT ram_disk_mount(FATFS *fs) {
+    static BYTE work[FF_MAX_SS * 8];
+    const MKFS_PARM opt = {FM_FAT32, 0, 0, 0, 0};
+    if (disk_initialize(0) != 0)
+        return FR_NOT_READY;
+    FRESULT fr = f_mkfs("", &opt, work, sizeof(work));
+    if (fr != FR_OK)
+        return fr;
+    memset(&ram_disk_stats, 0, sizeof(ram_disk_stats));
+    return f_mount(fs, "", 1);
+}
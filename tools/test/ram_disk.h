@@ -0,0 +1,23 @@
+#ifndef RAM_DISK_H
+#define RAM_DISK_H
+
+#include <stdint.h>
+
+#include "ff.h"
+
+// Disco do FatFs em memória para os testes do host: implementa disk_* e
+// get_fattime, conta as chamadas e formata/monta o volume "".
+
+#define RAM_DISK_SECTORS (64 * 2048) // 64 MB de setores de 512 B
+
+typedef struct {
+    uint32_t reads, writes;                 // Chamadas de disk_read/disk_write
+    uint64_t sectors_read, sectors_written; // Setores transferidos
+} ram_disk_stats_t;
+
+extern ram_disk_stats_t ram_disk_stats;
+
+// Formata em FAT32 e monta em fs. Retorna o erro do f_mkfs/f_mount.
+FRESULT ram_disk_mount(FATFS *fs);
+
+#endif
@@ -0,0 +1,438 @@
+// Primitivas de desenho de lib/ssd1306.c (em bytes inteiros) contra o desenho
+// pixel a pixel que o driver tinha antes: o framebuffer tem que ser idêntico.
+//
+//   ssd1306_draw_test [-n operações] [-s semente]   compara
+//   ssd1306_draw_test -b                            benchmark por quadro
+//
+// A referência é o código antigo de ssd1306_pixel(), _fill(), _rect(),
+// _line(), _hline(), _vline() e _draw_char(), com coordenadas em int e o
+// recorte feito pixel a pixel (o antigo escrevia fora do buffer). Cada
+// caractere é desenhado em todas as posições, e depois vem uma sequência
+// aleatória das primitivas, de ssd1306_scroll_left() e da camada de texto,
+// com coordenadas também fora da tela. Depois de cada operação as colunas
+// sujas têm que cobrir todos os bytes que mudaram, ou o envio parcial deixaria
+// a tela para trás. No firmware o tempo de desenho por quadro (em us e ciclos)
+// sai no console ao fechar o log.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ssd1306.h"
+#include "font.h" // Depois do ssd1306.h, que traz o stdint.h
+
+// O teste não envia nada: o driver só precisa do símbolo
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c;
+    (void)addr;
+    (void)src;
+    (void)nostop;
+    return (int)len;
+}
+
+// --- Referência: o desenho pixel a pixel ---
+
+static void ref_pixel(ssd1306_t *ssd, int x, int y, bool value) {
+    if (x < 0 || y < 0 || x >= ssd->width || y >= ssd->height)
+        return;
+    uint16_t index = (y >> 3) + x * ssd->pages + 1;
+    uint8_t pixel = (y & 0b111);
+    if (value)
+        ssd->ram_buffer[index] |= (1 << pixel);
+    else
+        ssd->ram_buffer[index] &= ~(1 << pixel);
+}
+
+static void ref_pixel_api(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+    ref_pixel(ssd, x, y, value);
+}
+
+static void ref_fill(ssd1306_t *ssd, bool value) {
+    for (int y = 0; y < ssd->height; ++y) {
+        for (int x = 0; x < ssd->width; ++x)
+            ref_pixel(ssd, x, y, value);
+    }
+}
+
+static void ref_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value,
+                     bool fill) {
+    if (width == 0 || height == 0)
+        return;
+    for (int x = left; x < left + width; ++x) {
+        ref_pixel(ssd, x, top, value);
+        ref_pixel(ssd, x, top + height - 1, value);
+    }
+    for (int y = top; y < top + height; ++y) {
+        ref_pixel(ssd, left, y, value);
+        ref_pixel(ssd, left + width - 1, y, value);
+    }
+    if (fill) {
+        for (int x = left + 1; x < left + width - 1; ++x) {
+            for (int y = top + 1; y < top + height - 1; ++y)
+                ref_pixel(ssd, x, y, value);
+        }
+    }
+}
+
+static void ref_line(ssd1306_t *ssd, uint8_t x0_, uint8_t y0_, uint8_t x1, uint8_t y1, bool value) {
+    int x0 = x0_, y0 = y0_;
+    int dx = abs(x1 - x0);
+    int dy = abs(y1 - y0);
+    int sx = (x0 < x1) ? 1 : -1;
+    int sy = (y0 < y1) ? 1 : -1;
+    int err = dx - dy;
+    while (true) {
+        ref_pixel(ssd, x0, y0, value);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int e2 = err * 2;
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+static void ref_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+    for (int x = x0; x <= x1; ++x)
+        ref_pixel(ssd, x, y, value);
+}
+
+static void ref_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+    for (int y = y0; y <= y1; ++y)
+        ref_pixel(ssd, x, y, value);
+}
+
+static void ref_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+    uint16_t index = (c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0;
+    for (int i = 0; i < 8; ++i) {
+        uint8_t line = font[index + i];
+        for (int j = 0; j < 8; ++j)
+            ref_pixel(ssd, x + i, y + j, line & (1 << j));
+    }
+}
+
+static void ref_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y) {
+    while (*str) {
+        ref_draw_char(ssd, *str++, x, y);
+        x += 8;
+        if (x + 8 >= ssd->width) {
+            x = 0;
+            y += 8;
+        }
+        if (y + 8 >= ssd->height)
+            break;
+    }
+}
+
+// As n colunas à esquerda saem, as da direita entram apagadas
+static void ref_scroll_left(ssd1306_t *ssd, uint8_t page0, uint8_t page1, uint8_t n) {
+    if (page1 >= ssd->pages)
+        page1 = ssd->pages - 1;
+    for (int y = page0 * 8; y < (page1 + 1) * 8; ++y) {
+        for (int x = 0; x < ssd->width; ++x) {
+            int from = x + n;
+            bool on = from < ssd->width && ((ssd->ram_buffer[1 + from * ssd->pages + (y >> 3)] >> (y & 7)) & 1);
+            ref_pixel(ssd, x, y, on);
+        }
+    }
+}
+
+// Camada de texto: cada célula é um caractere em (col * 8, row * 8)
+static void ref_text(ssd1306_t *ssd, uint8_t col, uint8_t row, const char *str, bool pad) {
+    if (row >= ssd->pages)
+        return;
+    for (; col < ssd->width / 8 && (*str || pad); ++col)
+        ref_draw_char(ssd, *str ? *str++ : ' ', col * 8, row * 8);
+}
+
+// --- Comparação ---
+
+typedef struct {
+    void (*fill)(ssd1306_t *ssd, bool value);
+    void (*pixel)(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
+    void (*rect)(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
+    void (*line)(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
+    void (*hline)(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
+    void (*vline)(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
+    void (*draw_string)(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+} draw_ops_t;
+
+static const draw_ops_t driver_ops = {ssd1306_fill, ssd1306_pixel, ssd1306_rect, ssd1306_line,
+                                      ssd1306_hline, ssd1306_vline, ssd1306_draw_string};
+static const draw_ops_t ref_ops = {ref_fill, ref_pixel_api, ref_rect, ref_line, ref_hline, ref_vline,
+                                   ref_draw_string};
+
+static ssd1306_t drv, ref;
+static uint8_t before[WIDTH * HEIGHT / 8 + 1];
+static long failures;
+
+static void clean_dirty(ssd1306_t *ssd) {
+    for (uint8_t page = 0; page < ssd->pages; ++page) {
+        ssd->dirty_x0[page] = ssd->width;
+        ssd->dirty_x1[page] = 0;
+    }
+}
+
+// Ponto de partida igual nos dois framebuffers, guardado em before
+static void start_op(void) {
+    memcpy(ref.ram_buffer, drv.ram_buffer, drv.bufsize);
+    memcpy(before, drv.ram_buffer, drv.bufsize);
+    clean_dirty(&drv);
+}
+
+static void end_op(const char *what) {
+    bool same = memcmp(drv.ram_buffer, ref.ram_buffer, drv.bufsize) == 0;
+    bool covered = true;
+    for (uint8_t x = 0; x < drv.width; ++x) {
+        for (uint8_t page = 0; page < drv.pages; ++page) {
+            size_t i = 1 + x * drv.pages + page;
+            if (drv.ram_buffer[i] != before[i] && (x < drv.dirty_x0[page] || x > drv.dirty_x1[page]))
+                covered = false;
+        }
+    }
+    if ((!same || !covered) && failures++ < 10) {
+        if (!same) {
+            size_t i = 1;
+            while (drv.ram_buffer[i] == ref.ram_buffer[i])
+                ++i;
+            fprintf(stderr, "ssd1306_draw_test: %s: coluna %u pagina %u = %02x, pixel a pixel %02x\n", what,
+                    (unsigned)((i - 1) / drv.pages), (unsigned)((i - 1) % drv.pages), drv.ram_buffer[i],
+                    ref.ram_buffer[i]);
+        } else {
+            fprintf(stderr, "ssd1306_draw_test: %s: bytes alterados fora das colunas sujas\n", what);
+        }
+    }
+}
+
+static void forget_text(ssd1306_t *ssd) {
+    for (uint8_t row = 0; row < ssd->pages; ++row)
+        ssd1306_text_forget(ssd, row);
+}
+
+static uint8_t random_coord(int limit) {
+    // Quase sempre perto da tela; às vezes qualquer uint8, para o recorte
+    return (rand() & 7) ? (uint8_t)(rand() % (limit + 9)) : (uint8_t)rand();
+}
+
+static void random_fill(ssd1306_t *ssd) {
+    for (size_t i = 1; i < ssd->bufsize; i++)
+        ssd->ram_buffer[i] = (uint8_t)rand();
+}
+
+static void random_string(char *str, size_t max) {
+    size_t len = rand() % max;
+    for (size_t i = 0; i < len; i++)
+        str[i] = (rand() % 16) ? (char)(' ' + rand() % 95) : (char)rand();
+    str[len] = 0;
+}
+
+// Todos os caracteres (e alguns fora da fonte) em todas as posições
+static void check_chars(void) {
+    static const char extra[] = {0, '\n', 0x7F, (char)0x80, (char)0xFF};
+    random_fill(&drv);
+    for (int k = 0; k < 95 + (int)sizeof(extra); k++) {
+        char c = k < 95 ? (char)(' ' + k) : extra[k - 95];
+        for (int y = 0; y < HEIGHT + 8; y++) {
+            for (int x = 0; x < WIDTH + 8; x++) {
+                start_op();
+                ssd1306_draw_char(&drv, c, (uint8_t)x, (uint8_t)y);
+                ref_draw_char(&ref, c, (uint8_t)x, (uint8_t)y);
+                char what[48];
+                snprintf(what, sizeof(what), "draw_char(0x%02x, %d, %d)", (uint8_t)c, x, y);
+                end_op(what);
+            }
+        }
+    }
+}
+
+static void random_op(void) {
+    char what[96], str[40];
+    bool value = rand() & 1;
+    uint8_t a = random_coord(WIDTH), b = random_coord(HEIGHT), c = random_coord(WIDTH), d = random_coord(HEIGHT);
+    bool text = false;
+    start_op();
+    switch (rand() % 11) {
+    case 0:
+        if (rand() % 8)
+            return; // O quadro inteiro é raro no firmware
+        ssd1306_fill(&drv, value);
+        ref_fill(&ref, value);
+        snprintf(what, sizeof(what), "fill(%d)", value);
+        break;
+    case 1:
+        ssd1306_pixel(&drv, a, b, value);
+        ref_pixel(&ref, a, b, value);
+        snprintf(what, sizeof(what), "pixel(%u, %u, %d)", a, b, value);
+        break;
+    case 2: {
+        bool fill = rand() & 1;
+        ssd1306_rect(&drv, b, a, c, d, value, fill);
+        ref_rect(&ref, b, a, c, d, value, fill);
+        snprintf(what, sizeof(what), "rect(top %u, left %u, %ux%u, %d, fill %d)", b, a, c, d, value, fill);
+        break;
+    }
+    case 3:
+        if (rand() & 1)
+            d = b; // Horizontais e verticais têm caminho próprio
+        else if (rand() & 1)
+            c = a;
+        ssd1306_line(&drv, a, b, c, d, value);
+        ref_line(&ref, a, b, c, d, value);
+        snprintf(what, sizeof(what), "line(%u, %u, %u, %u, %d)", a, b, c, d, value);
+        break;
+    case 4:
+        ssd1306_hline(&drv, a, c, b, value);
+        ref_hline(&ref, a, c, b, value);
+        snprintf(what, sizeof(what), "hline(%u, %u, %u, %d)", a, c, b, value);
+        break;
+    case 5:
+        ssd1306_vline(&drv, a, b, d, value);
+        ref_vline(&ref, a, b, d, value);
+        snprintf(what, sizeof(what), "vline(%u, %u, %u, %d)", a, b, d, value);
+        break;
+    case 6:
+    case 7:
+        random_string(str, sizeof(str));
+        ssd1306_draw_string(&drv, str, a, b);
+        ref_draw_string(&ref, str, a, b);
+        snprintf(what, sizeof(what), "draw_string(\"%.20s\", %u, %u)", str, a, b);
+        break;
+    case 8: {
+        uint8_t page0 = rand() % 10, page1 = rand() % 10, n = random_coord(WIDTH);
+        ssd1306_scroll_left(&drv, page0, page1, n);
+        ref_scroll_left(&ref, page0, page1, n);
+        snprintf(what, sizeof(what), "scroll_left(%u, %u, %u)", page0, page1, n);
+        break;
+    }
+    default: {
+        uint8_t col = rand() % 18, row = rand() % 9;
+        bool line = rand() & 1;
+        random_string(str, 20);
+        if (line) {
+            ssd1306_text_line(&drv, row, str);
+            ref_text(&ref, 0, row, str, true);
+        } else {
+            ssd1306_text(&drv, col, row, str);
+            ref_text(&ref, col, row, str, false);
+        }
+        snprintf(what, sizeof(what), "text%s(%u, %u, \"%.20s\")", line ? "_line" : "", line ? 0 : col, row, str);
+        text = true;
+        break;
+    }
+    }
+    end_op(what);
+    // Desenho fora da camada de texto invalida as células que ele pode ter tocado
+    if (!text)
+        forget_text(&drv);
+}
+
+// --- Benchmark ---
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Página de gravação como o firmware desenhava antes da camada de texto
+static void frame_text(ssd1306_t *ssd, const draw_ops_t *ops, uint32_t i) {
+    char line[24];
+    ops->fill(ssd, false);
+    ops->draw_string(ssd, "DATALOGGER IMU", 0, 0);
+    ops->draw_string(ssd, "----------------", 0, 10);
+    ops->draw_string(ssd, "Gravando...", 0, 25);
+    snprintf(line, sizeof(line), "Amostras: %lu", (unsigned long)i);
+    ops->draw_string(ssd, line, 0, 35);
+    snprintf(line, sizeof(line), "Tempo: %lu s", (unsigned long)(i / 10));
+    ops->draw_string(ssd, line, 0, 45);
+    ops->draw_string(ssd, "Resta: 3h12m", 0, 55);
+}
+
+// Gráfico: moldura e uma barra vertical por coluna
+static void frame_chart(ssd1306_t *ssd, const draw_ops_t *ops, uint32_t i) {
+    ops->fill(ssd, false);
+    ops->draw_string(ssd, "GRAFICO Ax", 0, 0);
+    ops->rect(ssd, 16, 0, WIDTH, HEIGHT - 16, true, false);
+    for (uint8_t x = 1; x < WIDTH - 1; x++) {
+        uint8_t h = (uint8_t)((x * 7 + i) % 40);
+        ops->vline(ssd, x, 40 - h / 2, 40 + h / 2, true);
+    }
+    ops->line(ssd, 1, 40, WIDTH - 2, 40, false);
+}
+
+static double time_frames(void (*frame)(ssd1306_t *, const draw_ops_t *, uint32_t), const draw_ops_t *ops,
+                          ssd1306_t *ssd, uint32_t n) {
+    double t0 = now_s();
+    for (uint32_t i = 0; i < n; i++)
+        frame(ssd, ops, i);
+    return (now_s() - t0) / n * 1e6;
+}
+
+static int bench(void) {
+    enum { N = 20000 };
+    static const struct {
+        const char *name;
+        void (*frame)(ssd1306_t *, const draw_ops_t *, uint32_t);
+    } frames[] = {{"texto", frame_text}, {"grafico", frame_chart}};
+    printf("%-8s %14s %14s\n", "quadro", "pixel a pixel", "em bytes");
+    for (size_t k = 0; k < sizeof(frames) / sizeof(frames[0]); k++) {
+        double old_us = time_frames(frames[k].frame, &ref_ops, &ref, N);
+        double new_us = time_frames(frames[k].frame, &driver_ops, &drv, N);
+        printf("%-8s %9.2f us %9.2f us  (%.1fx)\n", frames[k].name, old_us, new_us, old_us / new_us);
+        // Os dois quadros finais são o mesmo desenho
+        if (memcmp(drv.ram_buffer, ref.ram_buffer, drv.bufsize) != 0) {
+            fprintf(stderr, "ssd1306_draw_test: quadro %s diferente do pixel a pixel\n", frames[k].name);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long ops = 300000;
+    unsigned seed = 1;
+    bool run_bench = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:b")) != -1) {
+        switch (opt) {
+        case 'n':
+            ops = atol(optarg);
+            break;
+        case 's':
+            seed = (unsigned)atoi(optarg);
+            break;
+        case 'b':
+            run_bench = true;
+            break;
+        default:
+            fprintf(stderr, "uso: ssd1306_draw_test [-n operacoes] [-s semente] | -b\n");
+            return 2;
+        }
+    }
+    ssd1306_init(&drv, WIDTH, HEIGHT, false, 0x3C, NULL);
+    ssd1306_init(&ref, WIDTH, HEIGHT, false, 0x3C, NULL);
+    if (run_bench)
+        return bench();
+    srand(seed);
+
+    check_chars();
+    random_fill(&drv);
+    forget_text(&drv);
+    for (long k = 0; k < ops; k++)
+        random_op();
+
+    if (failures) {
+        fprintf(stderr, "ssd1306_draw_test: %ld operacoes diferentes do desenho pixel a pixel\n", failures);
+        return 1;
+    }
+    printf("ssd1306_draw: igual ao desenho pixel a pixel em todos os caracteres e posicoes e em %ld operacoes "
+           "aleatorias\n", ops);
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Envio parcial de lib/ssd1306.c na I2C: depois de cada envio a GDDRAM do
+// SSD1306 simulado (tools/oled_panel.c) tem que ser igual ao framebuffer.
+//
+//   ssd1306_send_test [-n rodadas] [-s semente]
+//
+// Cada rodada desenha algumas primitivas em lugares aleatórios (às vezes
+// nenhuma, às vezes a tela inteira, às vezes ssd1306_invalidate()) e envia.
+// Além da GDDRAM, confere que nenhum envio custa mais que o quadro inteiro,
+// que uma rodada sem mudanças não manda nada e que o controlador não recebe
+// comandos fora da tabela.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "oled_panel.h"
+#include "ssd1306.h"
+
+static oled_panel_t panel;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c;
+    (void)addr;
+    (void)nostop;
+    oled_panel_write(&panel, src, len);
+    return (int)len;
+}
+
+static bool panel_matches(const ssd1306_t *ssd, int *x_out, int *page_out) {
+    for (int x = 0; x < ssd->width; x++) {
+        for (int page = 0; page < ssd->pages; page++) {
+            if (panel.gram[page][x] != ssd->ram_buffer[1 + x * ssd->pages + page]) {
+                *x_out = x;
+                *page_out = page;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static uint8_t random_coord(int limit) {
+    return (uint8_t)(rand() % (limit + 8));
+}
+
+static void random_string(char *str, size_t max) {
+    size_t len = 1 + rand() % (max - 1);
+    for (size_t i = 0; i < len; i++)
+        str[i] = (char)(' ' + rand() % 95);
+    str[len] = 0;
+}
+
+// Uma primitiva qualquer; a maioria pequena, como num quadro em regime
+static void random_draw(ssd1306_t *ssd) {
+    char str[18];
+    bool value = rand() & 1;
+    uint8_t x = random_coord(WIDTH), y = random_coord(HEIGHT);
+    switch (rand() % 8) {
+    case 0:
+        ssd1306_pixel(ssd, x, y, value);
+        break;
+    case 1:
+        ssd1306_rect(ssd, y, x, rand() % 40, rand() % 30, value, rand() & 1);
+        break;
+    case 2:
+        ssd1306_line(ssd, x, y, random_coord(WIDTH), random_coord(HEIGHT), value);
+        break;
+    case 3:
+        ssd1306_vline(ssd, x, y, random_coord(HEIGHT), value);
+        break;
+    case 4:
+        random_string(str, 6);
+        ssd1306_draw_string(ssd, str, x, y);
+        break;
+    case 5:
+        random_string(str, sizeof(str));
+        ssd1306_text_line(ssd, rand() % 8, str);
+        break;
+    case 6:
+        ssd1306_scroll_left(ssd, 2 + rand() % 6, 7, 1 + rand() % 3);
+        break;
+    default:
+        // Redesenho igual ao que já está na tela: nada a enviar
+        ssd1306_text_forget(ssd, rand() % 8);
+        ssd1306_text_line(ssd, rand() % 8, "");
+        break;
+    }
+}
+
+int main(int argc, char **argv) {
+    long rounds = 200000;
+    unsigned seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n':
+            rounds = atol(optarg);
+            break;
+        case 's':
+            seed = (unsigned)atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "uso: ssd1306_send_test [-n rodadas] [-s semente]\n");
+            return 2;
+        }
+    }
+    srand(seed);
+
+    ssd1306_t ssd;
+    oled_panel_init(&panel);
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, NULL);
+    ssd1306_config(&ssd);
+    ssd1306_send_data(&ssd);
+    // O quadro inteiro: janela de comandos e o framebuffer numa transação
+    const uint32_t full_frame = 2 + 6 + 1 + (uint32_t)ssd.bufsize;
+
+    long failures = 0, full_sends = 0, empty_sends = 0;
+    uint64_t bytes_total = 0;
+    for (long r = 0; r < rounds; r++) {
+        int kind = rand() % 64;
+        uint8_t before[WIDTH * HEIGHT / 8 + 1];
+        memcpy(before, ssd.ram_buffer, ssd.bufsize);
+        if (kind == 0) {
+            ssd1306_fill(&ssd, rand() & 1);
+        } else if (kind == 1) {
+            ssd1306_invalidate(&ssd);
+        } else if (kind > 8) {
+            for (int k = rand() % 6; k >= 0; k--)
+                random_draw(&ssd);
+        }
+        bool unchanged = kind != 1 && memcmp(before, ssd.ram_buffer, ssd.bufsize) == 0;
+
+        uint32_t bytes = panel.bytes;
+        ssd1306_send_data(&ssd);
+        bytes = panel.bytes - bytes;
+        bytes_total += bytes;
+        if (bytes >= full_frame)
+            full_sends++;
+        if (bytes == 0)
+            empty_sends++;
+
+        int x, page;
+        const char *error = NULL;
+        if (!panel_matches(&ssd, &x, &page))
+            error = "GDDRAM diferente do framebuffer";
+        else if (bytes > full_frame)
+            error = "envio maior que o quadro inteiro";
+        else if (unchanged && bytes)
+            error = "framebuffer igual e mesmo assim enviou";
+        if (error && failures++ < 10) {
+            fprintf(stderr, "ssd1306_send_test: rodada %ld: %s", r, error);
+            if (!panel_matches(&ssd, &x, &page))
+                fprintf(stderr, " (coluna %d pagina %d: %02x na GDDRAM, %02x no framebuffer)", x, page,
+                        panel.gram[page][x], ssd.ram_buffer[1 + x * ssd.pages + page]);
+            fprintf(stderr, ", %lu B\n", (unsigned long)bytes);
+        }
+    }
+    if (panel.unknown) {
+        fprintf(stderr, "ssd1306_send_test: %lu comandos desconhecidos na I2C\n", (unsigned long)panel.unknown);
+        failures++;
+    }
+    if (failures) {
+        fprintf(stderr, "ssd1306_send_test: %ld rodadas com erro\n", failures);
+        return 1;
+    }
+    printf("ssd1306_send: GDDRAM igual ao framebuffer em %ld rodadas (%.1f B/envio, %ld quadros inteiros, "
+           "%ld envios vazios)\n", rounds, (double)bytes_total / rounds, full_sends, empty_sends);
+    return 0;
+}
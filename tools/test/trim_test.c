@@ -0,0 +1,300 @@
+// Descarte de clusters livres (CTRL_TRIM) de lib/FatFs_SPI/src/glue.c com um
+// sd_card_t em RAM no lugar do cartão.
+//
+// O cartão simulado registra cada erase_blocks e preenche os setores com 0xFF,
+// como um cartão que apaga com 1s. Primeiro disk_ioctl/disk_write direto:
+// faixas vizinhas juntadas, o apagamento adiado até o CTRL_SYNC e uma escrita
+// dentro da faixa pendente que a descarrega antes. Depois o FatFs inteiro:
+// cada f_unlink apaga exatamente os setores do arquivo, e o que sobrou e o
+// que foi escrito por cima dos clusters liberados continua legível. Antes de
+// tudo, os argumentos de CMD32/CMD33 que sd_card.c manda ao cartão real:
+// endereço em bytes no SDSC, em blocos no SDHC, fim inclusivo e faixas
+// longas divididas em SD_ERASE_MAX_BLOCKS.
+// Retorna 1 na primeira diferença.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ff.h"
+#include "diskio.h"
+#include "hw_config.h"
+#include "my_debug.h"
+#include "sd_card.h"
+
+#define SIM_SECTORS 65536 // 32 MB
+#define MAX_ERASES 64
+
+static uint8_t (*sectors)[FF_MIN_SS];
+static sd_card_t card;
+
+static struct {
+    uint64_t start;
+    uint32_t count;
+} erases[MAX_ERASES];
+static int erase_count;
+
+static int sim_init(sd_card_t *sd) {
+    sd->m_Status = 0;
+    return 0;
+}
+
+static int sim_write(sd_card_t *sd, const uint8_t *buffer, uint64_t sector, uint32_t count) {
+    if (sector + count > sd->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    memcpy(sectors[sector], buffer, (size_t)count * FF_MIN_SS);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static int sim_read(sd_card_t *sd, uint8_t *buffer, uint64_t sector, uint32_t count) {
+    if (sector + count > sd->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    memcpy(buffer, sectors[sector], (size_t)count * FF_MIN_SS);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+// Mesmas checagens de in_sd_erase_blocks (sd_card.c)
+static int sim_erase(sd_card_t *sd, uint64_t sector, uint32_t count) {
+    if (!count)
+        return SD_BLOCK_DEVICE_ERROR_NONE;
+    if (sector + count > sd->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (erase_count < MAX_ERASES) {
+        erases[erase_count].start = sector;
+        erases[erase_count].count = count;
+    }
+    erase_count++;
+    memset(sectors[sector], 0xFF, (size_t)count * FF_MIN_SS);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+// hw_config.c e sd_card.c do firmware
+sd_card_t *sd_get_by_num(size_t num) {
+    return num == 0 ? &card : NULL;
+}
+
+bool sd_init_driver(void) {
+    return true;
+}
+
+bool sd_card_detect(sd_card_t *sd) {
+    (void)sd;
+    return true;
+}
+
+uint64_t sd_sectors(sd_card_t *sd) {
+    return sd->sectors;
+}
+
+DWORD get_fattime(void) {
+    return (DWORD)(2024 - 1980) << 25 | 1 << 21 | 1 << 16;
+}
+
+void my_printf(const char *pcFormat, ...) {
+    (void)pcFormat;
+}
+
+void my_assert_func(const char *file, int line, const char *func, const char *pred) {
+    fprintf(stderr, "assertion \"%s\" failed: %s:%d, %s\n", pred, file, line, func);
+    abort();
+}
+
+static int fail(const char *what) {
+    fprintf(stderr, "trim_test: %s\n", what);
+    return 1;
+}
+
+static bool erased(int i, uint64_t start, uint32_t count) {
+    return erase_count > i && erases[i].start == start && erases[i].count == count;
+}
+
+static DRESULT trim(LBA_t start, LBA_t end) {
+    LBA_t range[2] = {start, end};
+    return disk_ioctl(0, CTRL_TRIM, range);
+}
+
+// Faixas pendentes, junção e descarga pela escrita, sem o FatFs
+static int check_glue(void) {
+    static uint8_t block[FF_MIN_SS];
+    memset(block, 0xA5, sizeof(block));
+
+    erase_count = 0;
+    if (trim(100, 199) != RES_OK || trim(200, 299) != RES_OK || trim(50, 99) != RES_OK)
+        return fail("CTRL_TRIM recusado");
+    if (erase_count != 0)
+        return fail("apagou antes do CTRL_SYNC");
+    if (disk_ioctl(0, CTRL_SYNC, NULL) != RES_OK || erase_count != 1 || !erased(0, 50, 250))
+        return fail("faixas vizinhas deviam virar um apagamento de 50..299");
+    if (disk_ioctl(0, CTRL_SYNC, NULL) != RES_OK || erase_count != 1)
+        return fail("CTRL_SYNC sem faixa pendente apagou de novo");
+
+    // Faixa que não encosta na pendente: a pendente sai na hora
+    erase_count = 0;
+    trim(1000, 1009);
+    trim(1020, 1029);
+    if (erase_count != 1 || !erased(0, 1000, 10))
+        return fail("faixa nao vizinha devia descarregar a pendente");
+
+    // Escrita fora da faixa pendente não a descarrega; dentro, descarrega
+    // antes de escrever, e o dado escrito fica
+    if (disk_write(0, block, 1030, 1) != RES_OK || erase_count != 1)
+        return fail("escrita fora da faixa descarregou o trim");
+    if (disk_write(0, block, 1025, 1) != RES_OK || erase_count != 2 || !erased(1, 1020, 10))
+        return fail("escrita dentro da faixa devia descarregar o trim antes");
+    if (memcmp(sectors[1025], block, sizeof(block)) != 0)
+        return fail("escrita apagada pelo trim");
+    if (disk_ioctl(0, CTRL_SYNC, NULL) != RES_OK || erase_count != 2)
+        return fail("faixa descarregada apagou de novo no CTRL_SYNC");
+
+    LBA_t bad[2] = {10, 9};
+    if (disk_ioctl(0, CTRL_TRIM, bad) != RES_PARERR)
+        return fail("faixa invertida aceita");
+    return 0;
+}
+
+#define FILE_COUNT 5
+#define FILE_BLOCKS 100
+#define BLOCK_SIZE 4096
+
+static void fill(uint8_t *buf, int file, int block) {
+    for (int i = 0; i < BLOCK_SIZE; i++)
+        buf[i] = (uint8_t)(file * 31 + block * 7 + i);
+}
+
+static int check_file(const char *name, int file, int blocks) {
+    static uint8_t expected[BLOCK_SIZE], got[BLOCK_SIZE];
+    FIL f;
+    UINT br;
+    if (f_open(&f, name, FA_READ) != FR_OK)
+        return fail("arquivo sumiu");
+    for (int b = 0; b < blocks; b++) {
+        fill(expected, file, b);
+        if (f_read(&f, got, BLOCK_SIZE, &br) != FR_OK || br != BLOCK_SIZE ||
+            memcmp(got, expected, BLOCK_SIZE) != 0)
+            return fail("conteudo de um arquivo vivo foi apagado");
+    }
+    f_close(&f);
+    return 0;
+}
+
+// Argumentos de CMD32/CMD33 de in_sd_erase_blocks (sd_card.c), com o mesmo
+// laço sobre sd_erase_chunk(): cada par tem que bater com o esperado
+static int check_chunks(const char *what, bool block_addressing, uint64_t sector, uint32_t count,
+                        const uint32_t (*expected)[2], int n) {
+    int i = 0;
+    while (count) {
+        sd_erase_chunk_t c = sd_erase_chunk(block_addressing, sector, count);
+        if (i >= n || c.start_addr != expected[i][0] || c.end_addr != expected[i][1]) {
+            fprintf(stderr, "trim_test: %s: par %d com CMD32 %lu CMD33 %lu\n", what, i,
+                    (unsigned long)c.start_addr, (unsigned long)c.end_addr);
+            return 1;
+        }
+        sector += c.blocks;
+        count -= c.blocks;
+        i++;
+    }
+    if (i != n) {
+        fprintf(stderr, "trim_test: %s: %d pares, esperado %d\n", what, i, n);
+        return 1;
+    }
+    return 0;
+}
+
+static int check_erase_args(void) {
+    // SDSC: endereço em bytes, fim inclusivo (último bloco * 512)
+    static const uint32_t sdsc[][2] = {{100 * 512, 109 * 512}};
+    // SDHC/SDXC: endereço em blocos
+    static const uint32_t sdhc[][2] = {{100, 109}};
+    // Mais de SD_ERASE_MAX_BLOCKS: dividido em 8192 + 8192 + 3616
+    static const uint32_t split_hc[][2] = {{1000, 9191}, {9192, 17383}, {17384, 20999}};
+    static const uint32_t split_sc[][2] = {
+        {1000 * 512, 9191 * 512}, {9192 * 512, 17383 * 512}, {17384 * 512, 20999 * 512}};
+    if (SD_ERASE_MAX_BLOCKS != 8192)
+        return fail("SD_ERASE_MAX_BLOCKS diferente de 8192");
+    return check_chunks("SDSC", false, 100, 10, sdsc, 1) || check_chunks("SDHC", true, 100, 10, sdhc, 1) ||
+           check_chunks("SDHC 20000 blocos", true, 1000, 20000, split_hc, 3) ||
+           check_chunks("SDSC 20000 blocos", false, 1000, 20000, split_sc, 3) ||
+           check_chunks("SDHC 1 bloco", true, 7, 1, (const uint32_t[][2]){{7, 7}}, 1) ||
+           check_chunks("SDHC 8192 blocos", true, 0, 8192, (const uint32_t[][2]){{0, 8191}}, 1);
+}
+
+// FatFs inteiro: um apagamento por arquivo removido, com os setores dele
+static int check_filesystem(void) {
+    static FATFS fs;
+    static BYTE work[FF_MAX_SS * 8];
+    static uint8_t buf[BLOCK_SIZE];
+    const MKFS_PARM opt = {FM_ANY, 0, 0, 0, 0};
+    if (f_mkfs("0:", &opt, work, sizeof(work)) != FR_OK || f_mount(&fs, "0:", 1) != FR_OK)
+        return fail("f_mkfs/f_mount");
+
+    char name[16];
+    LBA_t first[FILE_COUNT];
+    UINT bw;
+    for (int i = 0; i < FILE_COUNT; i++) {
+        FIL f;
+        snprintf(name, sizeof(name), "0:log_%03d.csv", i);
+        if (f_open(&f, name, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+            return fail("f_open");
+        for (int b = 0; b < FILE_BLOCKS; b++) {
+            fill(buf, i, b);
+            if (f_write(&f, buf, BLOCK_SIZE, &bw) != FR_OK || bw != BLOCK_SIZE)
+                return fail("f_write");
+        }
+        first[i] = fs.database + (LBA_t)(f.obj.sclust - 2) * fs.csize;
+        f_close(&f);
+    }
+
+    // Os arquivos foram escritos em sequência num volume vazio: cada um é
+    // contíguo, FILE_BLOCKS * BLOCK_SIZE bytes arredondados para o cluster
+    uint32_t cluster_bytes = fs.csize * FF_MIN_SS;
+    uint32_t file_sectors = (FILE_BLOCKS * BLOCK_SIZE + cluster_bytes - 1) / cluster_bytes * fs.csize;
+    for (int i = 0; i < FILE_COUNT - 1; i++) {
+        erase_count = 0;
+        snprintf(name, sizeof(name), "0:log_%03d.csv", i);
+        if (f_unlink(name) != FR_OK)
+            return fail("f_unlink");
+        if (erase_count != 1 || !erased(0, first[i], file_sectors)) {
+            fprintf(stderr, "trim_test: %s: %d apagamentos, esperado 1 em %lu+%lu\n", name, erase_count,
+                    (unsigned long)first[i], (unsigned long)file_sectors);
+            return 1;
+        }
+    }
+    snprintf(name, sizeof(name), "0:log_%03d.csv", FILE_COUNT - 1);
+    if (check_file(name, FILE_COUNT - 1, FILE_BLOCKS))
+        return 1;
+
+    // Arquivo novo nos clusters liberados, maior que um arquivo removido
+    FIL f;
+    erase_count = 0;
+    if (f_open(&f, "0:novo.csv", FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+        return fail("f_open");
+    for (int b = 0; b < 3 * FILE_BLOCKS; b++) {
+        fill(buf, 9, b);
+        if (f_write(&f, buf, BLOCK_SIZE, &bw) != FR_OK || bw != BLOCK_SIZE)
+            return fail("f_write");
+    }
+    f_close(&f);
+    if (erase_count != 0)
+        return fail("escrita de arquivo novo apagou setores");
+    if (check_file("0:novo.csv", 9, 3 * FILE_BLOCKS) || check_file(name, FILE_COUNT - 1, FILE_BLOCKS))
+        return 1;
+    f_unmount("0:");
+    return 0;
+}
+
+int main(void) {
+    sectors = calloc(SIM_SECTORS, FF_MIN_SS);
+    card.pcName = "0:";
+    card.sectors = SIM_SECTORS;
+    card.init = sim_init;
+    card.write_blocks = sim_write;
+    card.read_blocks = sim_read;
+    card.erase_blocks = sim_erase;
+    if (!sectors || disk_initialize(0) != 0)
+        return fail("cartao simulado");
+    if (check_erase_args() || check_glue() || check_filesystem())
+        return 1;
+    printf("trim: CMD32/CMD33 de SDSC e SDHC conferidos; faixas juntadas, adiadas e descarregadas pela escrita; "
+           "%d arquivos removidos, um apagamento cada\n", FILE_COUNT - 1);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "work_pool.h"
+
+typedef struct {
+    size_t count;
+    size_t next; // Próximo item livre (atômico)
+    work_pool_fn fn;
+    void *ctx;
+} work_pool_t;
+
+static void *worker(void *arg) {
+    work_pool_t *pool = arg;
+    for (;;) {
+        size_t item = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+        if (item >= pool->count)
+            return NULL;
+        pool->fn(item, pool->ctx);
+    }
+}
+
+unsigned work_pool_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1;
+}
+
+void work_pool_run(size_t count, unsigned threads, work_pool_fn fn, void *ctx) {
+    work_pool_t pool = {.count = count, .next = 0, .fn = fn, .ctx = ctx};
+    if (threads == 0)
+        threads = work_pool_cpu_count();
+    if (threads > count)
+        threads = (unsigned)count;
+    if (threads <= 1) {
+        worker(&pool);
+        return;
+    }
+
+    pthread_t *ids = calloc(threads, sizeof(*ids));
+    unsigned started = 0;
+    for (; ids && started < threads; started++) {
+        if (pthread_create(&ids[started], NULL, worker, &pool) != 0)
+            break;
+    }
+    if (started == 0)
+        worker(&pool); // Sem threads: faz tudo nesta
+    for (unsigned i = 0; i < started; i++)
+        pthread_join(ids[i], NULL);
+    free(ids);
+}
@@ -0,0 +1,19 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <stddef.h>
+
+// Distribui itens independentes (um arquivo de log cada) entre threads.
+// Cada thread pega o próximo item livre, então arquivos grandes e pequenos se
+// equilibram sozinhos; ordenar do maior para o menor ajuda no fim da fila.
+
+typedef void (*work_pool_fn)(size_t item, void *ctx);
+
+// Roda fn(0..count-1, ctx) em até threads threads (0 = número de núcleos) e
+// espera todas terminarem
+void work_pool_run(size_t count, unsigned threads, work_pool_fn fn, void *ctx);
+
+// Núcleos disponíveis
+unsigned work_pool_cpu_count(void);
+
+#endif